@@ -0,0 +1,201 @@
+#ifndef ANALYSISSERVER_H
+#define ANALYSISSERVER_H
+
+#include "ChessBoard.h"
+#include "Search.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+/* How an AnalysisServer runs */
+struct ServerOptions {
+	/* Path of the Unix domain socket; an existing file there is replaced */
+	string socketPath;
+
+	/* Search threads (0 = one per hardware thread) */
+	int threads = 0;
+
+	/* Transposition table of each search thread */
+	size_t hashMegabytes = 16;
+
+	/* Searches that may wait for a thread; requests beyond that are refused with "busy" */
+	size_t maxQueue = 256;
+
+	/* Search depth when a request gives no depth, movetime or nodes */
+	int defaultDepth = 6;
+};
+
+
+// AnalysisServer class declaration
+
+/**
+ * Long-running analysis service on a local Unix socket.
+ *
+ * Clients write one JSON object per line and get one JSON object per line back,
+ * tagged with the request's "id". A request names a position and its limits:
+ *   {"id":"a1","fen":"...","depth":10,"movetime":500,"nodes":0,"multipv":1,"priority":0,"deadline":2000}
+ * and is answered with the search result, "queued_ms", "service_ms" and
+ * "coalesced" (true when the search was shared with earlier requests), or with
+ * {"id":..., "error":...}. {"cmd":"stats"} returns the counters and latency
+ * percentiles and {"cmd":"shutdown"} stops the server.
+ *
+ * Requests for the same position (Zobrist key) and limits are coalesced: while
+ * a search is queued or running, further requests join it and get the same
+ * result. Searches wait in a queue ordered by priority (highest first, then
+ * oldest first), and a joining request raises its search's priority to its own.
+ * When maxQueue searches are waiting, new ones are refused at once rather than
+ * piling up, so clients see the load and can back off.
+ *
+ * A deadline (milliseconds after the request arrives) that passes while the
+ * search is still queued is answered with an error. When a search starts, its
+ * time is capped so it finishes before the earliest deadline of its requests.
+ */
+class AnalysisServer {
+
+	public:
+
+		AnalysisServer(const ServerOptions& options);
+
+
+		/**
+		 * AnalysisServer destructor that stops the server if it is running.
+		 */
+		~AnalysisServer();
+
+		AnalysisServer(const AnalysisServer&) = delete;
+		AnalysisServer& operator=(const AnalysisServer&) = delete;
+
+
+		/**
+		 * Serves requests until stop is called or a shutdown request arrives.
+		 *
+		 * @return false if the socket could not be set up (the reason is printed).
+		 */
+		bool run();
+
+
+		/**
+		 * Asks the server to stop: queued searches are answered with an error,
+		 * running ones are finished. Safe to call from any thread.
+		 */
+		void stop();
+
+
+		/**
+		 * Returns the counters and latency percentiles as a JSON object.
+		 */
+		string statsJson();
+
+
+	private:
+
+		typedef chrono::steady_clock Clock;
+
+		/* A client connection; replies from several threads are written whole under the lock */
+		struct Connection {
+			int fd;
+			mutex writeLock;
+
+			void send(const string& line);
+			~Connection();
+		};
+
+		/* One request waiting for a search */
+		struct Waiter {
+			shared_ptr<Connection> connection;
+			string id;
+			int priority;
+			Clock::time_point received;
+			Clock::time_point deadline;
+			bool coalesced;
+		};
+
+		/* Position and limits that identify a search: key, depth, movetime, nodes, multipv */
+		typedef tuple<uint64_t, int, int, uint64_t, int> JobKey;
+
+		/* A queued or running search and the requests waiting for it */
+		struct Job {
+			JobKey key;
+			string fen;
+			int depth;
+			int moveTime;
+			uint64_t nodes;
+			int multiPV;
+
+			int priority;
+			uint64_t sequence;
+			bool running;
+			Clock::time_point started;
+			vector<Waiter> waiters;
+		};
+
+		/* Queue order: highest priority first, then first queued */
+		struct JobOrder {
+			bool operator()(const Job* a, const Job* b) const;
+		};
+
+		ServerOptions options;
+		int listenFd;
+		atomic<bool> stopping;
+
+		mutex lock;
+		condition_variable jobReady;
+		map<JobKey, shared_ptr<Job>> jobs;
+		set<Job*, JobOrder> queue;
+		uint64_t nextSequence;
+
+		vector<thread> workers;
+
+		/* Open client connections, each read by its own thread */
+		set<shared_ptr<Connection>> connections;
+		int activeConnections;
+		condition_variable connectionsDone;
+
+		/* Counters and the most recent latencies in milliseconds, guarded by lock */
+		uint64_t requests;
+		uint64_t coalesced;
+		uint64_t refused;
+		uint64_t expired;
+		uint64_t searches;
+		vector<double> queueLatency;
+		vector<double> serviceLatency;
+		size_t latencyIndex;
+
+		// Helper functions
+
+		/**
+		 * Reads request lines from a client until it disconnects.
+		 */
+		void serveConnection(shared_ptr<Connection> connection);
+
+
+		/**
+		 * Handles one request line.
+		 */
+		void handleRequest(const shared_ptr<Connection>& connection, const string& line);
+
+
+		/**
+		 * Takes searches off the queue and runs them, until the server stops.
+		 */
+		void workerLoop();
+
+
+		/**
+		 * Records the latencies of one answered request. Called with lock held.
+		 */
+		void recordLatency(double queuedMs, double serviceMs);
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef ATTACKMAPS_H
+#define ATTACKMAPS_H
+
+#include "Bitboard.h"
+
+// Attack generation for single pieces
+
+/**
+ * Returns the squares a rook on the given square attacks.
+ *
+ * @param square The square of the rook.
+ * @param occupied All occupied squares; a ray stops at (and includes) the first one.
+ * @return The attacked squares.
+ */
+Bitboard rookAttacks(int square, Bitboard occupied);
+
+/**
+ * Returns the squares a bishop on the given square attacks.
+ *
+ * @param square The square of the bishop.
+ * @param occupied All occupied squares; a ray stops at (and includes) the first one.
+ * @return The attacked squares.
+ */
+Bitboard bishopAttacks(int square, Bitboard occupied);
+
+/**
+ * Returns the squares a knight on the given square attacks.
+ */
+Bitboard knightAttacks(int square);
+
+/**
+ * Returns the squares a king on the given square attacks.
+ */
+Bitboard kingAttacks(int square);
+
+/**
+ * Returns the squares a pawn of the given colour attacks (its diagonal capture squares).
+ *
+ * @param colour Colour index of the pawn (0 = White, 1 = Black).
+ * @param square The square of the pawn.
+ */
+Bitboard pawnAttacks(int colour, int square);
+
+/**
+ * Returns the squares a piece attacks.
+ *
+ * @param type The PieceType of the piece.
+ * @param colour Colour index of the piece (0 = White, 1 = Black).
+ * @param square The square of the piece.
+ * @param occupied All occupied squares.
+ * @return The attacked squares, including squares holding pieces of its own colour.
+ */
+Bitboard pieceAttacks(int type, int colour, int square, Bitboard occupied);
+
+
+/**
+ * Per-square attack maps for both colours.
+ *
+ * attackers[colour][square] holds the squares of all pieces of that colour which
+ * attack the square, so "is this square attacked?" is a single lookup. The maps
+ * are built once for a position and then kept up to date after each change to
+ * the board by update(), which only recomputes the pieces whose attacks can
+ * have changed: the pieces on the changed squares and the sliding pieces whose
+ * rays reach those squares.
+ */
+struct AttackMaps {
+
+	/* Squares of the pieces of each colour attacking each square */
+	Bitboard attackers[2][64];
+
+	/* Squares attacked by the piece on each square (empty for empty squares) */
+	Bitboard attacksFrom[64];
+
+	/* Squares whose attacksFrom entry is counted for each colour */
+	Bitboard owners[2];
+
+
+	/**
+	 * Builds the maps from scratch.
+	 *
+	 * @param colourPieces The squares occupied by each colour.
+	 * @param typePieces The squares occupied by each PieceType.
+	 */
+	void build(const Bitboard colourPieces[2], const Bitboard typePieces[6]);
+
+
+	/**
+	 * Updates the maps after pieces have been placed on or removed from some squares.
+	 *
+	 * @param colourPieces The squares occupied by each colour after the change.
+	 * @param typePieces The squares occupied by each PieceType after the change.
+	 * @param changed The squares whose contents changed.
+	 */
+	void update(const Bitboard colourPieces[2], const Bitboard typePieces[6], Bitboard changed);
+
+
+	private:
+
+		/**
+		 * Recomputes the attacks of the piece on one square (if any).
+		 */
+		void refreshSquare(int square, const Bitboard colourPieces[2], const Bitboard typePieces[6]);
+};
+
+#endif
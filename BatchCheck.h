@@ -0,0 +1,75 @@
+#ifndef BATCHCHECK_H
+#define BATCHCHECK_H
+
+#include "ChessBoard.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Many independent positions in structure-of-arrays layout: one array of
+ * bitboards per colour and PieceType, with position i in lane i of every
+ * array, so a vector instruction works on four positions at once.
+ */
+struct BoardBatch {
+	/* pieces[colour index][PieceType][lane] */
+	vector<Bitboard> pieces[2][6];
+
+	/* 0 = White to move, 1 = Black to move */
+	vector<uint8_t> sideToMove;
+
+	/**
+	 * Adds a position as the next lane.
+	 */
+	void add(const ChessBoard& cb);
+
+	/**
+	 * Returns the number of positions.
+	 */
+	size_t size() const;
+
+	void clear();
+};
+
+
+/* Ways the batch functions can run */
+enum BatchKernel { BATCH_AUTO, BATCH_SCALAR, BATCH_AVX2 };
+
+/**
+ * Returns true if this CPU can run the AVX2 kernel.
+ */
+bool batchAvx2Supported();
+
+
+/**
+ * Works out for every position whether the side to move is in check.
+ *
+ * Attacks on each King are found as in kingInCheck, but from the bitboards
+ * alone: sliding attacks with Kogge-Stone occluded fills out from the King
+ * square, and knight, pawn and King attacks with shifts. The AVX2 kernel does
+ * four positions per instruction; the scalar one does the same steps a lane at
+ * a time and gives the same results.
+ *
+ * @param batch The positions.
+ * @param inCheck Set to one result per lane: 1 if the side to move is in check.
+ * @param kernel BATCH_AUTO picks AVX2 when the CPU has it; BATCH_AVX2 falls back
+ * to scalar without it.
+ */
+void batchInCheck(const BoardBatch& batch, vector<uint8_t>& inCheck, BatchKernel kernel = BATCH_AUTO);
+
+
+/**
+ * Works out for every position whether a move leaves the mover's King safe,
+ * as ChessBoard::isLegal does. The moves are made on a copy of the batch a
+ * lane at a time, then the mover's Kings are tested for all lanes at once.
+ *
+ * @param batch The positions.
+ * @param moves One move per lane, each pseudo-legal in its position (see ChessBoard::isPseudoLegal).
+ * @param legal Set to one result per lane: 1 if the move is legal; 0 also if the
+ * source square holds no piece of the side to move.
+ * @param kernel As for batchInCheck.
+ */
+void batchIsLegal(const BoardBatch& batch, const vector<Move>& moves, vector<uint8_t>& legal, BatchKernel kernel = BATCH_AUTO);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+/*
+ * A set of squares, one bit per square. Bit n is square n using the square
+ * numbering in ChessMove.h (bit 0 = A8, bit 63 = H1).
+ */
+typedef uint64_t Bitboard;
+
+/* Squares on file A and file H, used to stop shifts wrapping around the board */
+const Bitboard FILE_A = 0x0101010101010101ULL;
+const Bitboard FILE_H = 0x8080808080808080ULL;
+
+
+/**
+ * Returns a bitboard with only the given square set.
+ */
+constexpr Bitboard squareBit(int square) {
+	return 1ULL << square;
+}
+
+/**
+ * Returns the number of squares in a bitboard.
+ */
+inline int popCount(Bitboard bitboard) {
+	return __builtin_popcountll(bitboard);
+}
+
+/**
+ * Returns the lowest square in a non-empty bitboard.
+ */
+inline int lowestSquare(Bitboard bitboard) {
+	return __builtin_ctzll(bitboard);
+}
+
+/**
+ * Returns the highest square in a non-empty bitboard.
+ */
+inline int highestSquare(Bitboard bitboard) {
+	return 63 - __builtin_clzll(bitboard);
+}
+
+/**
+ * Removes the lowest square from a non-empty bitboard and returns it.
+ */
+inline int popLowestSquare(Bitboard& bitboard) {
+	int square = __builtin_ctzll(bitboard);
+	bitboard &= bitboard - 1;
+	return square;
+}
+
+#endif
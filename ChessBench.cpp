@@ -0,0 +1,925 @@
+#include"BatchCheck.h"
+#include"ChessBoard.h"
+#include"LiveGame.h"
+#include"PerfCounters.h"
+#include"Perft.h"
+#include"Search.h"
+#include"StaticExchange.h"
+#include"TimeManager.h"
+#include"TrainingData.h"
+
+#include<atomic>
+#include<chrono>
+#include<cstdio>
+#include<cstring>
+#include<iostream>
+#include<memory>
+#include<mutex>
+#include<random>
+#include<thread>
+#include<vector>
+#include<algorithm>
+
+using namespace std;
+
+// Positions the benchmarks run over
+static const char* benchPositions[] = {
+	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq",
+	"r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/3P1N2/PPP2PPP/RNBQK2R w KQkq",
+	"r2qk2r/pb1nbppp/1p2pn2/2pp4/3P4/1PN1PN2/PBQ1BPPP/R3K2R b KQkq",
+	"4k3/8/8/3q4/8/2N5/8/4K2R w K",
+	"r3k2r/8/8/8/3Q4/8/8/R3K2R b KQkq",
+};
+
+static const int positionCount = sizeof(benchPositions) / sizeof(benchPositions[0]);
+
+// Results are added here so the compiler cannot drop the work being timed
+static volatile long benchSink;
+
+// Returns seconds since an arbitrary start point
+static double now() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Prints one result line
+static void report(const char* name, const char* mode, long operations, double seconds) {
+	printf("%-22s %-10s %10ld ops %9.1f ns/op\n", name, mode, operations, seconds * 1e9 / operations);
+}
+
+/* Hardware counters of the bench thread, opened when the bench is run with --counters */
+static PerfCounters counters;
+
+/* Wall time and hardware counts of the timed sections of one benchmark */
+struct Measurement {
+	double seconds = 0;
+	PerfCounts counts;
+
+	double startTime;
+	PerfCounts startCounts;
+
+	// Counters are read outside the timed interval so the reads do not add to the time
+	void start() {
+		if (counters.isOpen()) {
+			startCounts = counters.read();
+		}
+		startTime = now();
+	}
+
+	void stop() {
+		seconds += now() - startTime;
+		if (counters.isOpen()) {
+			counts += counters.read() - startCounts;
+		}
+	}
+};
+
+// Prints one result line, followed by the hardware counts per operation when they are collected
+static void report(const char* name, const char* mode, long operations, const Measurement& measured) {
+
+	report(name, mode, operations, measured.seconds);
+	if (!counters.isOpen()) {
+		return;
+	}
+
+	printf("%34s", "");
+	for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+		if (counters.has(event)) {
+			printf(" %s %.2f", perfEventName(event), measured.counts.values[event] / operations);
+		}
+	}
+	if (counters.has(PERF_CYCLES) && counters.has(PERF_INSTRUCTIONS) && measured.counts.values[PERF_CYCLES] > 0) {
+		printf(" IPC %.2f", measured.counts.values[PERF_INSTRUCTIONS] / measured.counts.values[PERF_CYCLES]);
+	}
+	printf(" /op\n");
+}
+
+// Collects every legal move of the active player by trying all square pairs
+static vector<Move> legalMoves(ChessBoard& cb) {
+	vector<Move> moves;
+	for (int source = 0; source < 64; source++) {
+		for (int dest = 0; dest < 64; dest++) {
+			if (source != dest && cb.isLegalMove(encodeMove(source, dest))) {
+				moves.push_back(encodeMove(source, dest));
+			}
+		}
+	}
+	return moves;
+}
+
+// Repeated check queries on an unchanging position
+static void benchCheckQuery(bool maps) {
+
+	const int repeats = 200000;
+	long operations = 0;
+	int found = 0;
+	Measurement measured;
+
+	for (int p = 0; p < positionCount; p++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[p]);
+		cb.enableAttackMaps(maps);
+
+		measured.start();
+		for (int i = 0; i < repeats; i++) {
+			found += cb.kingInCheck(i & 1 ? 'w' : 'b');
+			found += cb.squareAttacked(i & 63, i & 2 ? 'w' : 'b');
+		}
+		measured.stop();
+		operations += 2 * repeats;
+	}
+	report("check/attack query", maps ? "maps" : "on-demand", operations, measured);
+	benchSink += found;
+}
+
+// Make and unmake every legal move, which is the cost of keeping the maps up to date
+static void benchMakeUnmake(bool maps) {
+
+	const int repeats = 2000;
+	long operations = 0;
+	Measurement measured;
+
+	for (int p = 0; p < positionCount; p++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[p]);
+		vector<Move> moves = legalMoves(cb);
+		cb.enableAttackMaps(maps);
+
+		measured.start();
+		for (int i = 0; i < repeats; i++) {
+			for (Move move : moves) {
+				MoveUndo undo = cb.doMove(move);
+				cb.undoMove(move, undo);
+			}
+		}
+		measured.stop();
+		operations += (long)repeats * moves.size();
+	}
+	report("make/unmake", maps ? "maps" : "on-demand", operations, measured);
+}
+
+// Make a move then test the mover's King, as a legality check does
+static void benchMakeCheck(bool maps) {
+
+	const int repeats = 2000;
+	long operations = 0;
+	int found = 0;
+	Measurement measured;
+
+	for (int p = 0; p < positionCount; p++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[p]);
+		char colour = cb.getActiveColour();
+		vector<Move> moves = legalMoves(cb);
+		cb.enableAttackMaps(maps);
+
+		measured.start();
+		for (int i = 0; i < repeats; i++) {
+			for (Move move : moves) {
+				MoveUndo undo = cb.doMove(move);
+				found += cb.kingInCheck(colour);
+				cb.undoMove(move, undo);
+			}
+		}
+		measured.stop();
+		operations += (long)repeats * moves.size();
+	}
+	report("make/check/unmake", maps ? "maps" : "on-demand", operations, measured);
+	benchSink += found;
+}
+
+// Full legality sweep over every square pair; without maps this uses the validMove based check
+static void benchLegalitySweep(bool maps) {
+
+	const int repeats = 20;
+	long operations = 0;
+	long found = 0;
+	Measurement measured;
+
+	for (int p = 0; p < positionCount; p++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[p]);
+		cb.enableAttackMaps(maps);
+
+		measured.start();
+		for (int i = 0; i < repeats; i++) {
+			found += legalMoves(cb).size();
+		}
+		measured.stop();
+		operations += repeats * 64 * 63;
+	}
+	report("isLegalMove sweep", maps ? "maps" : "validMove", operations, measured);
+	benchSink += found;
+}
+
+// Positions reached by random play from the bench positions, each with one of its pseudo-legal moves picked at random
+static void batchPositions(int count, vector<ChessBoard>& boards, vector<Move>& moves) {
+
+	mt19937 random(1);
+
+	while ((int)boards.size() < count) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[boards.size() % positionCount]);
+
+		for (int ply = 0; ply < 40 && (int)boards.size() < count; ply++) {
+			MoveList legal;
+			cb.generateLegalMoves(legal);
+			if (legal.size == 0) {
+				break;
+			}
+
+			vector<Move> pseudoLegal;
+			for (int source = 0; source < 64; source++) {
+				for (int dest = 0; dest < 64; dest++) {
+					if (source != dest && cb.isPseudoLegal(encodeMove(source, dest))) {
+						pseudoLegal.push_back(encodeMove(source, dest));
+					}
+				}
+			}
+			boards.push_back(cb);
+			moves.push_back(pseudoLegal[random() % pseudoLegal.size()]);
+
+			cb.doMove(legal.moves[random() % legal.size]);
+		}
+	}
+}
+
+// Check and legality tests over many positions, a board at a time against the structure-of-arrays batch
+static void benchBatchCheck(int positions) {
+
+	vector<ChessBoard> boards;
+	vector<Move> moves;
+	batchPositions(positions, boards, moves);
+
+	BoardBatch batch;
+	for (const ChessBoard& cb : boards) {
+		batch.add(cb);
+	}
+
+	const int repeats = 200;
+	long operations = (long)repeats * positions;
+	long found = 0;
+	vector<uint8_t> results;
+
+	Measurement measured;
+	measured.start();
+	for (int i = 0; i < repeats; i++) {
+		for (const ChessBoard& cb : boards) {
+			found += cb.kingInCheck(cb.getActiveColour());
+		}
+	}
+	measured.stop();
+	report("side to move in check", "per board", operations, measured);
+
+	for (int kernel = BATCH_SCALAR; kernel <= BATCH_AVX2; kernel++) {
+		if (kernel == BATCH_AVX2 && !batchAvx2Supported()) {
+			cout << "(no AVX2 on this CPU)\n";
+			continue;
+		}
+		measured = Measurement();
+		measured.start();
+		for (int i = 0; i < repeats; i++) {
+			batchInCheck(batch, results, (BatchKernel)kernel);
+			found += results[i % positions];
+		}
+		measured.stop();
+		report("side to move in check", kernel == BATCH_SCALAR ? "batch" : "batch AVX2", operations, measured);
+	}
+
+	measured = Measurement();
+	measured.start();
+	for (int i = 0; i < repeats; i++) {
+		for (int p = 0; p < positions; p++) {
+			found += boards[p].isLegal(moves[p]);
+		}
+	}
+	measured.stop();
+	report("move leaves King safe", "per board", operations, measured);
+
+	for (int kernel = BATCH_SCALAR; kernel <= BATCH_AVX2; kernel++) {
+		if (kernel == BATCH_AVX2 && !batchAvx2Supported()) {
+			continue;
+		}
+		measured = Measurement();
+		measured.start();
+		for (int i = 0; i < repeats; i++) {
+			batchIsLegal(batch, moves, results, (BatchKernel)kernel);
+			found += results[i % positions];
+		}
+		measured.stop();
+		report("move leaves King safe", kernel == BATCH_SCALAR ? "batch" : "batch AVX2", operations, measured);
+	}
+
+	benchSink += found;
+}
+
+// Fixed depth searches with and without move ordering
+static void benchMoveOrdering(int depth) {
+
+	uint64_t nodes[2] = { 0, 0 };
+	uint64_t cutoffs[2] = { 0, 0 };
+	uint64_t firstMoveCutoffs[2] = { 0, 0 };
+	double seconds[2] = { 0, 0 };
+
+	for (int ordered = 0; ordered <= 1; ordered++) {
+		for (int p = 0; p < positionCount; p++) {
+			ChessBoard cb;
+			cb.setPosition(benchPositions[p]);
+
+			unique_ptr<Searcher> searcher(new Searcher(16));
+			searcher->setMoveOrdering(ordered);
+
+			SearchLimits limits;
+			limits.depth = depth;
+			SearchResult result = searcher->search(cb, limits);
+
+			nodes[ordered] += result.stats.nodes;
+			cutoffs[ordered] += result.stats.cutoffs;
+			firstMoveCutoffs[ordered] += result.stats.firstMoveCutoffs;
+			seconds[ordered] += result.seconds;
+		}
+
+		string name = "alpha-beta depth " + to_string(depth);
+		printf("%-22s %-10s %10llu nodes %8.3fs  first-move cutoffs %5.1f%%\n", name.c_str(),
+			ordered ? "ordered" : "unordered", (unsigned long long)nodes[ordered], seconds[ordered],
+			100.0 * firstMoveCutoffs[ordered] / (cutoffs[ordered] ? cutoffs[ordered] : 1));
+	}
+
+	printf("%-22s %-10s %9.1f%% fewer nodes with ordering\n", "node reduction", "",
+		100.0 * (1.0 - (double)nodes[1] / (nodes[0] ? nodes[0] : 1)));
+}
+
+// Ways of getting a second board in the same position
+static void benchBoardCopy() {
+
+	const int repeats = 200000;
+	long total = 0;
+
+	ChessBoard source;
+	source.setPosition(benchPositions[2]);
+	PackedPosition packed;
+	source.packState(packed);
+
+	Measurement measured;
+	measured.start();
+	for (int r = 0; r < repeats; r++) {
+		ChessBoard cb;
+		total += cb.getKey();
+	}
+	measured.stop();
+	report("construct board", "empty", repeats, measured);
+
+	measured = Measurement();
+	measured.start();
+	for (int r = 0; r < repeats; r++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[2]);
+		total += cb.getKey();
+	}
+	measured.stop();
+	report("construct board", "from FEN", repeats, measured);
+
+	measured = Measurement();
+	measured.start();
+	for (int r = 0; r < repeats; r++) {
+		ChessBoard cb;
+		cb.unpackState(packed);
+		total += cb.getKey();
+	}
+	measured.stop();
+	report("construct board", "unpack", repeats, measured);
+
+	measured = Measurement();
+	measured.start();
+	for (int r = 0; r < repeats; r++) {
+		ChessBoard cb = source;
+		total += cb.getKey();
+	}
+	measured.stop();
+	report("construct board", "copy", repeats, measured);
+
+	benchSink = total;
+}
+
+// Destinations of every square as a UI asks for them: trial moves against the cached legal move list
+static void benchSquareQueries(bool cached) {
+
+	const int repeats = (cached ? 20000 : 200);
+	long operations = 0;
+	long total = 0;
+	Measurement measured;
+
+	for (int p = 0; p < positionCount; p++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[p]);
+		Move move = legalMoves(cb)[0];
+
+		measured.start();
+		for (int r = 0; r < repeats; r++) {
+			// Each round is a new position to the board, as after the opponent's reply
+			MoveUndo undo = cb.doMove(move);
+			cb.undoMove(move, undo);
+
+			for (int source = 0; source < 64; source++) {
+				if (cached) {
+					total += popCount(cb.legalMovesFrom(source));
+				}
+				else {
+					for (int dest = 0; dest < 64; dest++) {
+						total += (source != dest && cb.isLegalMove(encodeMove(source, dest)));
+					}
+				}
+			}
+		}
+		measured.stop();
+		operations += (long)repeats * 64;
+	}
+
+	benchSink = total;
+	report("destinations of square", cached ? "cached" : "trial", operations, measured);
+}
+
+// Post-move status of the player to move, worked out fresh after each move and then asked again
+static void benchGameStatus() {
+
+	const int repeats = 20000;
+	long operations = 0;
+	long total = 0;
+	double seconds[2] = { 0, 0 };
+
+	for (int p = 0; p < positionCount; p++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[p]);
+		vector<Move> moves = legalMoves(cb);
+
+		for (int r = 0; r < repeats; r++) {
+			Move move = moves[r % moves.size()];
+			MoveUndo undo = cb.doMove(move);
+
+			double start = now();
+			total += cb.gameStatus(cb.getActiveColour());
+			double middle = now();
+			total += cb.gameStatus(cb.getActiveColour());
+			seconds[0] += middle - start;
+			seconds[1] += now() - middle;
+
+			cb.undoMove(move, undo);
+		}
+		operations += repeats;
+	}
+
+	benchSink = total;
+	report("game status", "first", operations, seconds[0]);
+	report("game status", "repeat", operations, seconds[1]);
+}
+
+// Serial perft without a cache, the cost of generating, making and unmaking each move of the tree
+static void benchPerft() {
+
+	const int depths[] = { 4, 3, 3 };
+
+	for (int p = 0; p < 3; p++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[p]);
+
+		Measurement measured;
+		measured.start();
+		uint64_t nodes = perft(cb, depths[p]);
+		measured.stop();
+
+		char mode[16];
+		snprintf(mode, sizeof(mode), "pos %d d%d", p + 1, depths[p]);
+		report("perft nodes", mode, nodes, measured);
+	}
+}
+
+// Exchange evaluation of every capture in the bench positions
+static void benchStaticExchange() {
+
+	const int repeats = 20000;
+	long operations = 0;
+	long total = 0;
+	Measurement measured;
+
+	for (int p = 0; p < positionCount; p++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[p]);
+
+		MoveList captures;
+		cb.generateMoves(captures, GEN_CAPTURES);
+
+		measured.start();
+		for (int r = 0; r < repeats; r++) {
+			for (int i = 0; i < captures.size; i++) {
+				total += staticExchange(cb, captures.moves[i]);
+			}
+		}
+		measured.stop();
+		operations += (long)repeats * captures.size;
+	}
+
+	benchSink = total;
+	report("static exchange", "captures", operations, measured);
+}
+
+// Fixed depth search with and without the quiescence search
+static void benchQuiescence(int depth) {
+
+	for (int quiet = 0; quiet <= 1; quiet++) {
+		uint64_t nodes = 0;
+		uint64_t qnodes = 0;
+		double seconds = 0;
+
+		for (int p = 0; p < positionCount; p++) {
+			ChessBoard cb;
+			cb.setPosition(benchPositions[p]);
+
+			unique_ptr<Searcher> searcher(new Searcher(16));
+			searcher->setQuiescence(quiet);
+
+			SearchLimits limits;
+			limits.depth = depth;
+			SearchResult result = searcher->search(cb, limits);
+
+			nodes += result.stats.nodes;
+			qnodes += result.stats.qnodes;
+			seconds += result.seconds;
+		}
+
+		string name = "alpha-beta depth " + to_string(depth);
+		printf("%-22s %-10s %10llu nodes %8.3fs  quiescence nodes %5.1f%%\n", name.c_str(),
+			quiet ? "quiesce" : "static", (unsigned long long)nodes, seconds,
+			100.0 * qnodes / (nodes ? nodes : 1));
+	}
+}
+
+// Fixed depth search finding the best one, three and five root moves
+static void benchMultiPV(int depth) {
+
+	uint64_t singleNodes = 0;
+	for (int lines = 1; lines <= 5; lines += 2) {
+		uint64_t nodes = 0;
+		double seconds = 0;
+
+		for (int p = 0; p < positionCount; p++) {
+			ChessBoard cb;
+			cb.setPosition(benchPositions[p]);
+
+			unique_ptr<Searcher> searcher(new Searcher(16));
+			SearchLimits limits;
+			limits.depth = depth;
+			limits.multiPV = lines;
+			SearchResult result = searcher->search(cb, limits);
+
+			nodes += result.stats.nodes;
+			seconds += result.seconds;
+		}
+		if (lines == 1) {
+			singleNodes = nodes;
+		}
+
+		string name = "alpha-beta depth " + to_string(depth);
+		string mode = "multipv " + to_string(lines);
+		printf("%-22s %-10s %10llu nodes %8.3fs  %4.2fx the nodes of one line\n", name.c_str(), mode.c_str(),
+			(unsigned long long)nodes, seconds, (double)nodes / (singleNodes ? singleNodes : 1));
+	}
+}
+
+// Fixed depth search with and without the pawn structure and evaluation caches
+static void benchEvalCache(int depth) {
+
+	// The gain is a few percent, less than the run to run noise, so the modes take turns and each keeps its fastest round
+	const int rounds = 5;
+	SearchStats total[2];
+	double seconds[2] = { 0, 0 };
+
+	for (int round = 0; round < rounds; round++) {
+		for (int cached = 0; cached <= 1; cached++) {
+			SearchStats sum;
+			double elapsed = 0;
+
+			for (int p = 0; p < positionCount; p++) {
+				ChessBoard cb;
+				cb.setPosition(benchPositions[p]);
+
+				unique_ptr<Searcher> searcher(new Searcher(16));
+				searcher->setEvalCache(cached);
+
+				SearchLimits limits;
+				limits.depth = depth;
+				SearchResult result = searcher->search(cb, limits);
+
+				sum.nodes += result.stats.nodes;
+				sum.pawnProbes += result.stats.pawnProbes;
+				sum.pawnHits += result.stats.pawnHits;
+				sum.evalProbes += result.stats.evalProbes;
+				sum.evalHits += result.stats.evalHits;
+				elapsed += result.seconds;
+			}
+
+			if (round == 0 || elapsed < seconds[cached]) {
+				total[cached] = sum;
+				seconds[cached] = elapsed;
+			}
+		}
+	}
+
+	for (int cached = 0; cached <= 1; cached++) {
+		string name = "alpha-beta depth " + to_string(depth);
+		printf("%-22s %-10s %10llu nodes %8.3fs %9.0f nodes/s", name.c_str(), cached ? "cached" : "uncached",
+			(unsigned long long)total[cached].nodes, seconds[cached], total[cached].nodes / (seconds[cached] > 0 ? seconds[cached] : 1e-9));
+		if (cached) {
+			printf("  eval hits %4.1f%%  pawn hits %4.1f%%", 100.0 * total[cached].evalHits / (total[cached].evalProbes ? total[cached].evalProbes : 1),
+				100.0 * total[cached].pawnHits / (total[cached].pawnProbes ? total[cached].pawnProbes : 1));
+		}
+		printf("\n");
+	}
+}
+
+// Spectator threads reading a game while one writer plays moves, through snapshots or a board behind a mutex
+static void benchSpectators(int readers, bool snapshots) {
+
+	const double duration = 0.25;
+	LiveGame game;
+	ChessBoard locked;
+	locked.setPosition(benchPositions[0]);
+	mutex boardLock;
+
+	atomic<bool> done(false);
+	atomic<long> reads(0);
+	atomic<long> sink(0);
+	vector<thread> threads;
+
+	for (int t = 0; t < readers; t++) {
+		threads.push_back(thread([&]() {
+			SnapshotReader reader(game);
+			long count = 0;
+			long total = 0;
+			while (!done.load(memory_order_relaxed)) {
+				if (snapshots) {
+					const GameSnapshot* snapshot = reader.acquire();
+					total += snapshot->key + snapshot->status + snapshot->pieceAt(count & 63);
+					reader.release();
+				} else {
+					PackedPosition position;
+					boardLock.lock();
+					locked.packState(position);
+					total += locked.getKey() + locked.gameStatus(locked.getActiveColour()) + position.squares[count & 31];
+					boardLock.unlock();
+				}
+				count++;
+			}
+			reads += count;
+			sink += total;
+		}));
+	}
+
+	// The writer plays a fixed sequence of games from the starting position
+	ChessBoard cb;
+	cb.setPosition(benchPositions[0]);
+	long moves = 0;
+	double start = now();
+	double writing = 0;
+	while (now() - start < duration) {
+		MoveList list;
+		cb.generateLegalMoves(list);
+		if (list.size == 0 || moves % 200 == 199) {
+			cb.setPosition(benchPositions[0]);
+			double before = now();
+			if (snapshots) {
+				game.loadState(benchPositions[0]);
+			} else {
+				lock_guard<mutex> hold(boardLock);
+				locked.setPosition(benchPositions[0]);
+			}
+			writing += now() - before;
+			moves++;
+			continue;
+		}
+
+		Move move = list.moves[(moves * 7) % list.size];
+		cb.applyMove(move);
+		double before = now();
+		if (snapshots) {
+			game.playMove(move);
+		} else {
+			lock_guard<mutex> hold(boardLock);
+			if (locked.isLegalMove(move)) {
+				locked.applyMove(move);
+			}
+			locked.gameStatus(locked.getActiveColour());
+		}
+		writing += now() - before;
+		moves++;
+	}
+	double seconds = now() - start;
+
+	done = true;
+	for (thread& t : threads) {
+		t.join();
+	}
+	benchSink = sink;
+
+	char mode[24];
+	snprintf(mode, sizeof(mode), "%s x%d", snapshots ? "snapshot" : "mutex", readers);
+	report("spectator reads", mode, reads.load(), seconds * readers);
+	report("writer moves", mode, moves, writing);
+}
+
+// Searches under a time control and prints a histogram of how long each move took
+static void benchMoveLatency(const char* mode, const TimeControl& tc, int repeats) {
+
+	vector<double> times;
+	double budget = 0;
+	Searcher searcher(16);
+
+	for (int r = 0; r < repeats; r++) {
+		for (int p = 0; p < positionCount; p++) {
+			ChessBoard cb;
+			cb.setPosition(benchPositions[p]);
+			searcher.clear();
+
+			TimeManager timer(tc);
+			SearchLimits limits;
+			limits.time = &timer;
+			SearchResult result = searcher.search(cb, limits);
+			times.push_back(timer.elapsed() * 1000);
+
+			benchSink = result.bestMove;
+			budget = (timer.getHardLimit() + tc.overhead) * 1000;
+		}
+	}
+
+	sort(times.begin(), times.end());
+	size_t count = times.size();
+	printf("%-22s %-10s %10zu moves  median %6.2fms  p99 %6.2fms  max %6.2fms  budget %6.2fms  worst overrun %+.2fms\n",
+		"move latency", mode, count, times[count / 2], times[(count * 99) / 100 < count ? (count * 99) / 100 : count - 1],
+		times[count - 1], budget, times[count - 1] - budget);
+
+	// Ten equal bins up to the budget, then one for anything over it
+	const int bins = 10;
+	int counts[bins + 1] = { 0 };
+	for (double t : times) {
+		int bin = (int)(t / budget * bins);
+		counts[bin < bins ? bin : bins]++;
+	}
+	for (int b = 0; b <= bins; b++) {
+		string range = (b < bins ? "[" + to_string(b * 10) + "%, " + to_string(b * 10 + 10) + "%)" : "over budget");
+		printf("%-22s %-10s %10d%s%s\n", "", range.c_str(), counts[b], counts[b] ? " " : "", string(counts[b], '#').c_str());
+	}
+}
+
+// Packing positions into training records, and writing them through the buffered writer
+static void benchTrainingExport() {
+
+	const int records = 2000000;
+	const char* path = "bench-training.bin";
+
+	// Positions along a game so the records are not all alike
+	vector<ChessBoard> boards;
+	for (int p = 0; p < positionCount; p++) {
+		ChessBoard cb;
+		cb.setPosition(benchPositions[p]);
+		for (int ply = 0; ply < 40; ply++) {
+			boards.push_back(cb);
+			MoveList moves;
+			cb.generateLegalMoves(moves);
+			if (moves.size == 0) {
+				break;
+			}
+			cb.doMove(moves.moves[(ply * 7) % moves.size]);
+		}
+	}
+
+	vector<TrainingRecord> packed(boards.size());
+	long total = 0;
+
+	Measurement measured;
+	measured.start();
+	for (int r = 0; r < records; r++) {
+		size_t b = r % boards.size();
+		packTrainingRecord(boards[b], r & 255, 0, (int)b, packed[b]);
+		total += packed[b].occupied;
+	}
+	measured.stop();
+	report("training records", "pack", records, measured);
+
+	measured = Measurement();
+	measured.start();
+	for (int r = 0; r < records; r++) {
+		ChessBoard cb;
+		unpackTrainingRecord(packed[r % packed.size()], cb);
+		total += cb.getKey();
+	}
+	measured.stop();
+	report("training records", "unpack", records, measured);
+
+	for (int shuffle = 0; shuffle <= 1; shuffle++) {
+		measured = Measurement();
+	measured.start();
+		TrainingWriter writer(path, 0, 1 << 18, shuffle);
+		for (int r = 0; r < records; r++) {
+			writer.add(packed[r % packed.size()]);
+		}
+		writer.close();
+		measured.stop();
+		report("training records", shuffle ? "shuffled" : "write", records, measured);
+	}
+	remove(path);
+
+	benchSink = total;
+}
+
+int main(int argc, char** argv) {
+
+	cout << "========================\n";
+	cout << "Chess Engine Benchmarks\n";
+	cout << "========================\n\n";
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--counters")) {
+			if (!counters.open()) {
+				cout << "Hardware counters unavailable: " << counters.getError() << "; timing only\n\n";
+			}
+		}
+		else {
+			cerr << "usage: bench [--counters]" << endl;
+			return 1;
+		}
+	}
+
+	cout << "Attack maps against on-demand attack computation\n";
+	for (int maps = 0; maps <= 1; maps++) {
+		benchCheckQuery(maps);
+	}
+	for (int maps = 0; maps <= 1; maps++) {
+		benchMakeUnmake(maps);
+	}
+	for (int maps = 0; maps <= 1; maps++) {
+		benchMakeCheck(maps);
+	}
+	for (int maps = 0; maps <= 1; maps++) {
+		benchLegalitySweep(maps);
+	}
+	cout << '\n';
+
+	cout << "Batched check detection (structure of arrays, Kogge-Stone fills) against one board at a time\n";
+	benchBatchCheck(4096);
+	cout << '\n';
+
+	cout << "Board value type (" << sizeof(ChessBoard) << " bytes, no heap allocation)\n";
+	benchBoardCopy();
+	cout << '\n';
+
+	cout << "Per-square legal move queries (one new position per 64 queries)\n";
+	for (int cached = 0; cached <= 1; cached++) {
+		benchSquareQueries(cached);
+	}
+	benchGameStatus();
+	cout << '\n';
+
+	cout << "Move generation tree walk\n";
+	benchPerft();
+	cout << '\n';
+
+	cout << "Staged move picker (TT move, MVV-LVA captures, killers, history) against generation order\n";
+	benchMoveOrdering(5);
+	cout << '\n';
+
+	cout << "Multi-PV search (each further line searched with the earlier lines' root moves left out)\n";
+	benchMultiPV(5);
+	cout << '\n';
+
+	cout << "Quiescence search with exchange and delta pruning against static evaluation at the horizon\n";
+	benchStaticExchange();
+	benchQuiescence(5);
+	cout << '\n';
+
+	cout << "Evaluation with pawn structure (" << PAWN_CACHE_KILOBYTES << " kB pawn cache, " << EVAL_CACHE_KILOBYTES
+		<< " kB evaluation cache per searcher)\n";
+	benchEvalCache(6);
+	cout << '\n';
+
+	cout << "Live game read by spectator threads (lock-free snapshots against a board behind a mutex)\n";
+	for (int readers = 1; readers <= 4; readers *= 4) {
+		for (int snapshots = 0; snapshots <= 1; snapshots++) {
+			benchSpectators(readers, snapshots);
+		}
+	}
+	cout << '\n';
+
+	cout << "Move times under time controls (hard limit checked every " << TIME_CHECK_INTERVAL << " nodes)\n";
+	TimeControl fixed;
+	fixed.moveTime = 0.050;
+	benchMoveLatency("50ms/move", fixed, 4);
+	TimeControl clock;
+	clock.timeLeft = 1.0;
+	clock.increment = 0.010;
+	benchMoveLatency("1s+10ms", clock, 4);
+	cout << '\n';
+
+	cout << "Training data export (" << sizeof(TrainingRecord) << " byte records, 256k record write buffer)\n";
+	benchTrainingExport();
+	cout << '\n';
+
+	return 0;
+}
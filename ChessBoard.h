@@ -1,236 +1,659 @@
-#ifndef CHESSBOARD_H
-#define CHESSBOARD_H
-
-#include "ChessPieces.h"
-#include <string>
-#include <map>
-
-// ChessBoard class declaration
-
-class ChessBoard {
-
-	public:
-
-		/**
-		 * Default ChessBoard class constructor that initiates the pieceMap
-		 */
-		ChessBoard();
-
-		/** 
-		 * ChessBoard destructor
-		 */
-		~ChessBoard();
-
-		/**
-		 * Loads a new chess board state from a FEN string representation.
-		 * 
-		 * @param boardState A null-terminated string representing the new board state.
-		 * The format includes piece placement data and the active colour.
-		 * Example: "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq"
-		 */
-		void loadState(const char*);
-		
-
-		/**
-		 * Submits a chess move from the source square to the destination square.
-		 *
-		 * @param sourceSquare A string representing the source square of the move (e.g., "A2").
-		 * @param destSquare A string representing the destination square of the move (e.g., "A4").
-		 * 
-		 * The function validates the move, checks for legality, and updates the chess board accordingly.
-		 * Displays appropriate messages for invalid moves, checks, checkmates, and stalemates.
-		 * Switches the active player's turn at the end of a valid move.
-		 */
-		void submitMove(const char*, const char*);
-
-
-		/**
-		 * Returns active colour
-		 *
-		 * @return active colour as a character
-		 */
-		char getActiveColour() const;
-
-		/**
-		 * Returns active colour as a string
-		 *
-		 * @return active colour as string
-		 */
-		string outputActiveColour() const;
-
-
-		/**
-		 * Function to print the board into a 2D array of characters for debugging 
-		 * and tracking moves.
-		*/
-		void printBoard();
-
-
-	private:
-
-		/* 2D character array representing the chess board */
-		Piece* board[8][8]; 
-
-		/* Map structure to generate piece pointers from FEN characters */
-		map<char, Piece*> pieceMap;
-
-		/* Stores character denoting whether active colour is black or white */
-		char activeColour;
-
-		// Game state variables
-		bool inCheckmate = false;
-		bool inStalemate = false;
-
-		// Helper functions
-
-		/**
-		 * Converts a string representation of piece data to a 2D array of 
-		 * Piece pointers on the chess board.
-		 * 
-		 * @param pieceData A null-terminated string containing piece placement data.
-		 * The board is defined to be of size 8x8.
-		 * The function modifies the board based on the pieceData input.
-		 * Null pointers represent empty spaces on the board.
-		*/
-		void convertToBoardOfPointers(char*);	
-
-
-		/**
-		 * Checks if the input length of the source and destination squares is valid.
-		 *
-		 * @param sourceSquare A string representing the source square of the move (e.g., "A2").
-		 * @param destSquare A string representing the destination square of the move (e.g., "A4").
-		 * @return true if the input lengths are valid (both strings are of length 2), false otherwise.
-		 * 
-		 * The function verifies that both source and destination squares have a valid input length of 2 characters.
-		 */
-		bool inputLengthIsValid(const char*, const char*);
-
-
-		/**
-		 * Checks if the specified source and destination squares exist on the chess board.
-		 *
-		 * @param sourceCol The column character of the source square (e.g., 'A').
-		 * @param sourceRow The row character of the source square (e.g., '1').
-		 * @param destCol The column character of the destination square (e.g., 'B').
-		 * @param destRow The row character of the destination square (e.g., '2').
-		 * @return true if both source and destination squares exist on the board, false otherwise.
-		 * 
-		 * The function verifies if the specified characters for source and destination squares
-		 * fall within the valid range for columns ('A' to 'H') and rows ('1' to '8').
-		 */
-		bool onBoard(char sourceCol, char sourceRow, char destCol, char destRow); 
-	
-
-		/**
-		 * Switches the active player's turn.
-		 *
-		 * @param colour The current active player's colour ('w' for White, 'b' for Black).
-		 * 
-		 * The function updates the active player's colour to switch turns between White and Black.
-		 */
-		void switchPlayer(char);
-		
-
-		// Move processing functions 
-
-		/**
-		 * Checks if a chess move is valid according to chess logic and does not put the player's King in check.
-		 *
-		 * @param sourceRowNo The row index of the source square.
-		 * @param sourceColNo The column index of the source square.
-		 * @param destRowNo The row index of the destination square.
-		 * @param destColNo The column index of the destination square.
-		 * @param capture A boolean indicating whether the move involves capturing an opponent's piece.
-		 * @return true if the move is valid according to chess logic and does not lead to the player's King being in check, false otherwise.
-		 * 
-		 * The function first checks if the move is valid according to the piece's specific move logic.
-		 * Then, it creates a copy of the board to simulate the move and checks if the move will put the player's King in check.
-		 */
-		bool moveIsValidAndNotInCheck(int sourceRowNo, int sourceColNo, int destRowNo, int destColNo, bool capture);
-		
-
-		/**
-		 * Moves a chess piece from the source square to the destination square and handles capturing.
-		 *
-		 * @param sourceSquare A string representing the source square of the move (e.g., "A2").
-		 * @param destSquare A string representing the destination square of the move (e.g., "A4").
-		 * 
-		 * The function updates the chess board by moving the piece from the source square to the destination square.
-		 * If there is a piece at the destination square, it is captured, and the board is updated accordingly.
-		 * Outputs the move details to the console.
-		 */
-		void makeMove(const char*, const char*);		
-		
-
-		/**
-		 * Checks if a player has any legal moves in response to a check.
-		 *
-		 * @param playerColour The colour of the player ('w' for White, 'b' for Black).
-		 * @return true if the player has at least one legal move to respond to check, false otherwise.
-		 * 
-		 * The function iterates through the chess board to find all pieces of the specified player's colour
-		 * and checks if any of those pieces can make legal moves to respond to a check.
-		 */
-		bool legalResponse(char);
-
-
-		/**
-		 * Checks if the specified chess piece at the given position can make a valid move.
-		 *
-		 * @param pieceRow The row index of the chess piece.
-		 * @param pieceCol The column index of the chess piece.
-		 * @return true if the piece can make at least one valid move, false otherwise.
-		 * 
-		 * The function iterates through the chess board to determine if the specified piece
-		 * can make a valid move to an empty square or capture an opponent's piece without
-		 * putting the player's King in check.
-		 */
-		bool pieceCanMove(int, int);
-
-
-		/**
-		 * Simulates a proposed chess move on a test board.
-		 *
-		 * @param sourceRow The row index of the source square.
-		 * @param sourceCol The column index of the source square.
-		 * @param destRow The row index of the destination square.
-		 * @param destCol The column index of the destination square.
-		 * @param testBoard A 2D array representing the test chess board with Piece pointers.
-		 * 
-		 * The function creates a copy of the actual board and then simulates the proposed move
-		 * on the test board by moving the piece from the source square to the destination square.
-		 */	
-		void testMove(int sourceRow, int sourceCol, int destRow, int destCol, Piece* testBoard[8][8]);
-		
-
-		/**
-		 * Checks if the specified player's King is in check by opponent's pieces.
-		 *
-		 * @param playerColour The colour of the player ('w' for White, 'b' for Black).
-		 * @param board A 2D array representing the chess board with Piece pointers.
-		 * @return true if the player's King is in check, false otherwise.
-		 * 
-		 * The function finds the coordinates of the player's King, then iterates through the chess board
-		 * to identify opponent's pieces and checks if any of them can make a valid move towards the King.
-		 */
-		bool inCheck(char playerColour, Piece* board[8][8]);
-		
-
-		/**
-		 * Finds the position of the King of a specified colour on a chess board.
-		 *
-		 * @param board A 2D array representing the chess board with Piece pointers.
-		 * @param colour The colour of the King to find ('w' for White, 'b' for Black).
-		 * @param kingRow Reference to store the row index of the King.
-		 * @param kingCol Reference to store the column index of the King.
-		 * 
-		 * The function iterates through the chess board to find the position of the King of the specified colour.
-		 * The result is stored in the provided references `kingRow` and `kingCol`.
-		 */
-		void findKing(Piece* board[8][8], char, int&, int&);
-
-};
-
-#endif
-
+#ifndef CHESSBOARD_H
+#define CHESSBOARD_H
+
+#include "ChessPieces.h"
+#include "ChessMove.h"
+#include "Bitboard.h"
+#include "AttackMaps.h"
+#include "Zobrist.h"
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/*
+ * Compact copy of a board state. Each square is stored in 4 bits
+ * (0 = empty, 1-12 = "KQBRNPkqbrnp") so the 64 squares fit in 32 bytes.
+ */
+struct PackedPosition {
+	uint8_t squares[32];
+	char activeColour;
+};
+
+/* Which moves ChessBoard::generateMoves produces */
+enum GenType { GEN_CAPTURES, GEN_QUIETS, GEN_ALL };
+
+/* State of the game for a player about to move */
+enum GameStatus { STATUS_ONGOING, STATUS_CHECK, STATUS_CHECKMATE, STATUS_STALEMATE };
+
+/* Information needed to take back a move made with ChessBoard::doMove */
+struct MoveUndo {
+	Piece* captured;
+};
+
+// ChessBoard class declaration
+
+class ChessBoard {
+
+	public:
+
+		/**
+		 * Default ChessBoard class constructor: an empty board with White to move.
+		 *
+		 * A ChessBoard owns no memory (its squares point at the shared pieces from
+		 * pieceFromName), so constructing one allocates nothing and a board can be
+		 * copied with plain assignment or memcpy, e.g. to give each thread its own.
+		 */
+		ChessBoard();
+
+		/**
+		 * Loads a new chess board state from a FEN string representation.
+		 * 
+		 * @param boardState A null-terminated string representing the new board state.
+		 * The format includes piece placement data and the active colour.
+		 * Example: "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq"
+		 * A string that is not a position is reported and the board left unchanged.
+		 */
+		void loadState(const char*);
+		
+
+		/**
+		 * Submits a chess move from the source square to the destination square.
+		 *
+		 * @param sourceSquare A string representing the source square of the move (e.g., "A2").
+		 * @param destSquare A string representing the destination square of the move (e.g., "A4").
+		 * 
+		 * The function validates the move, checks for legality, and updates the chess board accordingly.
+		 * Displays appropriate messages for invalid moves, checks, checkmates, and stalemates.
+		 * Switches the active player's turn at the end of a valid move.
+		 */
+		void submitMove(const char*, const char*);
+
+
+		/**
+		 * Returns active colour
+		 *
+		 * @return active colour as a character
+		 */
+		char getActiveColour() const;
+
+		/**
+		 * Returns active colour as a string
+		 *
+		 * @return active colour as string
+		 */
+		string outputActiveColour() const;
+
+
+		/**
+		 * Function to print the board into a 2D array of characters for debugging 
+		 * and tracking moves.
+		*/
+		void printBoard();
+
+
+		/**
+		 * Stores the current board state in a compact PackedPosition.
+		 *
+		 * @param packed The PackedPosition to write the board state into.
+		 */
+		void packState(PackedPosition& packed) const;
+
+
+		/**
+		 * Restores a board state previously stored with packState.
+		 *
+		 * @param packed The PackedPosition to read the board state from.
+		 *
+		 * Nothing is printed and the checkmate / stalemate flags are cleared.
+		 */
+		void unpackState(const PackedPosition& packed);
+
+
+		/**
+		 * Checks if an encoded move is legal for the active player without printing anything.
+		 *
+		 * @param move The encoded move (see ChessMove.h).
+		 * @return true if the active player may make the move, false otherwise.
+		 */
+		bool isLegalMove(Move move);
+
+
+		/**
+		 * Makes an encoded move and switches the active player without printing anything.
+		 *
+		 * @param move The encoded move (see ChessMove.h).
+		 *
+		 * The move is not validated; callers replaying a known game can skip the legality check.
+		 */
+		void applyMove(Move move);
+
+
+		/**
+		 * Loads a new chess board state from a FEN string without printing anything.
+		 *
+		 * @param boardState A null-terminated FEN string (see loadState).
+		 * @return false if the string fails validFen; the board is then unchanged.
+		 */
+		bool setPosition(const char* boardState);
+
+
+		/**
+		 * Checks a FEN string before it is loaded, e.g. one received over the network.
+		 *
+		 * @param boardState A null-terminated FEN string (see loadState).
+		 * @return true if the piece placement fills eight ranks of eight files with piece
+		 * letters and digits and passes validPlacement, and the active colour is w or b.
+		 */
+		static bool validFen(const char* boardState);
+
+
+		/**
+		 * Checks a PackedPosition read from outside, e.g. from a file, before unpackState.
+		 *
+		 * @param packed The packed position.
+		 * @return true if every square code is 0-12, the codes pass validPlacement and
+		 * the active colour is w or b.
+		 */
+		static bool validPacked(const PackedPosition& packed);
+
+
+		/**
+		 * Checks that a piece placement could come about in a game: one King of each
+		 * colour, at most 16 pieces and 8 Pawns a side, no more pieces beyond the
+		 * starting set than Pawns missing, and no Pawn on its own first rank (one on
+		 * the last rank is possible, as there is no promotion).
+		 * Such a position never has more than MAX_MOVES moves.
+		 *
+		 * @param codes The piece on each square: 0 = empty, 1-12 = "KQBRNPkqbrnp".
+		 * @return true if the placement is possible.
+		 */
+		static bool validPlacement(const uint8_t codes[64]);
+
+
+		/**
+		 * Makes an encoded move without validating it or printing anything, so that it
+		 * can be taken back with undoMove.
+		 *
+		 * @param move The encoded move (see ChessMove.h).
+		 * @return The information undoMove needs to restore the board.
+		 */
+		MoveUndo doMove(Move move);
+
+
+		/**
+		 * Takes back a move made with doMove.
+		 *
+		 * @param move The move that was made.
+		 * @param undo The value doMove returned for it.
+		 */
+		void undoMove(Move move, const MoveUndo& undo);
+
+
+		/**
+		 * Turns the incrementally updated attack maps on or off.
+		 *
+		 * @param enable true to build the maps and keep them up to date after every move.
+		 *
+		 * With the maps on, check tests and attacked-square queries are single lookups
+		 * but every move costs an update of the maps. With them off the same queries are
+		 * answered by computing attacks on demand.
+		 */
+		void enableAttackMaps(bool enable);
+
+
+		/**
+		 * Returns true if the attack maps are turned on.
+		 */
+		bool attackMapsEnabled() const;
+
+
+		/**
+		 * Returns the squares of the pieces of one colour that attack a square.
+		 *
+		 * @param square The square index 0-63.
+		 * @param colour The colour of the attacking pieces ('w' or 'b').
+		 * @return The squares of the attacking pieces.
+		 */
+		Bitboard attackersTo(int square, char colour) const;
+
+
+		/**
+		 * Returns the squares of the pieces of both colours that attack a square,
+		 * computed for a given set of occupied squares.
+		 *
+		 * @param square The square index 0-63.
+		 * @param occupied The squares treated as occupied; sliders see through any
+		 * piece left out, which is how exchanges find attackers behind attackers.
+		 * @return The squares of the attacking pieces (the caller masks out removed pieces).
+		 */
+		Bitboard allAttackersTo(int square, Bitboard occupied) const;
+
+
+		/**
+		 * Checks if a square is attacked by any piece of a colour.
+		 *
+		 * @param square The square index 0-63.
+		 * @param byColour The colour of the attacking pieces ('w' or 'b').
+		 * @return true if the square is attacked, false otherwise.
+		 */
+		bool squareAttacked(int square, char byColour) const;
+
+
+		/**
+		 * Checks if the King of a colour is in check.
+		 *
+		 * @param colour The colour of the King ('w' or 'b').
+		 * @return true if the King is attacked by an opponent's piece, false otherwise.
+		 */
+		bool kingInCheck(char colour) const;
+
+
+		/**
+		 * Checks if the King of a colour could move to a square without being in check there.
+		 *
+		 * @param colour The colour of the King ('w' or 'b').
+		 * @param destSquare The square the King would move to.
+		 * @return true if the square would not be attacked once the King is on it, false otherwise.
+		 *
+		 * Only attacks are considered; the caller checks the King can reach the square.
+		 */
+		bool kingMoveIsSafe(char colour, int destSquare) const;
+
+
+		/**
+		 * Returns the square of the King of a colour, or -1 if there is none.
+		 */
+		int kingSquare(char colour) const;
+
+
+		/**
+		 * Returns the squares occupied by pieces of any colour.
+		 */
+		Bitboard getOccupied() const;
+
+
+		/**
+		 * Returns the squares occupied by pieces of a colour.
+		 *
+		 * @param colour 'w' for White, 'b' for Black.
+		 */
+		Bitboard getPieces(char colour) const;
+
+
+		/**
+		 * Returns the squares occupied by pieces of a colour and type.
+		 *
+		 * @param colour 'w' for White, 'b' for Black.
+		 * @param type The PieceType.
+		 */
+		Bitboard getPieces(char colour, PieceType type) const;
+
+
+		/**
+		 * Returns the Zobrist key of the position (pieces and active colour).
+		 */
+		uint64_t getKey() const;
+
+
+		/**
+		 * Returns the Zobrist key the position would have after a move, without making it.
+		 *
+		 * @param move The encoded move (see ChessMove.h).
+		 */
+		uint64_t keyAfter(Move move) const;
+
+
+		/**
+		 * Returns the Zobrist key of the pawns alone, for caching pawn structure terms.
+		 */
+		uint64_t getPawnKey() const;
+
+
+		/**
+		 * Generates every legal move of the active player.
+		 *
+		 * @param moves The list the moves are written to (any previous contents are discarded).
+		 */
+		void generateLegalMoves(MoveList& moves);
+
+
+		/**
+		 * Generates the legal captures, the legal non-captures or all legal moves of the active player.
+		 *
+		 * @param moves The list the moves are written to (any previous contents are discarded).
+		 * @param type GEN_CAPTURES, GEN_QUIETS or GEN_ALL.
+		 *
+		 * Generating captures and quiet moves separately lets a search stop before
+		 * generating quiet moves when a capture already refutes the position.
+		 */
+		void generateMoves(MoveList& moves, GenType type);
+
+
+		/**
+		 * Works out whether a player to move is in check, checkmate or stalemate.
+		 *
+		 * Looks for a single legal move rather than generating them all: in check,
+		 * only King moves and captures or blocks of a single checker are tried. The
+		 * answer is kept until a piece next moves, so asking again (or asking after
+		 * the turn passes to that player) costs nothing.
+		 *
+		 * @param colour The player, 'w' or 'b'; it need not be the active player.
+		 * @return STATUS_CHECKMATE, STATUS_STALEMATE, STATUS_CHECK or STATUS_ONGOING.
+		 */
+		GameStatus gameStatus(char colour);
+
+
+		/**
+		 * Returns the squares the piece on a square can legally move to.
+		 *
+		 * The legal moves are generated once per position and kept until the board
+		 * next changes, so repeated queries (e.g. a UI highlighting the destinations
+		 * of a selected piece) are lookups.
+		 *
+		 * @param square The square index 0-63.
+		 * @return The destination squares; empty if the square does not hold a piece
+		 * of the active player that can move.
+		 */
+		Bitboard legalMovesFrom(int square);
+
+
+		/**
+		 * Returns the squares of the active player's pieces that have at least one
+		 * legal move, from the same cache as legalMovesFrom.
+		 */
+		Bitboard legalMoveMask();
+
+
+		/**
+		 * Checks if a move follows the movement rules of the piece on its source square,
+		 * ignoring whether it leaves the King in check.
+		 *
+		 * @param move Any 16 bit value, e.g. a move remembered from another position.
+		 * @return true if the active player has a piece that can make the move.
+		 */
+		bool isPseudoLegal(Move move) const;
+
+
+		/**
+		 * Checks if a pseudo-legal move leaves the mover's King safe.
+		 *
+		 * @param move A move for which isPseudoLegal is true.
+		 * @return true if the move is legal.
+		 */
+		bool isLegal(Move move);
+
+
+		/**
+		 * Returns the pieces of a colour that are pinned to their King.
+		 *
+		 * @param colour The colour of the King ('w' or 'b').
+		 * @return The squares of that colour's pieces which stand alone between the
+		 * King and an opponent's sliding piece.
+		 */
+		Bitboard pinnedPieces(char colour) const;
+
+
+		/**
+		 * Returns the piece on a square, or nullptr if the square is empty.
+		 *
+		 * @param square The square index 0-63.
+		 */
+		Piece* pieceAt(int square) const;
+
+
+	private:
+
+		/* 2D character array representing the chess board */
+		Piece* board[8][8]; 
+
+		/* Stores character denoting whether active colour is black or white */
+		char activeColour;
+
+		/* Squares occupied by each colour (indexed by colourIndex) and each PieceType */
+		Bitboard colourPieces[2];
+		Bitboard typePieces[6];
+
+		/* Attack maps, only kept up to date while useAttackMaps is set */
+		AttackMaps attackMaps;
+		bool useAttackMaps = false;
+
+		/* Zobrist key of the position, updated with every change to the board */
+		uint64_t key;
+
+		/* Zobrist key of the pawns only (no active colour), updated with key */
+		uint64_t pawnKey;
+
+		/* Legal destinations by source square and the sources that have any, valid until the board changes */
+		Bitboard legalTargets[64];
+		Bitboard legalSources;
+		bool legalCacheValid = false;
+
+		/* gameStatus of each colour (indexed by colourIndex), valid until a piece moves */
+		GameStatus statusCache[2];
+		bool statusKnown[2] = { false, false };
+
+		// Game state variables
+		bool inCheckmate = false;
+		bool inStalemate = false;
+
+		// Helper functions
+
+		/**
+		 * Parses the piece placement and active colour of a FEN string, the checks
+		 * validFen describes.
+		 *
+		 * @param boardState A null-terminated FEN string.
+		 * @param squares Filled in with the pieces, null pointers for empty spaces.
+		 * @param colour Set to the active colour.
+		 * @return false if the string is not valid (squares is then incomplete).
+		 */
+		static bool parseFen(const char* boardState, Piece* squares[8][8], char& colour);
+
+
+		/**
+		 * Converts a string representation of piece data to a 2D array of 
+		 * Piece pointers.
+		 * 
+		 * @param pieceData The piece placement data.
+		 * @param length Number of characters of pieceData to read.
+		 * @param squares Filled in with the pieces, null pointers for empty spaces.
+		 * @return false if the data does not fill an 8x8 board exactly (squares is then incomplete).
+		*/
+		static bool convertToBoardOfPointers(const char* pieceData, int length, Piece* squares[8][8]);
+
+
+		/**
+		 * Rebuilds the bitboards (and the attack maps if they are on) from the board array.
+		 *
+		 * Called after the board array has been filled in directly.
+		 */
+		void syncBitboards();
+
+
+		/**
+		 * Places a piece on a square (or empties it) keeping the bitboards up to date.
+		 *
+		 * @param square The square index 0-63.
+		 * @param piece The piece to place there, or nullptr to empty the square.
+		 *
+		 * The attack maps are not updated; the caller does that once all squares have changed.
+		 */
+		void setSquare(int square, Piece* piece);
+
+
+		/**
+		 * Generates the legal moves into legalTargets and legalSources if they are out of date.
+		 */
+		void fillLegalCache();
+
+
+		/**
+		 * Checks if a player has at least one legal move, stopping at the first one found.
+		 *
+		 * @param colour The player, who need not be the active player.
+		 * @param checkers The opponent's pieces giving check to the player's King.
+		 */
+		bool hasLegalMove(char colour, Bitboard checkers);
+
+
+		/**
+		 * Moves the piece on one square to another, capturing anything there, and
+		 * updates the bitboards and attack maps.
+		 *
+		 * @param source The source square index.
+		 * @param dest The destination square index.
+		 */
+		void movePiece(int source, int dest);
+
+
+		/**
+		 * Returns the squares the piece on a square can move to by its movement rules,
+		 * including captures but ignoring King safety.
+		 *
+		 * @param source The square of the piece.
+		 * @param piece The piece on the square.
+		 */
+		Bitboard pseudoTargets(int source, Piece* piece) const;
+
+
+		/**
+		 * Checks a pseudo-legal move leaves the King safe, given facts about the position
+		 * that a caller checking many moves only works out once.
+		 *
+		 * @param move The pseudo-legal move.
+		 * @param king The mover's King square.
+		 * @param check true if the mover's King is in check.
+		 * @param pinned The mover's pinned pieces.
+		 * @return true if the move is legal.
+		 */
+		bool moveKeepsKingSafe(Move move, int king, bool check, Bitboard pinned);
+
+
+		/**
+		 * Adds the legal pawn moves of colour index Us, found for all pawns at once
+		 * by shifting the pawn bitboard, with no branches on the colour.
+		 *
+		 * @param moves The list the moves are added to.
+		 * @param wanted The destinations to generate (see generateMoves).
+		 * @param king, check, pinned As for moveKeepsKingSafe.
+		 */
+		template <int Us>
+		void generatePawnMoves(MoveList& moves, Bitboard wanted, int king, bool check, Bitboard pinned);
+
+
+		/**
+		 * Checks if the input length of the source and destination squares is valid.
+		 *
+		 * @param sourceSquare A string representing the source square of the move (e.g., "A2").
+		 * @param destSquare A string representing the destination square of the move (e.g., "A4").
+		 * @return true if the input lengths are valid (both strings are of length 2), false otherwise.
+		 * 
+		 * The function verifies that both source and destination squares have a valid input length of 2 characters.
+		 */
+		bool inputLengthIsValid(const char*, const char*);
+
+
+		/**
+		 * Checks if the specified source and destination squares exist on the chess board.
+		 *
+		 * @param sourceCol The column character of the source square (e.g., 'A').
+		 * @param sourceRow The row character of the source square (e.g., '1').
+		 * @param destCol The column character of the destination square (e.g., 'B').
+		 * @param destRow The row character of the destination square (e.g., '2').
+		 * @return true if both source and destination squares exist on the board, false otherwise.
+		 * 
+		 * The function verifies if the specified characters for source and destination squares
+		 * fall within the valid range for columns ('A' to 'H') and rows ('1' to '8').
+		 */
+		bool onBoard(char sourceCol, char sourceRow, char destCol, char destRow); 
+	
+
+		/**
+		 * Switches the active player's turn.
+		 *
+		 * @param colour The current active player's colour ('w' for White, 'b' for Black).
+		 * 
+		 * The function updates the active player's colour to switch turns between White and Black.
+		 */
+		void switchPlayer(char);
+		
+
+		// Move processing functions 
+
+		/**
+		 * Checks if a chess move is valid according to chess logic and does not put the player's King in check.
+		 *
+		 * @param sourceRowNo The row index of the source square.
+		 * @param sourceColNo The column index of the source square.
+		 * @param destRowNo The row index of the destination square.
+		 * @param destColNo The column index of the destination square.
+		 * @param capture A boolean indicating whether the move involves capturing an opponent's piece.
+		 * @return true if the move is valid according to chess logic and does not lead to the player's King being in check, false otherwise.
+		 * 
+		 * The function first checks if the move is valid according to the piece's specific move logic.
+		 * Then, it creates a copy of the board to simulate the move and checks if the move will put the player's King in check.
+		 */
+		bool moveIsValidAndNotInCheck(int sourceRowNo, int sourceColNo, int destRowNo, int destColNo, bool capture);
+		
+
+		/**
+		 * Moves a chess piece from the source square to the destination square and handles capturing.
+		 *
+		 * @param sourceSquare A string representing the source square of the move (e.g., "A2").
+		 * @param destSquare A string representing the destination square of the move (e.g., "A4").
+		 * 
+		 * The function updates the chess board by moving the piece from the source square to the destination square.
+		 * If there is a piece at the destination square, it is captured, and the board is updated accordingly.
+		 * Outputs the move details to the console.
+		 */
+		void makeMove(const char*, const char*);		
+		
+
+		/**
+		 * Simulates a proposed chess move on a test board.
+		 *
+		 * @param sourceRow The row index of the source square.
+		 * @param sourceCol The column index of the source square.
+		 * @param destRow The row index of the destination square.
+		 * @param destCol The column index of the destination square.
+		 * @param testBoard A 2D array representing the test chess board with Piece pointers.
+		 * 
+		 * The function creates a copy of the actual board and then simulates the proposed move
+		 * on the test board by moving the piece from the source square to the destination square.
+		 */	
+		void testMove(int sourceRow, int sourceCol, int destRow, int destCol, Piece* testBoard[8][8]);
+		
+
+		/**
+		 * Checks if the specified player's King is in check by opponent's pieces.
+		 *
+		 * @param playerColour The colour of the player ('w' for White, 'b' for Black).
+		 * @param board A 2D array representing the chess board with Piece pointers.
+		 * @return true if the player's King is in check, false otherwise.
+		 * 
+		 * The function finds the coordinates of the player's King, then iterates through the chess board
+		 * to identify opponent's pieces and checks if any of them can make a valid move towards the King.
+		 */
+		bool inCheck(char playerColour, Piece* board[8][8]);
+		
+
+		/**
+		 * Finds the position of the King of a specified colour on a chess board.
+		 *
+		 * @param board A 2D array representing the chess board with Piece pointers.
+		 * @param colour The colour of the King to find ('w' for White, 'b' for Black).
+		 * @param kingRow Reference to store the row index of the King.
+		 * @param kingCol Reference to store the column index of the King.
+		 * 
+		 * The function iterates through the chess board to find the position of the King of the specified colour.
+		 * The result is stored in the provided references `kingRow` and `kingCol`.
+		 */
+		void findKing(Piece* board[8][8], char, int&, int&);
+
+};
+
+/* Boards are copied between threads and records by value */
+static_assert(is_trivially_copyable<ChessBoard>::value, "ChessBoard must stay trivially copyable");
+
+#endif
+
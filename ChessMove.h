@@ -0,0 +1,147 @@
+#ifndef CHESSMOVE_H
+#define CHESSMOVE_H
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+using namespace std;
+
+/*
+ * Squares are numbered 0-63 in the same order as the rows and columns of the
+ * ChessBoard array: square = row * 8 + col, where row 0 is rank 8 and col 0 is
+ * file A. So A8 = 0, H8 = 7, A1 = 56 and H1 = 63.
+ */
+
+/*
+ * A move packed into 16 bits:
+ *  - bits 0-5   source square
+ *  - bits 6-11  destination square
+ *  - bits 12-15 flags (reserved, always 0 for the moves this engine allows)
+ */
+typedef uint16_t Move;
+
+/* A8 to A8 can never be a real move, so 0 is used for "no move" */
+const Move NO_MOVE = 0;
+
+
+/*
+ * Most moves a position ChessBoard accepts can have. It has at most 9 Queens,
+ * 2 Rooks, 2 Bishops and 2 Knights besides the King, and no piece reaches more
+ * squares than on an empty board: 9 * 27 + 2 * 14 + 2 * 13 + 2 * 8 + 8 = 321.
+ */
+const int MAX_MOVES = 321;
+
+/* A fixed size list of moves; moves past MAX_MOVES are dropped rather than written out of bounds */
+struct MoveList {
+	Move moves[MAX_MOVES];
+	int size = 0;
+
+	void add(Move move) {
+		assert(size < MAX_MOVES);
+		if (size < MAX_MOVES) {
+			moves[size++] = move;
+		}
+	}
+};
+
+
+/**
+ * Builds a square index from a row and column index.
+ *
+ * @param row The row index (0 = rank 8).
+ * @param col The column index (0 = file A).
+ * @return The square index 0-63.
+ */
+inline int squareIndex(int row, int col) {
+	return row * 8 + col;
+}
+
+/**
+ * Returns the row index of a square (0 = rank 8).
+ */
+inline int squareRow(int square) {
+	return square >> 3;
+}
+
+/**
+ * Returns the column index of a square (0 = file A).
+ */
+inline int squareCol(int square) {
+	return square & 7;
+}
+
+/**
+ * Packs a source and destination square into a 16 bit move.
+ *
+ * @param source The source square index.
+ * @param dest The destination square index.
+ * @param flags Optional 4 bit flags.
+ * @return The encoded move.
+ */
+inline Move encodeMove(int source, int dest, int flags = 0) {
+	return (Move)(source | (dest << 6) | (flags << 12));
+}
+
+/**
+ * Returns the source square of an encoded move.
+ */
+inline int moveSource(Move move) {
+	return move & 63;
+}
+
+/**
+ * Returns the destination square of an encoded move.
+ */
+inline int moveDest(Move move) {
+	return (move >> 6) & 63;
+}
+
+/**
+ * Returns the flag bits of an encoded move.
+ */
+inline int moveFlags(Move move) {
+	return move >> 12;
+}
+
+/**
+ * Converts a square index into its name.
+ *
+ * @param square The square index 0-63.
+ * @return The square name as a string (e.g., "E2").
+ */
+inline string squareName(int square) {
+	string name;
+	name += (char)('A' + squareCol(square));
+	name += (char)('8' - squareRow(square));
+	return name;
+}
+
+/**
+ * Converts a square name into its index.
+ *
+ * @param name A null-terminated string such as "E2" (lower case files are accepted).
+ * @return The square index 0-63, or -1 if the name is not a square on the board.
+ */
+inline int parseSquare(const char* name) {
+	if (!name[0] || !name[1]) {
+		return -1;
+	}
+	char col = name[0];
+	if (col >= 'a' && col <= 'h') {
+		col = col - 'a' + 'A';
+	}
+	char row = name[1];
+	if (col < 'A' || col > 'H' || row < '1' || row > '8') {
+		return -1;
+	}
+	return squareIndex('8' - row, col - 'A');
+}
+
+/**
+ * Converts an encoded move into source and destination square names (e.g., "E2E4").
+ */
+inline string moveName(Move move) {
+	return squareName(moveSource(move)) + squareName(moveDest(move));
+}
+
+#endif
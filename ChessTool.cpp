@@ -0,0 +1,1289 @@
+#include"AnalysisServer.h"
+#include"ChessBoard.h"
+#include"Dedup.h"
+#include"Epd.h"
+#include"Evaluation.h"
+#include"GameIndex.h"
+#include"Json.h"
+#include"Match.h"
+#include"MateSolver.h"
+#include"Notation.h"
+#include"Perft.h"
+#include"Pgn.h"
+#include"Search.h"
+#include"ThreadPool.h"
+#include"Trace.h"
+#include"TrainingData.h"
+#include"Tuner.h"
+
+#include<algorithm>
+#include<chrono>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<fstream>
+#include<iostream>
+#include<mutex>
+#include<sstream>
+#include<string>
+
+using namespace std;
+
+static const char* startPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq";
+
+// Prints how to use the tool
+static void usage() {
+	cout << "usage: chesstool [--trace FILE] <command> [options]\n\n";
+	cout << "  --trace FILE  record board, search and thread activity and write it as Chrome trace_event JSON\n";
+	cout << "                (chrome://tracing, ui.perfetto.dev); each thread keeps its last " << TRACE_BUFFER_EVENTS << " events\n\n";
+	cout << "commands:\n";
+	cout << "  perft <depth> [--threads N] [--hash MB] [--split D] [--divide] [--verify] [--scaling] [--fen FEN]\n";
+	cout << "      count leaf nodes of the legal move tree on a work-stealing thread pool\n";
+	cout << "  mate (--epd FILE | --fen FEN) [--moves N] [--threads N] [--hash MB] [--nodes N]\n";
+	cout << "      solve mate-in-N puzzles with proof-number search; EPD 'dm' opcodes give N per position\n";
+	cout << "  analyse --epd FILE [--depth N] [--nodes N] [--movetime MS] [--threads N] [--hash MB] [--multipv N] [--progress]\n";
+	cout << "      search every position and write one JSON object per line; 'bm'/'am' opcodes are scored;\n";
+	cout << "      --multipv adds the N best lines, --progress writes a partial result after each depth\n";
+	cout << "  match [--openings FILE] [--games N] [--threads N] [--tc BASE+INC | --movetime MS] [--engine-a SPEC]\n";
+	cout << "        [--engine-b SPEC] [--pgn FILE] [--sprt ELO0,ELO1] [--alpha A] [--beta B] [--maxplies N]\n";
+	cout << "      play engine A against engine B, each opening with both colours; SPEC is key=value pairs\n";
+	cout << "      (name, hash, qsearch, ordering, depth, nodes); BASE and INC are in seconds\n";
+	cout << "  export (--pgn FILE | --epd FILE) --out PATH [--shard N] [--shuffle] [--seed N] [--buffer N] [--depth N] [--hash MB]\n";
+	cout << "      write every position with its game result and score as 32 byte training records; the score\n";
+	cout << "      is the static evaluation, or a search of depth N; EPD results come from 'c9' or 'result'\n";
+	cout << "  index --pgn FILE --out FILE [--threads N] [--memory MB] [--maxply N]\n";
+	cout << "      build a position index of a PGN file with an external merge sort in MB of memory\n";
+	cout << "  dedup --data PATH [--data PATH ...] --out FILE [--threads N] [--memory MB] [--fold]\n";
+	cout << "      merge training records into one tally per distinct position (count, results, score sum) with an\n";
+	cout << "      external sort in MB of memory; --fold counts Black-to-move positions as their White-to-move mirror\n";
+	cout << "  serve --socket PATH [--threads N] [--hash MB] [--queue N] [--depth N]\n";
+	cout << "      analysis service on a Unix socket: one JSON request per line, e.g. {\"id\":\"1\",\"fen\":\"...\",\"depth\":8},\n";
+	cout << "      with \"movetime\", \"nodes\", \"multipv\", \"priority\" and \"deadline\" (ms); {\"cmd\":\"stats\"} and\n";
+	cout << "      {\"cmd\":\"shutdown\"}; requests for a position already being searched share its result\n";
+	cout << "  tune --data PATH [--data PATH ...] --out FILE [--threads N] [--epochs N] [--rate CP] [--k K] [--limit N] [--no-qsearch]\n";
+	cout << "      Texel-tune the evaluation weights against the game results of training records (export), with\n";
+	cout << "      Adam steps of about CP centipawns, and write them as C++ constants; K is fitted unless given\n";
+	cout << "  lookup --index FILE (--fen FEN | --moves \"e4 e5 ...\") [--pgn FILE] [--limit N]\n";
+	cout << "      list the games that reached a position; with --pgn the players and result are shown\n";
+}
+
+// Returns the value following an option, or exits if there is none
+static const char* optionValue(int argc, char** argv, int& i) {
+	if (i + 1 >= argc) {
+		cerr << "Missing value for " << argv[i] << endl;
+		exit(1);
+	}
+	return argv[++i];
+}
+
+// perft command: parallel perft with optional divide, serial check and thread scaling table
+static int perftCommand(int argc, char** argv) {
+
+	if (argc < 1) {
+		usage();
+		return 1;
+	}
+
+	int depth = atoi(argv[0]);
+	int threads = ThreadPool::hardwareThreads();
+	int hashMegabytes = 64;
+	int splitDepth = 4;
+	bool divide = false;
+	bool verify = false;
+	bool scaling = false;
+	string fen = startPosition;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--threads")) {
+			threads = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--hash")) {
+			hashMegabytes = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--split")) {
+			splitDepth = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--divide")) {
+			divide = true;
+		}
+		else if (!strcmp(argv[i], "--verify")) {
+			verify = true;
+		}
+		else if (!strcmp(argv[i], "--scaling")) {
+			scaling = true;
+		}
+		else if (!strcmp(argv[i], "--fen")) {
+			fen = optionValue(argc, argv, i);
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	ChessBoard cb;
+	if (!cb.setPosition(fen.c_str())) {
+		cerr << "Invalid FEN " << fen << endl;
+		return 1;
+	}
+
+	unique_ptr<PerftCache> cache;
+	if (hashMegabytes > 0) {
+		cache.reset(new PerftCache(hashMegabytes));
+	}
+
+	// Thread counts to run: 1, 2, 4, ... up to the requested count, or just the requested count
+	vector<int> threadCounts;
+	if (scaling) {
+		for (int count = 1; count < threads; count *= 2) {
+			threadCounts.push_back(count);
+		}
+	}
+	threadCounts.push_back(threads);
+
+	printf("%8s %14s %10s %14s %8s %10s\n", "threads", "nodes", "seconds", "nps", "speedup", "efficiency");
+
+	PerftResult result;
+	double baseSeconds = 0;
+
+	for (int count : threadCounts) {
+		if (cache) {
+			cache->clear();
+		}
+		result = parallelPerft(cb, depth, count, cache.get(), splitDepth);
+
+		// Speedup and efficiency are relative to the single thread run
+		if (count == 1) {
+			baseSeconds = result.seconds;
+		}
+
+		printf("%8d %14llu %10.3f %14.0f", count, (unsigned long long)result.nodes,
+			result.seconds, result.nodes / (result.seconds > 0 ? result.seconds : 1e-9));
+
+		if (baseSeconds > 0) {
+			double speedup = baseSeconds / result.seconds;
+			printf(" %8.2f %9.0f%%\n", speedup, 100.0 * speedup / count);
+		}
+		else {
+			printf(" %8s %10s\n", "-", "-");
+		}
+	}
+
+	if (cache) {
+		printf("cache hits %llu / %llu probes\n", (unsigned long long)cache->getHits(), (unsigned long long)cache->getProbes());
+	}
+
+	if (divide) {
+		cout << '\n';
+		for (auto& entry : result.divide) {
+			cout << moveName(entry.first) << ": " << entry.second << '\n';
+		}
+	}
+
+	if (verify) {
+		auto start = chrono::steady_clock::now();
+		uint64_t serialNodes = perft(cb, depth);
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		cout << "\nsingle-threaded perft without cache: " << serialNodes << " (" << seconds << "s) - ";
+		if (serialNodes != result.nodes) {
+			cout << "MISMATCH" << endl;
+			return 1;
+		}
+		cout << "match" << endl;
+	}
+
+	return 0;
+}
+
+// Writes the moves of a line as square names
+static string lineText(const vector<Move>& line) {
+	string text;
+	for (size_t i = 0; i < line.size(); i++) {
+		text += (i > 0 ? " " : "") + moveName(line[i]);
+	}
+	return text;
+}
+
+// mate command: solve one position or a whole EPD file, one puzzle per task
+static int mateCommand(int argc, char** argv) {
+
+	string epdPath;
+	string fen;
+	int defaultMoves = 3;
+	int threads = ThreadPool::hardwareThreads();
+	int hashMegabytes = 16;
+	uint64_t nodeLimit = 0;
+
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--epd")) {
+			epdPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--fen")) {
+			fen = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--moves")) {
+			defaultMoves = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--threads")) {
+			threads = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--hash")) {
+			hashMegabytes = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--nodes")) {
+			nodeLimit = strtoull(optionValue(argc, argv, i), nullptr, 10);
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	vector<EpdRecord> puzzles;
+	if (!epdPath.empty()) {
+		if (!readEpdFile(epdPath, puzzles)) {
+			cerr << "Cannot open " << epdPath << endl;
+			return 1;
+		}
+	}
+	else if (!fen.empty()) {
+		EpdRecord record;
+		record.fen = fen;
+		record.lineNo = 0;
+		record.operations["id"] = fen;
+		puzzles.push_back(record);
+	}
+	else {
+		usage();
+		return 1;
+	}
+
+	auto start = chrono::steady_clock::now();
+
+	ThreadPool pool(threads);
+
+	// One solver (and so one transposition table) per worker, reused for all its puzzles
+	vector<unique_ptr<MateSolver>> solvers;
+	for (int i = 0; i < pool.size(); i++) {
+		solvers.push_back(unique_ptr<MateSolver>(new MateSolver(hashMegabytes)));
+	}
+
+	mutex outputLock;
+	atomic<int> solved(0);
+	atomic<int> unique(0);
+	atomic<int> failed(0);
+	atomic<uint64_t> totalNodes(0);
+
+	for (size_t p = 0; p < puzzles.size(); p++) {
+		pool.submit([&, p] {
+			const EpdRecord& puzzle = puzzles[p];
+			int moves = atoi(puzzle.operation("dm", to_string(defaultMoves)).c_str());
+
+			string id = puzzle.operation("id", "line " + to_string(puzzle.lineNo));
+
+			ChessBoard cb;
+			if (!cb.setPosition(puzzle.fen.c_str())) {
+				failed++;
+				lock_guard<mutex> guard(outputLock);
+				cout << id << ": invalid position FAIL" << endl;
+				return;
+			}
+			MateResult result = solvers[ThreadPool::workerIndex()]->solve(cb, moves, nodeLimit);
+
+			// A puzzle with a dm opcode passes only if the mate is exactly that long
+			bool pass = result.found && (!puzzle.hasOperation("dm") || result.mateIn == moves);
+			solved += result.found;
+			unique += result.unique;
+			failed += !pass;
+			totalNodes += result.nodes;
+
+			lock_guard<mutex> guard(outputLock);
+			cout << id << ": ";
+			if (result.found) {
+				cout << "mate in " << result.mateIn << (result.unique ? " (unique)" : " (" + to_string(result.solutions) + " solutions)")
+					<< " " << lineText(result.line);
+			}
+			else {
+				cout << (result.aborted ? "unknown (node limit)" : "no mate in " + to_string(moves));
+			}
+			cout << (pass ? "" : " FAIL") << " [" << result.nodes << " nodes, " << result.seconds << "s]" << endl;
+		});
+	}
+
+	pool.wait();
+
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << "\n" << puzzles.size() << " positions, " << solved << " mates found, " << unique << " unique, "
+		<< failed << " failed; " << totalNodes << " nodes in " << seconds << "s ("
+		<< puzzles.size() / (seconds > 0 ? seconds : 1e-9) << " positions/s, " << pool.size() << " threads)" << endl;
+
+	return (failed > 0 ? 2 : 0);
+}
+
+// Reads the moves of a bm or am operand, skipping any that are not legal here
+static vector<Move> operandMoves(const ChessBoard& cb, const string& operand) {
+	vector<Move> moves;
+	istringstream stream(operand);
+	string text;
+	while (stream >> text) {
+		Move move = parseMove(cb, text);
+		if (move != NO_MOVE) {
+			moves.push_back(move);
+		}
+	}
+	return moves;
+}
+
+// analyse command: search each EPD position on a thread pool and stream the results as JSON lines
+static int analyseCommand(int argc, char** argv) {
+
+	string epdPath;
+	int depth = 0;
+	uint64_t nodeLimit = 0;
+	double moveTime = 0;
+	int threads = ThreadPool::hardwareThreads();
+	int hashMegabytes = 16;
+	int multiPV = 1;
+	bool progress = false;
+
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--epd")) {
+			epdPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--multipv")) {
+			multiPV = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--progress")) {
+			progress = true;
+		}
+		else if (!strcmp(argv[i], "--depth")) {
+			depth = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--nodes")) {
+			nodeLimit = strtoull(optionValue(argc, argv, i), nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--movetime")) {
+			moveTime = atof(optionValue(argc, argv, i)) / 1000;
+		}
+		else if (!strcmp(argv[i], "--threads")) {
+			threads = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--hash")) {
+			hashMegabytes = atoi(optionValue(argc, argv, i));
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if (epdPath.empty()) {
+		usage();
+		return 1;
+	}
+
+	vector<EpdRecord> positions;
+	if (!readEpdFile(epdPath, positions)) {
+		cerr << "Cannot open " << epdPath << endl;
+		return 1;
+	}
+
+	// With no limit at all, search to a fixed depth
+	if (depth == 0 && nodeLimit == 0 && moveTime == 0) {
+		depth = 6;
+	}
+
+	auto start = chrono::steady_clock::now();
+
+	ThreadPool pool(threads);
+
+	// One searcher per worker; it is cleared before each position so results do not depend on scheduling
+	vector<unique_ptr<Searcher>> searchers;
+	for (int i = 0; i < pool.size(); i++) {
+		searchers.push_back(unique_ptr<Searcher>(new Searcher(hashMegabytes)));
+	}
+
+	mutex outputLock;
+	atomic<int> scored(0);
+	atomic<int> solved(0);
+	atomic<uint64_t> totalNodes(0);
+	atomic<uint64_t> evalProbes(0), evalHits(0), pawnProbes(0), pawnHits(0);
+
+	for (size_t p = 0; p < positions.size(); p++) {
+		pool.submit([&, p] {
+			const EpdRecord& position = positions[p];
+
+			string id = jsonString(position.operation("id", "line " + to_string(position.lineNo)));
+
+			ChessBoard cb;
+			if (!cb.setPosition(position.fen.c_str())) {
+				lock_guard<mutex> guard(outputLock);
+				cout << "{\"id\":" << id << ",\"fen\":" << jsonString(position.fen) << ",\"error\":\"invalid position\"}" << endl;
+				return;
+			}
+
+			Searcher& searcher = *searchers[ThreadPool::workerIndex()];
+			searcher.clear();
+
+			SearchLimits limits;
+			if (depth > 0) {
+				limits.depth = depth;
+			}
+			limits.nodes = nodeLimit;
+
+			TimeControl tc;
+			tc.moveTime = moveTime;
+			TimeManager timer(tc);
+			if (moveTime > 0) {
+				limits.time = &timer;
+			}
+
+			limits.multiPV = multiPV;
+
+			// Each completed iteration as a partial result, marked so readers can skip it
+			if (progress) {
+				limits.onIteration = [&](const SearchResult& partial) {
+					ostringstream json;
+					json << "{\"id\":" << id << ",\"partial\":true,\"depth\":" << partial.depth
+						<< ",\"lines\":" << linesJson(cb, partial.lines) << ",\"nodes\":" << partial.stats.nodes
+						<< ",\"seconds\":" << partial.seconds << "}";
+					lock_guard<mutex> guard(outputLock);
+					cout << json.str() << endl;
+				};
+			}
+
+			SearchResult result = searcher.search(cb, limits);
+			totalNodes += result.stats.nodes;
+			evalProbes += result.stats.evalProbes;
+			evalHits += result.stats.evalHits;
+			pawnProbes += result.stats.pawnProbes;
+			pawnHits += result.stats.pawnHits;
+
+			// Build the whole line first so lines from different workers never interleave
+			ostringstream json;
+			json << "{\"id\":" << id << ",\"fen\":" << jsonString(position.fen) << "," << resultJson(cb, result);
+			json << ",\"nodes\":" << result.stats.nodes << ",\"seconds\":" << result.seconds;
+
+			// Best-move and avoid-move tests: the move found must be one of bm and none of am
+			if (position.hasOperation("bm") || position.hasOperation("am")) {
+				bool pass = true;
+				if (position.hasOperation("bm")) {
+					vector<Move> best = operandMoves(cb, position.operation("bm"));
+					pass = find(best.begin(), best.end(), result.bestMove) != best.end();
+				}
+				if (position.hasOperation("am")) {
+					vector<Move> avoid = operandMoves(cb, position.operation("am"));
+					pass = pass && find(avoid.begin(), avoid.end(), result.bestMove) == avoid.end();
+				}
+				scored++;
+				solved += pass;
+				json << ",\"solved\":" << (pass ? "true" : "false");
+			}
+			json << "}";
+
+			lock_guard<mutex> guard(outputLock);
+			cout << json.str() << endl;
+		});
+	}
+
+	pool.wait();
+
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	if (seconds <= 0) {
+		seconds = 1e-9;
+	}
+
+	// The summary goes to stderr so stdout stays one JSON object per line
+	cerr << positions.size() << " positions, " << totalNodes << " nodes in " << seconds << "s ("
+		<< positions.size() / seconds << " positions/s, " << (uint64_t)(totalNodes / seconds) << " nodes/s, "
+		<< pool.size() << " threads)" << endl;
+	cerr << "evaluation cache hits " << 100.0 * evalHits / max(evalProbes.load(), (uint64_t)1) << "%, pawn cache hits "
+		<< 100.0 * pawnHits / max(pawnProbes.load(), (uint64_t)1) << "%" << endl;
+	if (scored > 0) {
+		cerr << "bm/am solved " << solved << " / " << scored << " (" << 100.0 * solved / scored << "%)" << endl;
+	}
+
+	return 0;
+}
+
+// match command: self-play games between two engine settings on a thread pool, with Elo and SPRT
+static int matchCommand(int argc, char** argv) {
+
+	string openingsPath;
+	int games = 100;
+	int threads = ThreadPool::hardwareThreads();
+	int maxPlies = 400;
+	string pgnPath;
+	bool sprt = false;
+	double elo0 = 0;
+	double elo1 = 5;
+	double alpha = 0.05;
+	double beta = 0.05;
+
+	TimeControl tc;
+	tc.timeLeft = 10;
+	tc.increment = 0.1;
+
+	EngineConfig configs[2];
+	configs[0].name = "A";
+	configs[1].name = "B";
+
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--openings")) {
+			openingsPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--games")) {
+			games = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--threads")) {
+			threads = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--tc")) {
+			const char* value = optionValue(argc, argv, i);
+			tc.timeLeft = atof(value);
+			const char* plus = strchr(value, '+');
+			tc.increment = (plus ? atof(plus + 1) : 0);
+			tc.moveTime = 0;
+		}
+		else if (!strcmp(argv[i], "--movetime")) {
+			tc.moveTime = atof(optionValue(argc, argv, i)) / 1000;
+		}
+		else if (!strcmp(argv[i], "--engine-a") || !strcmp(argv[i], "--engine-b")) {
+			int engine = (argv[i][9] == 'a' ? 0 : 1);
+			const char* spec = optionValue(argc, argv, i);
+			if (!parseEngineConfig(spec, configs[engine])) {
+				cerr << "Cannot read engine settings " << spec << endl;
+				return 1;
+			}
+		}
+		else if (!strcmp(argv[i], "--pgn")) {
+			pgnPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--sprt")) {
+			const char* value = optionValue(argc, argv, i);
+			elo0 = atof(value);
+			const char* comma = strchr(value, ',');
+			elo1 = (comma ? atof(comma + 1) : elo0 + 5);
+			sprt = true;
+		}
+		else if (!strcmp(argv[i], "--alpha")) {
+			alpha = atof(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--beta")) {
+			beta = atof(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--maxplies")) {
+			maxPlies = atoi(optionValue(argc, argv, i));
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	vector<EpdRecord> openings;
+	if (!openingsPath.empty() && !readEpdFile(openingsPath, openings)) {
+		cerr << "Cannot open " << openingsPath << endl;
+		return 1;
+	}
+
+	// Games are only started from positions the board accepts
+	vector<EpdRecord> valid;
+	for (const EpdRecord& opening : openings) {
+		ChessBoard cb;
+		if (cb.setPosition(opening.fen.c_str())) {
+			valid.push_back(opening);
+		}
+		else {
+			cerr << openingsPath << " line " << opening.lineNo << ": invalid position skipped" << endl;
+		}
+	}
+	openings.swap(valid);
+	if (openings.empty() && !openingsPath.empty()) {
+		cerr << "No valid openings in " << openingsPath << endl;
+		return 1;
+	}
+	if (openings.empty()) {
+		EpdRecord start;
+		start.fen = startPosition;
+		start.lineNo = 0;
+		openings.push_back(start);
+	}
+
+	ofstream pgn;
+	if (!pgnPath.empty()) {
+		pgn.open(pgnPath);
+		if (!pgn) {
+			cerr << "Cannot write " << pgnPath << endl;
+			return 1;
+		}
+	}
+
+	double lower, upper;
+	sprtBounds(alpha, beta, lower, upper);
+
+	auto start = chrono::steady_clock::now();
+
+	ThreadPool pool(threads);
+
+	// Each worker plays one game at a time and keeps a searcher for each engine
+	vector<unique_ptr<Searcher>> searchers;
+	for (int i = 0; i < pool.size(); i++) {
+		searchers.push_back(unique_ptr<Searcher>(new Searcher(configs[0].hashMegabytes)));
+		searchers.push_back(unique_ptr<Searcher>(new Searcher(configs[1].hashMegabytes)));
+	}
+
+	mutex resultLock;
+	MatchStats stats;
+	atomic<bool> decided(false);
+	int finished = 0;
+
+	for (int g = 0; g < games; g++) {
+		pool.submit([&, g] {
+			if (decided) {
+				return;
+			}
+
+			// Each opening is played twice with the colours swapped
+			const EpdRecord& opening = openings[(g / 2) % openings.size()];
+			int white = g % 2;
+			int worker = ThreadPool::workerIndex();
+
+			Searcher* engines[2] = { searchers[worker * 2 + white].get(), searchers[worker * 2 + 1 - white].get() };
+			const EngineConfig* sides[2] = { &configs[white], &configs[1 - white] };
+
+			PlayedGame game = playGame(opening.fen, engines, sides, tc, maxPlies);
+
+			lock_guard<mutex> guard(resultLock);
+			if (decided) {
+				return;
+			}
+
+			// Results are counted from engine A's side
+			if (game.outcome == DRAW) {
+				stats.draws++;
+			}
+			else if ((game.outcome == WHITE_WINS) == (white == 0)) {
+				stats.wins++;
+			}
+			else {
+				stats.losses++;
+			}
+			finished++;
+
+			if (pgn) {
+				pgn << gamePgn(game, sides[0]->name, sides[1]->name, g + 1) << flush;
+			}
+
+			const char* results[3] = { "1-0", "0-1", "1/2-1/2" };
+			printf("game %4d %s-%s %-7s %-21s | +%d =%d -%d  %5.1f%%  elo %+7.1f +/- %5.1f",
+				g + 1, sides[0]->name.c_str(), sides[1]->name.c_str(), results[game.outcome], game.termination.c_str(),
+				stats.wins, stats.draws, stats.losses, 100 * stats.score(), stats.elo(), stats.eloError());
+
+			if (sprt) {
+				double llr = stats.llr(elo0, elo1);
+				printf("  LLR %+.2f [%.2f, %.2f]", llr, lower, upper);
+				if (llr >= upper || llr <= lower) {
+					printf("  %s accepted", llr >= upper ? "H1" : "H0");
+					decided = true;
+				}
+			}
+			printf("\n");
+			fflush(stdout);
+		});
+	}
+
+	pool.wait();
+
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	printf("\n%s vs %s: %d games in %.1fs (%d threads)  +%d =%d -%d  score %.1f%%  elo %+.1f +/- %.1f\n",
+		configs[0].name.c_str(), configs[1].name.c_str(), finished, seconds, pool.size(),
+		stats.wins, stats.draws, stats.losses, 100 * stats.score(), stats.elo(), stats.eloError());
+
+	if (sprt) {
+		double llr = stats.llr(elo0, elo1);
+		printf("SPRT elo0 %.1f elo1 %.1f alpha %.3f beta %.3f: LLR %.2f [%.2f, %.2f] - %s\n", elo0, elo1, alpha, beta,
+			llr, lower, upper, llr >= upper ? "H1 accepted" : (llr <= lower ? "H0 accepted" : "inconclusive"));
+	}
+
+	return 0;
+}
+
+// Result token from White's side: 1, 0 or -1; anything else is unknown
+static bool resultValue(const string& token, int& result) {
+	if (token == "1-0") {
+		result = 1;
+	}
+	else if (token == "0-1") {
+		result = -1;
+	}
+	else if (token == "1/2-1/2") {
+		result = 0;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+// export command: streams labelled positions from PGN or EPD into packed training records
+static int exportCommand(int argc, char** argv) {
+
+	string pgnPath;
+	string epdPath;
+	string outPath;
+	uint64_t shardRecords = 0;
+	size_t bufferRecords = 1 << 20;
+	bool shuffle = false;
+	uint64_t seed = 1;
+	int depth = 0;
+	int hashMegabytes = 16;
+
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--pgn")) {
+			pgnPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--epd")) {
+			epdPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--out")) {
+			outPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--shard")) {
+			shardRecords = strtoull(optionValue(argc, argv, i), nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--buffer")) {
+			bufferRecords = strtoull(optionValue(argc, argv, i), nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--shuffle")) {
+			shuffle = true;
+		}
+		else if (!strcmp(argv[i], "--seed")) {
+			seed = strtoull(optionValue(argc, argv, i), nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--depth")) {
+			depth = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--hash")) {
+			hashMegabytes = atoi(optionValue(argc, argv, i));
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if (outPath.empty() || pgnPath.empty() == epdPath.empty()) {
+		usage();
+		return 1;
+	}
+
+	auto start = chrono::steady_clock::now();
+
+	TrainingWriter writer(outPath, shardRecords, bufferRecords, shuffle, seed);
+	Searcher searcher(depth > 0 ? hashMegabytes : 1);
+	uint64_t games = 0;
+	uint64_t skipped = 0;
+
+	// Games whose FEN tag, or EPD records whose position, is not a position
+	uint64_t invalid = 0;
+
+	// Games or records with more pieces than a TrainingRecord holds; no move adds one, so a game fails at its start
+	uint64_t crowded = 0;
+
+	// Score from White's side: the static evaluation, or a fixed depth search
+	auto whiteScore = [&](ChessBoard& cb) {
+		int score;
+		if (depth > 0) {
+			SearchLimits limits;
+			limits.depth = depth;
+			score = searcher.search(cb, limits).score;
+		}
+		else {
+			score = evaluate(cb);
+		}
+		return (cb.getActiveColour() == 'w' ? score : -score);
+	};
+
+	TrainingRecord record;
+
+	if (!pgnPath.empty()) {
+		ifstream file(pgnPath);
+		if (!file) {
+			cerr << "Cannot open " << pgnPath << endl;
+			return 1;
+		}
+
+		PgnReader reader(file);
+		PgnGame game;
+		while (reader.next(game)) {
+			int result;
+			if (!resultValue(game.result, result) && !resultValue(game.tag("Result"), result)) {
+				skipped++;
+				continue;
+			}
+			games++;
+
+			ChessBoard cb;
+			if (!cb.setPosition(game.tag("FEN", startPosition).c_str())) {
+				cerr << "Line " << reader.getLineNo() << ": invalid FEN tag, game skipped" << endl;
+				invalid++;
+				continue;
+			}
+
+			// Every position before a move is labelled; the final position has no move to learn from
+			for (size_t ply = 0; ply < game.moves.size(); ply++) {
+				Move move = parseMove(cb, game.moves[ply]);
+				if (move == NO_MOVE) {
+					cerr << "Line " << reader.getLineNo() << ": illegal move " << game.moves[ply] << ", rest of game skipped" << endl;
+					break;
+				}
+				if (!packTrainingRecord(cb, whiteScore(cb), result, (int)ply, record)) {
+					cerr << "Line " << reader.getLineNo() << ": more than 32 pieces, game skipped" << endl;
+					crowded++;
+					break;
+				}
+				if (!writer.add(record)) {
+					return 1;
+				}
+				cb.doMove(move);
+			}
+		}
+	}
+	else {
+		vector<EpdRecord> positions;
+		if (!readEpdFile(epdPath, positions)) {
+			cerr << "Cannot open " << epdPath << endl;
+			return 1;
+		}
+
+		for (const EpdRecord& position : positions) {
+			// Results missing from the record count as draws
+			int result = 0;
+			if (!resultValue(position.operation("c9", position.operation("result")), result)) {
+				result = 0;
+			}
+
+			ChessBoard cb;
+			if (!cb.setPosition(position.fen.c_str())) {
+				cerr << "Line " << position.lineNo << ": invalid position skipped" << endl;
+				invalid++;
+				continue;
+			}
+			if (!packTrainingRecord(cb, whiteScore(cb), result, 0, record)) {
+				cerr << "Line " << position.lineNo << ": more than 32 pieces, position skipped" << endl;
+				crowded++;
+				continue;
+			}
+			if (!writer.add(record)) {
+				return 1;
+			}
+		}
+	}
+
+	if (!writer.close()) {
+		return 1;
+	}
+
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	if (seconds <= 0) {
+		seconds = 1e-9;
+	}
+
+	cout << writer.getRecords() << " positions";
+	if (!pgnPath.empty()) {
+		cout << " from " << games << " games (" << skipped << " without a result skipped)";
+	}
+	cout << " written to " << writer.getFiles() << " file" << (writer.getFiles() == 1 ? "" : "s") << " in "
+		<< seconds << "s (" << (uint64_t)(writer.getRecords() / seconds) << " positions/s)" << endl;
+	if (invalid > 0) {
+		cout << invalid << (pgnPath.empty() ? " records" : " games") << " with an invalid position skipped" << endl;
+	}
+	if (crowded > 0) {
+		cout << crowded << (pgnPath.empty() ? " records" : " games") << " with more than 32 pieces skipped" << endl;
+	}
+
+	return 0;
+}
+
+// tune command: Texel tuning of the evaluation weights over training records
+static int tuneCommand(int argc, char** argv) {
+
+	vector<string> dataPaths;
+	string outPath;
+	TuneOptions options;
+
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--data")) {
+			dataPaths.push_back(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--out")) {
+			outPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--threads")) {
+			options.threads = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--epochs")) {
+			options.epochs = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--rate")) {
+			options.learningRate = atof(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--k")) {
+			options.scalingK = atof(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--limit")) {
+			options.limit = strtoull(optionValue(argc, argv, i), nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--no-qsearch")) {
+			options.quiescence = false;
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if (dataPaths.empty() || outPath.empty()) {
+		usage();
+		return 1;
+	}
+
+	Tuner tuner(options);
+
+	auto start = chrono::steady_clock::now();
+	for (const string& path : dataPaths) {
+		if (!tuner.load(path)) {
+			return 1;
+		}
+	}
+	double loadSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << tuner.getPositions() << " positions loaded in " << loadSeconds << "s"
+		<< (options.quiescence ? " (quiescence resolved)" : "") << endl;
+	if (tuner.getInvalidRecords() > 0) {
+		cout << tuner.getInvalidRecords() << " invalid records skipped" << endl;
+	}
+	if (tuner.getPositions() == 0) {
+		return 1;
+	}
+
+	start = chrono::steady_clock::now();
+	double k = tuner.fitScaling();
+	cout << "K = " << k << ", error " << tuner.error() << " ("
+		<< chrono::duration<double>(chrono::steady_clock::now() - start).count() << "s)" << endl;
+
+	start = chrono::steady_clock::now();
+	for (int e = 1; e <= options.epochs; e++) {
+		double meanError = tuner.epoch();
+		if (e % 10 == 0 || e == options.epochs) {
+			double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			printf("epoch %5d  error %.6f  %.3fs/epoch\n", e, meanError, seconds / e);
+		}
+	}
+	cout << "final error " << tuner.error() << endl;
+
+	if (!tuner.writeParameters(outPath)) {
+		return 1;
+	}
+	cout << "Wrote " << outPath << endl;
+	return 0;
+}
+
+// index command: builds a position index of a PGN file
+static int indexCommand(int argc, char** argv) {
+
+	string pgnPath;
+	string outPath;
+	IndexOptions options;
+
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--pgn")) {
+			pgnPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--out")) {
+			outPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--threads")) {
+			options.threads = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--memory")) {
+			options.memoryMegabytes = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--maxply")) {
+			options.maxPly = atoi(optionValue(argc, argv, i));
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if (pgnPath.empty() || outPath.empty()) {
+		usage();
+		return 1;
+	}
+
+	IndexBuildStats stats;
+	if (!buildGameIndex(pgnPath, outPath, options, stats)) {
+		return 1;
+	}
+
+	double seconds = (stats.seconds > 0 ? stats.seconds : 1e-9);
+	cout << stats.entries << " positions from " << stats.games << " games indexed in " << seconds << "s ("
+		<< (uint64_t)(stats.games / seconds) << " games/s, " << stats.runs << " sorted run" << (stats.runs == 1 ? "" : "s") << ")" << endl;
+	if (stats.badGames > 0) {
+		cout << stats.badGames << " games with an illegal move were indexed up to that move" << endl;
+	}
+	return 0;
+}
+
+// dedup command: merges training records into one tally per distinct position
+static int dedupCommand(int argc, char** argv) {
+
+	vector<string> dataPaths;
+	string outPath;
+	DedupOptions options;
+
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--data")) {
+			dataPaths.push_back(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--out")) {
+			outPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--threads")) {
+			options.threads = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--memory")) {
+			options.memoryMegabytes = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--fold")) {
+			options.foldColours = true;
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if (dataPaths.empty() || outPath.empty()) {
+		usage();
+		return 1;
+	}
+
+	DedupStats stats;
+	if (!deduplicate(dataPaths, outPath, options, stats)) {
+		return 1;
+	}
+
+	double seconds = (stats.seconds > 0 ? stats.seconds : 1e-9);
+	double duplicates = (stats.records > 0 ? 100.0 * (stats.records - stats.positions) / stats.records : 0);
+	cout << stats.records << " records, " << stats.positions << " distinct positions (" << duplicates << "% duplicates) in "
+		<< seconds << "s (" << (uint64_t)(stats.records / seconds) << " records/s, " << stats.runs << " sorted run"
+		<< (stats.runs == 1 ? "" : "s") << ", " << stats.passes << " extra merge pass" << (stats.passes == 1 ? "" : "es") << ")" << endl;
+	if (stats.invalid > 0) {
+		cout << stats.invalid << " invalid records skipped" << endl;
+	}
+	return 0;
+}
+
+// lookup command: lists the games of an index that reached a position
+static int lookupCommand(int argc, char** argv) {
+
+	string indexPath;
+	string pgnPath;
+	string fen = startPosition;
+	string moves;
+	size_t limit = 20;
+
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--index")) {
+			indexPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--pgn")) {
+			pgnPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--fen")) {
+			fen = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--moves")) {
+			moves = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--limit")) {
+			limit = strtoull(optionValue(argc, argv, i), nullptr, 10);
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if (indexPath.empty()) {
+		usage();
+		return 1;
+	}
+
+	ChessBoard cb;
+	if (!cb.setPosition(fen.c_str())) {
+		cerr << "Invalid FEN " << fen << endl;
+		return 1;
+	}
+	istringstream line(moves);
+	string text;
+	while (line >> text) {
+		Move move = parseMove(cb, text);
+		if (move == NO_MOVE) {
+			cerr << "Illegal move " << text << endl;
+			return 1;
+		}
+		cb.doMove(move);
+	}
+
+	GameIndex index;
+	if (!index.open(indexPath)) {
+		return 1;
+	}
+
+	vector<IndexEntry> found;
+	auto start = chrono::steady_clock::now();
+	int probes = index.lookup(cb.getKey(), found);
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << found.size() << " of " << index.getGames() << " games reached the position (" << probes << " probes, "
+		<< seconds * 1e6 << " us)" << endl;
+
+	ifstream pgn;
+	if (!pgnPath.empty()) {
+		pgn.open(pgnPath);
+		if (!pgn) {
+			cerr << "Cannot open " << pgnPath << endl;
+			return 1;
+		}
+	}
+
+	for (size_t i = 0; i < found.size() && i < limit; i++) {
+		cout << "game " << found[i].game + 1 << " ply " << found[i].ply;
+		if (pgn.is_open()) {
+			pgn.clear();
+			pgn.seekg(index.gameOffset(found[i].game));
+			PgnReader reader(pgn);
+			PgnGame game;
+			if (reader.next(game)) {
+				cout << "  " << game.tag("White", "?") << " - " << game.tag("Black", "?") << "  " << game.result;
+			}
+		}
+		cout << endl;
+	}
+	if (found.size() > limit) {
+		cout << "... " << found.size() - limit << " more" << endl;
+	}
+	return 0;
+}
+
+// serve command: runs the analysis service until it is shut down
+static int serveCommand(int argc, char** argv) {
+
+	ServerOptions options;
+
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "--socket")) {
+			options.socketPath = optionValue(argc, argv, i);
+		}
+		else if (!strcmp(argv[i], "--threads")) {
+			options.threads = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--hash")) {
+			options.hashMegabytes = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--queue")) {
+			options.maxQueue = atoi(optionValue(argc, argv, i));
+		}
+		else if (!strcmp(argv[i], "--depth")) {
+			options.defaultDepth = atoi(optionValue(argc, argv, i));
+		}
+		else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if (options.socketPath.empty()) {
+		usage();
+		return 1;
+	}
+
+	AnalysisServer server(options);
+	return (server.run() ? 0 : 1);
+}
+
+// Runs one command
+static int runCommand(int argc, char** argv) {
+
+	if (argc < 1) {
+		usage();
+		return 1;
+	}
+
+	string command = argv[0];
+
+	if (command == "perft") {
+		return perftCommand(argc - 1, argv + 1);
+	}
+	if (command == "mate") {
+		return mateCommand(argc - 1, argv + 1);
+	}
+	if (command == "analyse") {
+		return analyseCommand(argc - 1, argv + 1);
+	}
+	if (command == "match") {
+		return matchCommand(argc - 1, argv + 1);
+	}
+	if (command == "export") {
+		return exportCommand(argc - 1, argv + 1);
+	}
+	if (command == "index") {
+		return indexCommand(argc - 1, argv + 1);
+	}
+	if (command == "dedup") {
+		return dedupCommand(argc - 1, argv + 1);
+	}
+	if (command == "lookup") {
+		return lookupCommand(argc - 1, argv + 1);
+	}
+	if (command == "tune") {
+		return tuneCommand(argc - 1, argv + 1);
+	}
+	if (command == "serve") {
+		return serveCommand(argc - 1, argv + 1);
+	}
+
+	usage();
+	return 1;
+}
+
+int main(int argc, char** argv) {
+
+	string tracePath;
+	int first = 1;
+	if (argc > 2 && !strcmp(argv[1], "--trace")) {
+		tracePath = argv[2];
+		first = 3;
+		enableTracing(true);
+		setTraceThreadName("main");
+	}
+
+	int status = runCommand(argc - first, argv + first);
+
+	if (!tracePath.empty()) {
+		enableTracing(false);
+		size_t events;
+		if (!writeTrace(tracePath, events)) {
+			return 1;
+		}
+		cerr << "Wrote " << events << " trace events to " << tracePath << endl;
+	}
+	return status;
+}
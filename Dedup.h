@@ -0,0 +1,109 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * One distinct position with the labels of every record of it: 64 bytes,
+ * written as is (little-endian). The position is stored as in TrainingRecord.
+ * Tallies are sorted by hash, then by position, so the tallies of one position
+ * are next to each other and two of them add up to one.
+ */
+struct PositionTally {
+
+	/* Hash of the position, the sort key */
+	uint64_t hash;
+
+	uint64_t occupied;
+	uint8_t pieces[16];
+
+	/* 0 = White to move, 1 = Black to move */
+	uint8_t sideToMove;
+
+	uint8_t reserved[3];
+
+	/* Records of the position */
+	uint32_t count;
+
+	/* Game results from White's side */
+	uint32_t wins;
+	uint32_t draws;
+	uint32_t losses;
+
+	/* Fewest plies from the start of a game the position was reached at */
+	uint16_t minPly;
+
+	uint16_t reserved2;
+
+	/* Sum of the records' scores, from White's side */
+	int64_t scoreSum;
+};
+
+static_assert(sizeof(PositionTally) == 64, "PositionTally must stay 64 bytes");
+
+
+/*
+ * Deduplicated file layout, all little-endian:
+ *   header      DEDUP_MAGIC, tally count, record count, 8 reserved bytes
+ *   tallies     tally count PositionTallies in hash order
+ */
+const char DEDUP_MAGIC[8] = { 'C', 'H', 'E', 'S', 'S', 'D', 'U', 'P' };
+
+
+/* How a deduplication runs */
+struct DedupOptions {
+	/* Worker threads hashing, sorting and merging (0 = one per hardware thread) */
+	int threads = 0;
+
+	/* Memory for records in flight, sorted runs and merge buffers; nothing else grows with the input */
+	size_t memoryMegabytes = 256;
+
+	/*
+	 * Canonicalise to White to move: a position with Black to move is flipped top
+	 * to bottom with the colours swapped, and its result and score negated. The
+	 * rules here have no castling or en passant, so the two are the same position.
+	 */
+	bool foldColours = false;
+};
+
+/* Counts reported by deduplicate */
+struct DedupStats {
+	uint64_t records = 0;
+	uint64_t positions = 0;
+
+	/* Records skipped because they do not hold a valid position */
+	uint64_t invalid = 0;
+
+	/* Sorted runs written to disk, and merge passes made over them before the final merge */
+	int runs = 0;
+	int passes = 0;
+
+	double seconds = 0;
+};
+
+
+/**
+ * Deduplicates training records into one PositionTally per distinct position.
+ *
+ * The records are read a batch at a time. The workers canonicalise and hash
+ * each batch in parallel into a buffer of tallies. When the buffer is full,
+ * each worker sorts a slice of it, adds up the tallies of each position, and
+ * writes the slice out as a run. Runs are merged in extra passes while there
+ * are more than the memory allows buffers for. The final merge splits the hash
+ * range into one part per worker, so the workers merge in parallel and the
+ * parts are joined in order. The memory used stays within
+ * DedupOptions::memoryMegabytes however many records there are.
+ *
+ * @param inputPaths Training record files, or paths shards were written under.
+ * @param outPath The file to write; runs and parts are written next to it.
+ * @param options Threads, memory and canonicalisation.
+ * @param stats Filled in with counts and the time taken.
+ * @return false if a file could not be read or written (the reason is printed).
+ */
+bool deduplicate(const vector<string>& inputPaths, const string& outPath, const DedupOptions& options, DedupStats& stats);
+
+#endif
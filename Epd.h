@@ -0,0 +1,59 @@
+#ifndef EPD_H
+#define EPD_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * One line of an EPD (Extended Position Description) file: the first four
+ * FEN fields followed by opcodes with operands, separated by semicolons, e.g.
+ *   2k5/8/1K6/8/8/8/8/7R w - - dm 1; id "mate.001";
+ */
+struct EpdRecord {
+
+	/* Position in the form ChessBoard::setPosition accepts */
+	string fen;
+
+	/* Operands of each opcode, without surrounding quotes */
+	map<string, string> operations;
+
+	/* Line number in the file the record came from */
+	int lineNo;
+
+
+	/**
+	 * Returns the operand of an opcode, or a default if the opcode is missing.
+	 */
+	string operation(const string& opcode, const string& missing = "") const;
+
+
+	/**
+	 * Returns true if the record has the opcode.
+	 */
+	bool hasOperation(const string& opcode) const;
+};
+
+
+/**
+ * Parses one EPD line.
+ *
+ * @param line The text of the line.
+ * @param record Filled in from the line.
+ * @return true if the line holds a position, false for blank, comment or malformed lines.
+ */
+bool parseEpdLine(const string& line, EpdRecord& record);
+
+
+/**
+ * Reads every position in an EPD file.
+ *
+ * @param path Path of the file.
+ * @param records The positions read, in file order.
+ * @return true if the file could be opened, false otherwise.
+ */
+bool readEpdFile(const string& path, vector<EpdRecord>& records);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include "ChessBoard.h"
+#include "ScoreCache.h"
+
+/* Material value of each PieceType in centipawns (the King is never captured) */
+const int pieceValues[6] = { 0, 900, 330, 500, 320, 100 };
+
+
+/* Pawn structure penalties and bonuses in centipawns */
+const int DOUBLED_PAWN = -12;
+const int ISOLATED_PAWN = -15;
+const int BACKWARD_PAWN = -10;
+
+/* Passed pawn bonus by rank counted from the pawn's own side (1 = starting rank) */
+const int passedPawn[8] = { 0, 5, 10, 20, 35, 60, 100, 0 };
+
+/* Piece-square bonuses for White by PieceType and square; Black reads them with the row flipped (square ^ 56) */
+extern const int pieceSquare[6][64];
+
+
+/* White's count of each pawn structure term minus Black's */
+struct PawnTermCounts {
+	int doubled = 0;
+	int isolated = 0;
+	int backward = 0;
+
+	/* Passed pawns by rank counted from the pawn's own side */
+	int passed[8] = {};
+};
+
+
+/**
+ * Counts the pawn structure terms of a position, e.g. for tuning their weights.
+ *
+ * @param cb The board.
+ * @param counts Set to White's counts minus Black's.
+ */
+void countPawnTerms(const ChessBoard& cb, PawnTermCounts& counts);
+
+
+/**
+ * Scores the pawn structure: doubled, isolated, backward and passed pawns, each
+ * count from countPawnTerms times its weight. It depends on the pawns alone, so
+ * it can be cached by ChessBoard::getPawnKey.
+ *
+ * @param cb The board to evaluate.
+ * @return The score in centipawns from White's side.
+ */
+int pawnStructure(const ChessBoard& cb);
+
+
+/**
+ * Evaluates a position statically: material, piece-square bonuses and pawn structure.
+ *
+ * @param cb The board to evaluate.
+ * @param pawnCache Cache of pawnStructure scores by pawn key, or nullptr to always compute them.
+ * @return The score in centipawns from the point of view of the active player.
+ */
+int evaluate(const ChessBoard& cb, ScoreCache* pawnCache = nullptr);
+
+#endif
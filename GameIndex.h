@@ -0,0 +1,157 @@
+#ifndef GAMEINDEX_H
+#define GAMEINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* One position reached in one game: 16 bytes, sorted by key, then game, then ply */
+struct IndexEntry {
+
+	/* Zobrist key of the position */
+	uint64_t key;
+
+	/* Number of the game in the PGN file, from 0 */
+	uint32_t game;
+
+	/* Plies played when the position was first reached in the game */
+	uint16_t ply;
+
+	uint16_t reserved;
+};
+
+static_assert(sizeof(IndexEntry) == 16, "IndexEntry must stay 16 bytes");
+
+
+/*
+ * Index file layout, all little-endian:
+ *   header      GAMEINDEX_MAGIC, entry count, game count, 8 reserved bytes
+ *   entries     entry count IndexEntries in key order
+ *   offsets     game count uint64_t byte offsets of the games in the PGN file
+ */
+const char GAMEINDEX_MAGIC[8] = { 'C', 'H', 'E', 'S', 'S', 'I', 'D', 'X' };
+
+
+/* How an index is built */
+struct IndexOptions {
+	/* Worker threads replaying games (0 = one per hardware thread) */
+	int threads = 0;
+
+	/* Memory for sorted runs, shared by the workers; a full run is written to a temporary file */
+	size_t memoryMegabytes = 256;
+
+	/* Positions after this many plies of a game are not indexed (0 = no limit) */
+	int maxPly = 0;
+};
+
+/* Counts reported by buildGameIndex */
+struct IndexBuildStats {
+	uint64_t games = 0;
+	uint64_t entries = 0;
+
+	/* Games with an illegal or unreadable move, whose positions up to that move are kept, or an invalid FEN tag */
+	uint64_t badGames = 0;
+
+	/* Sorted runs written to disk before the merge */
+	int runs = 0;
+
+	double seconds = 0;
+};
+
+
+/**
+ * Builds a position index of a PGN file.
+ *
+ * The file is read once. Games are handed in batches to a thread pool whose
+ * workers replay them and collect (key, game, ply) entries in a buffer each;
+ * a full buffer is sorted and written out as a run, so memory use stays within
+ * IndexOptions::memoryMegabytes however large the file is. The runs are then
+ * merged into the index file and removed.
+ *
+ * @param pgnPath The games.
+ * @param indexPath The index file to write; runs are written next to it.
+ * @param options Threads, memory and ply limit.
+ * @param stats Filled in with counts and the time taken.
+ * @return false if a file could not be read or written (the reason is printed).
+ */
+bool buildGameIndex(const string& pgnPath, const string& indexPath, const IndexOptions& options, IndexBuildStats& stats);
+
+
+// GameIndex class declaration
+
+/**
+ * Read access to an index file written by buildGameIndex.
+ *
+ * The file is memory-mapped, so opening costs no reading and the pages a
+ * lookup touches are loaded on demand. Zobrist keys are spread evenly over
+ * their range, so lookups use interpolation search, which needs a handful of
+ * probes on average, finishing with a binary search over the last few entries.
+ */
+class GameIndex {
+
+	public:
+
+		GameIndex();
+
+
+		/**
+		 * GameIndex destructor that unmaps the file.
+		 */
+		~GameIndex();
+
+		GameIndex(const GameIndex&) = delete;
+		GameIndex& operator=(const GameIndex&) = delete;
+
+
+		/**
+		 * Maps an index file.
+		 *
+		 * @param path The file.
+		 * @return false if it cannot be opened or is not an index file (the reason is printed).
+		 */
+		bool open(const string& path);
+
+
+		/**
+		 * Unmaps the file.
+		 */
+		void close();
+
+
+		/**
+		 * Finds every game that reached a position.
+		 *
+		 * @param key Zobrist key of the position.
+		 * @param found Set to the matching entries, by game number.
+		 * @return The number of probes made into the entries.
+		 */
+		int lookup(uint64_t key, vector<IndexEntry>& found) const;
+
+
+		/**
+		 * Returns the byte offset of a game in the PGN file the index was built from.
+		 */
+		uint64_t gameOffset(uint32_t game) const;
+
+
+		/**
+		 * Returns the number of entries and games in the index.
+		 */
+		uint64_t getEntries() const;
+		uint64_t getGames() const;
+
+
+	private:
+
+		void* mapping;
+		size_t mappingSize;
+
+		const IndexEntry* entries;
+		const uint64_t* offsets;
+		uint64_t entryCount;
+		uint64_t gameCount;
+};
+
+#endif
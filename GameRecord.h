@@ -0,0 +1,155 @@
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include "ChessBoard.h"
+#include "ChessMove.h"
+#include <cstdint>
+#include <vector>
+
+// GameRecord class declaration
+
+/**
+ * Stores the history of a game as 16 bit moves together with a packed copy of
+ * the board every few plies (a checkpoint).
+ *
+ * Moving to any ply restores the nearest checkpoint at or before it and replays
+ * the remaining moves, so a seek never needs more than checkpointInterval - 1
+ * moves to be made. Undo and redo are seeks by one ply.
+ */
+class GameRecord {
+
+	public:
+
+		/**
+		 * GameRecord constructor.
+		 *
+		 * @param startBoard The board the game starts from (its current state is copied).
+		 * @param checkpointInterval Number of plies between stored checkpoints.
+		 */
+		GameRecord(const ChessBoard& startBoard, int checkpointInterval = 16);
+
+
+		/**
+		 * Plays a move at the current ply and records it.
+		 *
+		 * @param move The encoded move (see ChessMove.h).
+		 * @return true if the move was legal and recorded, false otherwise.
+		 *
+		 * If the current ply is not the end of the game (after an undo or seek)
+		 * the moves after it are discarded, so the new move starts a new line.
+		 */
+		bool append(Move move);
+
+
+		/**
+		 * Plays a move given as source and destination squares and records it.
+		 *
+		 * @param sourceSquare A string representing the source square of the move (e.g., "E2").
+		 * @param destSquare A string representing the destination square of the move (e.g., "E4").
+		 * @return true if the move was legal and recorded, false otherwise.
+		 */
+		bool append(const char* sourceSquare, const char* destSquare);
+
+
+		/**
+		 * Steps back one ply.
+		 *
+		 * @return true if there was a move to undo, false otherwise.
+		 */
+		bool undo();
+
+
+		/**
+		 * Steps forward one ply along the recorded moves.
+		 *
+		 * @return true if there was a move to redo, false otherwise.
+		 */
+		bool redo();
+
+
+		/**
+		 * Moves the board to the position after the given number of plies.
+		 *
+		 * @param targetPly The ply to move to (0 is the start position).
+		 * @return true if the ply exists in the record, false otherwise.
+		 */
+		bool seek(int targetPly);
+
+
+		/**
+		 * Returns the ply the board is currently at.
+		 */
+		int currentPly() const;
+
+
+		/**
+		 * Returns the number of recorded plies.
+		 */
+		int length() const;
+
+
+		/**
+		 * Returns the move played at the given ply (the move leading to ply + 1).
+		 *
+		 * @param moveNo The ply index, 0 to length() - 1.
+		 * @return The encoded move, or NO_MOVE if the ply is out of range.
+		 */
+		Move moveAt(int moveNo) const;
+
+
+		/**
+		 * Returns the board at the current ply.
+		 */
+		const ChessBoard& getBoard() const;
+
+
+		/**
+		 * Serialises the record into a compact binary blob.
+		 *
+		 * @return The blob: a 4 byte tag, the checkpoint interval, the move count,
+		 * the packed start position and 2 bytes per move. Checkpoints are not
+		 * stored as they are rebuilt when the blob is loaded.
+		 */
+		vector<uint8_t> serialise() const;
+
+
+		/**
+		 * Replaces the record with one read from a blob made by serialise.
+		 *
+		 * @param blob The serialised record.
+		 * @return true if the blob was valid and every move in it was legal,
+		 * false otherwise (the record is then left unchanged).
+		 */
+		bool deserialise(const vector<uint8_t>& blob);
+
+
+	private:
+
+		/* Board at currentPly */
+		ChessBoard board;
+
+		/* Position the game starts from */
+		PackedPosition start;
+
+		/* Moves of the game in order */
+		vector<Move> moves;
+
+		/* checkpoints[i] is the position after i * checkpointInterval plies */
+		vector<PackedPosition> checkpoints;
+
+		int checkpointInterval;
+		int ply;
+
+		// Helper functions
+
+		/**
+		 * Clears the record and sets a new start position.
+		 *
+		 * @param startPosition The packed start position.
+		 * @param interval Number of plies between stored checkpoints.
+		 */
+		void reset(const PackedPosition& startPosition, int interval);
+
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include "Bitboard.h"
+#include <cstdint>
+
+/*
+ * The eight directions a sliding piece moves in, as row and column steps.
+ * Rays in the first four directions run towards higher square indices.
+ * Rooks use RAY_SOUTH, RAY_EAST, RAY_NORTH and RAY_WEST; bishops the others.
+ */
+enum RayDirection { RAY_SOUTH, RAY_EAST, RAY_SOUTH_EAST, RAY_SOUTH_WEST, RAY_NORTH, RAY_WEST, RAY_NORTH_WEST, RAY_NORTH_EAST };
+
+constexpr int rayRowStep[8] = { 1, 0, 1, 1, -1, 0, -1, -1 };
+constexpr int rayColStep[8] = { 0, 1, 1, -1, 0, -1, -1, 1 };
+
+/*
+ * Square relationships looked up instead of worked out step by step. The
+ * tables are built at compile time, so nothing is initialised at startup.
+ */
+struct SquareGeometry {
+	/* Squares strictly between two squares on a shared rank, file or diagonal (empty otherwise) */
+	Bitboard between[64][64];
+
+	/* The whole rank, file or diagonal through two squares, edge to edge (empty if they share none) */
+	Bitboard line[64][64];
+
+	/* Squares a ray from a square covers on an empty board, by RayDirection */
+	Bitboard rays[8][64];
+
+	/* Squares attacked by a knight, a king, and a pawn of each colour index */
+	Bitboard knight[64];
+	Bitboard king[64];
+	Bitboard pawn[2][64];
+
+	/* King-move distance (the larger of the rank and file distances) and rank plus file distance */
+	uint8_t chebyshev[64][64];
+	uint8_t manhattan[64][64];
+};
+
+// Absolute value usable in constant expressions
+constexpr int geometryAbs(int value) {
+	return (value < 0 ? -value : value);
+}
+
+// Bit of the square at a row and column, or 0 if that is off the board
+constexpr Bitboard geometrySquare(int row, int col) {
+	return (row >= 0 && row < 8 && col >= 0 && col < 8 ? squareBit(row * 8 + col) : 0);
+}
+
+constexpr SquareGeometry makeSquareGeometry() {
+
+	SquareGeometry g = {};
+
+	const int knightRows[8] = { 2, 2, -2, -2, 1, 1, -1, -1 };
+	const int knightCols[8] = { 1, -1, 1, -1, 2, -2, 2, -2 };
+
+	for (int square = 0; square < 64; square++) {
+		int row = square / 8;
+		int col = square % 8;
+
+		for (int i = 0; i < 8; i++) {
+			g.knight[square] |= geometrySquare(row + knightRows[i], col + knightCols[i]);
+			g.king[square] |= geometrySquare(row + rayRowStep[i], col + rayColStep[i]);
+
+			for (int step = 1; step < 8; step++) {
+				g.rays[i][square] |= geometrySquare(row + rayRowStep[i] * step, col + rayColStep[i] * step);
+			}
+		}
+
+		// White pawns capture towards rank 8 (lower rows), Black pawns towards rank 1
+		g.pawn[0][square] = geometrySquare(row - 1, col - 1) | geometrySquare(row - 1, col + 1);
+		g.pawn[1][square] = geometrySquare(row + 1, col - 1) | geometrySquare(row + 1, col + 1);
+
+		for (int other = 0; other < 64; other++) {
+			int rowDistance = geometryAbs(other / 8 - row);
+			int colDistance = geometryAbs(other % 8 - col);
+			g.chebyshev[square][other] = (rowDistance > colDistance ? rowDistance : colDistance);
+			g.manhattan[square][other] = rowDistance + colDistance;
+		}
+	}
+
+	// A square lies on a ray from another exactly when they share a line in that direction
+	for (int square = 0; square < 64; square++) {
+		for (int dir = 0; dir < 8; dir++) {
+			int opposite = (dir + 4) % 8;
+			Bitboard ray = g.rays[dir][square];
+
+			for (int other = 0; other < 64; other++) {
+				if (ray & squareBit(other)) {
+					g.between[square][other] = ray & g.rays[opposite][other];
+					g.line[square][other] = ray | g.rays[opposite][square] | squareBit(square);
+				}
+			}
+		}
+	}
+
+	return g;
+}
+
+inline constexpr SquareGeometry geometry = makeSquareGeometry();
+
+#endif
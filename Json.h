@@ -0,0 +1,54 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include "ChessBoard.h"
+#include "Search.h"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Quotes a string for JSON, escaping quotes, backslashes and control characters.
+ */
+string jsonString(const string& text);
+
+
+/**
+ * Reads a flat JSON object such as {"fen":"...","depth":8,"wait":true}.
+ * Nested objects and arrays are not supported.
+ *
+ * @param text The object.
+ * @param fields Set to each member's value: strings unquoted and unescaped, other values as written.
+ * @return false if the text is not a flat JSON object.
+ */
+bool parseJsonObject(const string& text, map<string, string>& fields);
+
+
+/**
+ * Writes a search score as {"cp":N} or {"mate":N}, where a negative mate count
+ * means the active player is mated.
+ */
+string scoreJson(int score);
+
+
+/**
+ * Writes the lines of a multi-PV search as an array of {"move", "score", "depth", "pv"} objects.
+ *
+ * @param cb The position searched (moves are written in SAN).
+ * @param lines The lines.
+ */
+string linesJson(const ChessBoard& cb, const vector<PVLine>& lines);
+
+
+/**
+ * Writes the members "depth", "score", "bestmove" and "pv" of a search result,
+ * and "lines" when there is more than one, without the surrounding braces.
+ *
+ * @param cb The position searched (moves are written in SAN).
+ * @param result The result.
+ */
+string resultJson(const ChessBoard& cb, const SearchResult& result);
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef LIVEGAME_H
+#define LIVEGAME_H
+
+#include "ChessBoard.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+/* Immutable state of a game between two moves, as published to spectators */
+struct GameSnapshot {
+	/* Pieces and the side to move */
+	PackedPosition position;
+
+	/* Zobrist key of the position */
+	uint64_t key;
+
+	/* State of the game for the side to move */
+	GameStatus status;
+
+	/* Moves played since the position was loaded, and the last of them (NO_MOVE before the first) */
+	uint32_t moves;
+	Move lastMove;
+
+	/**
+	 * Returns the piece on a square as its FEN letter, or 0 if the square is empty.
+	 */
+	char pieceAt(int square) const;
+
+	/**
+	 * Returns the side to move ('w' or 'b').
+	 */
+	char getActiveColour() const;
+};
+
+
+/* A reader's announcement of the epoch it is reading in; one cache line each so readers do not share lines */
+struct alignas(64) ReaderSlot {
+	/* Epoch the reader entered, 0 while it holds no snapshot */
+	atomic<uint64_t> epoch;
+
+	/* Claimed by a SnapshotReader */
+	atomic<bool> inUse;
+
+	/* Next slot in the game's list; slots are only ever added to the list */
+	ReaderSlot* next;
+};
+
+
+// LiveGame class declaration
+
+/**
+ * A game being played on one board and watched by any number of spectator threads.
+ *
+ * The board itself is only touched by the thread making a move. After each
+ * move a new GameSnapshot is built and swapped in through an atomic pointer,
+ * so spectators read a complete, consistent position without locks and never
+ * hold up the move being made.
+ *
+ * Old snapshots are freed with epoch based reclamation: a reader announces
+ * the current epoch in its ReaderSlot before loading the pointer, and each
+ * publish retires the old snapshot under the epoch it was replaced in and
+ * moves the epoch on. A retired snapshot is freed once every reader still
+ * inside a read entered in a later epoch, as none of them can hold it.
+ */
+class LiveGame {
+
+	public:
+
+		/**
+		 * LiveGame constructor: the standard starting position with White to move.
+		 */
+		LiveGame();
+
+
+		/**
+		 * LiveGame destructor that frees every snapshot. No SnapshotReader may outlive the game.
+		 */
+		~LiveGame();
+
+		LiveGame(const LiveGame&) = delete;
+		LiveGame& operator=(const LiveGame&) = delete;
+
+
+		/**
+		 * Loads a new position without any output and publishes it.
+		 *
+		 * @param boardState A FEN string, as for ChessBoard::loadState.
+		 * @return false if it is not a position (see ChessBoard::setPosition); nothing is published.
+		 */
+		bool loadState(const char* boardState);
+
+
+		/**
+		 * Submits a move as ChessBoard::submitMove does, messages included, and
+		 * publishes the new position if the move was made.
+		 *
+		 * @param sourceSquare The source square (e.g. "A2").
+		 * @param destSquare The destination square (e.g. "A4").
+		 * @return true if the move was legal and has been made.
+		 */
+		bool submitMove(const char* sourceSquare, const char* destSquare);
+
+
+		/**
+		 * Makes an encoded move without printing anything and publishes the new position.
+		 *
+		 * @param move The encoded move (see ChessMove.h).
+		 * @return false, leaving the game unchanged, if the move is not legal.
+		 */
+		bool playMove(Move move);
+
+
+		/**
+		 * Returns the number of replaced snapshots that readers may still hold.
+		 */
+		size_t pendingSnapshots();
+
+
+	private:
+
+		friend class SnapshotReader;
+
+		/* The writer's board; moves are serialised by writeLock */
+		ChessBoard board;
+		uint32_t moves;
+		mutex writeLock;
+
+		atomic<const GameSnapshot*> current;
+		atomic<uint64_t> epoch;
+		atomic<ReaderSlot*> readers;
+
+		/* A replaced snapshot and the epoch it was replaced in, owned by the writer */
+		struct Retired {
+			const GameSnapshot* snapshot;
+			uint64_t epoch;
+		};
+		vector<Retired> retired;
+
+		// Helper functions
+
+		/**
+		 * Builds a snapshot of the board and swaps it in, then frees the retired
+		 * snapshots no reader can hold. Called with writeLock held.
+		 */
+		void publish(Move lastMove);
+
+
+		/**
+		 * Frees the retired snapshots older than the oldest epoch a reader is in.
+		 * Called with writeLock held.
+		 */
+		void reclaim();
+
+
+		/**
+		 * Claims a free reader slot, adding a new one to the list if all are taken.
+		 */
+		ReaderSlot* claimSlot();
+};
+
+
+// SnapshotReader class declaration
+
+/**
+ * A spectator's handle for reading a LiveGame. Each reading thread uses its
+ * own SnapshotReader; creating one claims a slot in the game's reader list,
+ * which is given back (not freed) when it is destroyed.
+ */
+class SnapshotReader {
+
+	public:
+
+		SnapshotReader(LiveGame& game);
+
+
+		/**
+		 * SnapshotReader destructor that ends any read and gives the slot back.
+		 */
+		~SnapshotReader();
+
+		SnapshotReader(const SnapshotReader&) = delete;
+		SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+
+		/**
+		 * Starts a read and returns the latest snapshot. Never blocks.
+		 *
+		 * @return The snapshot; it stays valid until release, the next acquire
+		 * or the reader's destruction.
+		 */
+		const GameSnapshot* acquire();
+
+
+		/**
+		 * Ends the current read, letting the writer free the snapshot if it has been replaced.
+		 */
+		void release();
+
+
+	private:
+
+		LiveGame& game;
+		ReaderSlot* slot;
+};
+
+#endif
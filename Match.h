@@ -0,0 +1,131 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include "ChessBoard.h"
+#include "Search.h"
+#include "TimeManager.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Search settings of one side of a match */
+struct EngineConfig {
+	string name;
+	size_t hashMegabytes = 16;
+	bool quiescence = true;
+	bool ordering = true;
+
+	/* Per-move limits on top of the clock (MAX_PLY - 1 and 0 = none) */
+	int depth = MAX_PLY - 1;
+	uint64_t nodes = 0;
+};
+
+
+/**
+ * Reads engine settings written as comma separated key=value pairs, e.g.
+ * "name=noqs,qsearch=off,hash=32". Keys: name, hash, qsearch, ordering, depth, nodes.
+ *
+ * @param spec The settings text.
+ * @param config Updated with the settings given; the rest are left as they are.
+ * @return true if every pair was understood, false otherwise.
+ */
+bool parseEngineConfig(const string& spec, EngineConfig& config);
+
+
+/* How a game ended */
+enum GameOutcome { WHITE_WINS, BLACK_WINS, DRAW };
+
+/* One finished game */
+struct PlayedGame {
+	/* Start position in the form ChessBoard::setPosition accepts */
+	string fen;
+	vector<Move> moves;
+	GameOutcome outcome;
+
+	/* Why the game ended, e.g. "checkmate", "repetition", "time forfeit" */
+	string termination;
+};
+
+
+/**
+ * Plays one game between two searchers.
+ *
+ * Besides checkmate and stalemate, the game is drawn by threefold repetition,
+ * the fifty-move rule, bare Kings (or King and one minor piece against King)
+ * and on reaching maxPlies. With a clock (tc.moveTime not set) each side starts
+ * with tc.timeLeft, gains tc.increment after each move, and loses if a move
+ * takes longer than the time it had left.
+ *
+ * @param fen The start position. If the board does not accept it, no move is
+ * played and the game is a draw with termination "invalid position".
+ * @param engines The searchers for White and Black; they are cleared first.
+ * @param configs The settings of White and Black.
+ * @param tc The time control.
+ * @param maxPlies Length at which the game is adjudicated a draw.
+ * @return The moves and result.
+ */
+PlayedGame playGame(const string& fen, Searcher* engines[2], const EngineConfig* configs[2], const TimeControl& tc, int maxPlies = 400);
+
+
+/**
+ * Writes a game as PGN: the tags on one line each, then the moves in SAN on a single line.
+ *
+ * @param game The game.
+ * @param white Name of White.
+ * @param black Name of Black.
+ * @param round Round number.
+ * @return The PGN text, ending with a blank line.
+ */
+string gamePgn(const PlayedGame& game, const string& white, const string& black, int round);
+
+
+/* Running result of a match from the first engine's side */
+struct MatchStats {
+	int wins = 0;
+	int draws = 0;
+	int losses = 0;
+
+	/**
+	 * Returns the number of games counted.
+	 */
+	int games() const;
+
+
+	/**
+	 * Returns the points scored per game (win 1, draw 1/2).
+	 */
+	double score() const;
+
+
+	/**
+	 * Returns the Elo difference the score corresponds to.
+	 */
+	double elo() const;
+
+
+	/**
+	 * Returns the half-width of the 95% confidence interval of elo(), from the
+	 * spread of win, draw and loss results.
+	 */
+	double eloError() const;
+
+
+	/**
+	 * Returns the log-likelihood ratio of the sequential probability ratio test
+	 * of H1: Elo difference = elo1 against H0: Elo difference = elo0, using the
+	 * normal approximation to the game results.
+	 */
+	double llr(double elo0, double elo1) const;
+};
+
+
+/**
+ * Returns the SPRT bounds for error rates alpha (accepting H1 when H0 is true)
+ * and beta (accepting H0 when H1 is true). The test accepts H1 once the LLR is
+ * at least upper and H0 once it is at most lower.
+ */
+void sprtBounds(double alpha, double beta, double& lower, double& upper);
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef MATESOLVER_H
+#define MATESOLVER_H
+
+#include "ChessBoard.h"
+#include <cstdint>
+#include <vector>
+
+/* Result of a mate search */
+struct MateResult {
+
+	/* true if the side to move can force mate within the requested number of moves */
+	bool found;
+
+	/* true if the search stopped at its node limit before it could decide */
+	bool aborted;
+
+	/* Number of moves of the shortest forced mate */
+	int mateIn;
+
+	/* Moves of the mate, attacker first, with the defender's longest resistance */
+	vector<Move> line;
+
+	/* Number of first moves which also force mate within mateIn moves */
+	int solutions;
+
+	/* true if the first move of the line is the only one mating in mateIn moves */
+	bool unique;
+
+	uint64_t nodes;
+	double seconds;
+};
+
+
+// MateSolver class declaration
+
+/**
+ * Mate solver using depth-first proof-number search (df-pn).
+ *
+ * The side to move is the attacker. At attacker nodes one mating move is enough
+ * (proof number = smallest child proof number); at defender nodes every reply
+ * must be mated (proof number = sum of child proof numbers), and the other way
+ * round for disproof numbers. The search always expands the most proving node
+ * and only backs up when the proof or disproof number of a subtree passes its
+ * threshold, so it needs no tree in memory: the numbers live in a fixed size
+ * transposition table whose entries are keyed by position and remaining plies.
+ * When a bucket is full the entry that cost the least work to find is replaced.
+ */
+class MateSolver {
+
+	public:
+
+		/**
+		 * MateSolver constructor.
+		 *
+		 * @param megabytes Size of the transposition table.
+		 */
+		MateSolver(size_t megabytes = 16);
+
+
+		/**
+		 * Searches for the shortest forced mate by the active player.
+		 *
+		 * @param cb The board to search; it is returned to the same position.
+		 * @param maxMoves Longest mate to look for, in attacker moves ("mate in N").
+		 * @param nodeLimit Stop with aborted set after this many nodes (0 = no limit).
+		 * @return The mate found, its line and whether the first move is the only solution.
+		 */
+		MateResult solve(ChessBoard& cb, int maxMoves, uint64_t nodeLimit = 0);
+
+
+		/**
+		 * Checks whether the active player can force mate within a number of plies.
+		 *
+		 * @param cb The board to search; it is returned to the same position.
+		 * @param plies Number of plies the mate must be delivered in (odd: 2N - 1 for mate in N).
+		 * @return true if a forced mate is proven, false if disproven or the node limit was hit.
+		 */
+		bool proveMate(ChessBoard& cb, int plies);
+
+
+		/**
+		 * Empties the transposition table.
+		 */
+		void clear();
+
+
+	private:
+
+		/* Proof and disproof numbers of one node */
+		struct Entry {
+			uint64_t key;
+			uint32_t proof;
+			uint32_t disproof;
+			uint32_t work;
+		};
+
+		static const int bucketSize = 4;
+
+		vector<Entry> table;
+		size_t bucketMask;
+
+		uint64_t nodes;
+		uint64_t nodeLimit;
+
+		// Helper functions
+
+		/**
+		 * Expands a node until its proof or disproof number reaches a threshold.
+		 *
+		 * @param cb The board at the node.
+		 * @param plies Plies left for the attacker to deliver mate.
+		 * @param attacker true at nodes where the attacker is to move.
+		 * @param proofThreshold Return once the proof number reaches this value.
+		 * @param disproofThreshold Return once the disproof number reaches this value.
+		 * @return The amount of work (nodes) spent.
+		 */
+		uint32_t multipleIterativeDeepening(ChessBoard& cb, int plies, bool attacker, uint32_t proofThreshold, uint32_t disproofThreshold);
+
+
+		/**
+		 * Proves or disproves one node with an unbounded threshold.
+		 *
+		 * @return true if the node is proven (the attacker mates).
+		 */
+		bool proveNode(ChessBoard& cb, int plies, bool attacker);
+
+
+		/**
+		 * Returns the number of plies of the fastest mate from a node, or -1 if there
+		 * is none within the given plies.
+		 */
+		int shortestMate(ChessBoard& cb, int plies, bool attacker);
+
+
+		/**
+		 * Follows the proof to build the mating line: the attacker's fastest mate
+		 * against the defender's longest resistance.
+		 */
+		void buildLine(ChessBoard& cb, int plies, bool attacker, vector<Move>& line);
+
+
+		/**
+		 * Reads a node's numbers from the table, or the initial values (1, 1) if absent.
+		 */
+		void lookup(uint64_t key, uint32_t& proof, uint32_t& disproof);
+
+
+		/**
+		 * Writes a node's numbers into the table.
+		 */
+		void store(uint64_t key, uint32_t proof, uint32_t disproof, uint32_t work);
+
+
+		/**
+		 * Returns the table key of a node: the position key mixed with the plies left.
+		 */
+		static uint64_t nodeKey(const ChessBoard& cb, int plies);
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "ChessBoard.h"
+
+/* Stages of the move picker in the order they are reached */
+enum PickStage {
+	STAGE_TT_MOVE,
+	STAGE_GENERATE_CAPTURES,
+	STAGE_GOOD_CAPTURES,
+	STAGE_KILLERS,
+	STAGE_GENERATE_QUIETS,
+	STAGE_QUIETS,
+	STAGE_BAD_CAPTURES,
+	STAGE_UNORDERED,
+	STAGE_DONE
+};
+
+
+// MovePicker class declaration
+
+/**
+ * Hands out the legal moves of a position one at a time, best first, generating
+ * each group of moves only when the search gets to it:
+ *  1. the move stored in the transposition table,
+ *  2. captures that do not lose material, most valuable victim / least valuable attacker first,
+ *  3. the killer moves (quiet moves that caused a cutoff at the same ply),
+ *  4. the other quiet moves, highest history score first,
+ *  5. the captures that lose material.
+ * When a move causes a cutoff the picker is dropped, so the later groups are never generated.
+ *
+ * For quiescence search the picker can instead hand out only the captures that
+ * do not lose material by static exchange evaluation, best first.
+ */
+class MovePicker {
+
+	public:
+
+		/**
+		 * MovePicker constructor.
+		 *
+		 * @param cb The board to pick moves for; it must not change while picking (except
+		 * for moves that are made and taken back between calls to next).
+		 * @param ttMove The move from the transposition table, or NO_MOVE.
+		 * @param killers The two killer moves for this ply (may hold NO_MOVE), or nullptr.
+		 * @param history History scores of the active player indexed by source and destination, or nullptr.
+		 * @param ordered false to skip all ordering and return the moves in generation order.
+		 */
+		MovePicker(ChessBoard& cb, Move ttMove, const Move* killers, const int (*history)[64], bool ordered = true);
+
+
+		/**
+		 * Quiescence MovePicker constructor: only captures with a static exchange
+		 * evaluation of zero or more are returned, most valuable victim first.
+		 *
+		 * @param cb The board to pick captures for (same rules as above).
+		 */
+		MovePicker(ChessBoard& cb);
+
+
+		/**
+		 * Returns the next move, or NO_MOVE when there are none left.
+		 */
+		Move next();
+
+
+		/**
+		 * Returns the stage the last move came from.
+		 */
+		PickStage getStage() const;
+
+
+	private:
+
+		ChessBoard& board;
+		Move ttMove;
+		Move killers[2];
+		const int (*history)[64];
+
+		PickStage stage;
+
+		/* Captures only, with losing captures dropped rather than put aside */
+		bool quiescence;
+
+		/* Moves of the current stage with their sort scores; index is the next one to look at */
+		MoveList moves;
+		int scores[MAX_MOVES];
+		int index;
+
+		/* Captures put aside for the last stage */
+		MoveList badCaptures;
+		int badIndex;
+		int killerIndex;
+
+		// Helper functions
+
+		/**
+		 * Removes and returns the highest scoring move left in the current list.
+		 */
+		Move pickBest();
+
+
+		/**
+		 * Returns true if the move was already returned by the TT move or killer stages.
+		 */
+		bool alreadyTried(Move move) const;
+
+
+		/**
+		 * Returns true if a capture loses material by static exchange evaluation.
+		 */
+		bool losingCapture(Move move) const;
+};
+
+#endif
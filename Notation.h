@@ -0,0 +1,40 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+#include "ChessBoard.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Writes a move in Standard Algebraic Notation, e.g. "Nf3", "exd5", "Rad1", "Qh7#".
+ *
+ * @param cb The board the move is made on (it is not changed).
+ * @param move A legal move.
+ * @return The move in SAN, with '+' for check and '#' for checkmate.
+ */
+string moveToSan(const ChessBoard& cb, Move move);
+
+
+/**
+ * Writes a line of moves in Standard Algebraic Notation.
+ *
+ * @param cb The board the line starts from (it is not changed).
+ * @param line Moves that are legal when played in order.
+ * @return The moves in SAN.
+ */
+vector<string> lineToSan(const ChessBoard& cb, const vector<Move>& line);
+
+
+/**
+ * Reads a move in Standard Algebraic Notation or as square names ("e2e4", "E2E4").
+ * Check, mate and annotation marks ("+", "#", "!", "?") are ignored.
+ *
+ * @param cb The board the move is made on (it is not changed).
+ * @param text The move.
+ * @return The legal move it names, or NO_MOVE if it names none or is ambiguous.
+ */
+Move parseMove(const ChessBoard& cb, const string& text);
+
+#endif
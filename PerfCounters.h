@@ -0,0 +1,94 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+/* Hardware events PerfCounters can count */
+enum PerfEvent { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_BRANCH_MISSES, PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_EVENT_COUNT };
+
+/**
+ * Returns a short name of an event for reports (e.g. "cycles").
+ */
+const char* perfEventName(int event);
+
+/* Counts of each event; an event that could not be counted reads 0 */
+struct PerfCounts {
+	double values[PERF_EVENT_COUNT] = {};
+
+	PerfCounts& operator+=(const PerfCounts& other);
+	PerfCounts operator-(const PerfCounts& other) const;
+};
+
+
+// PerfCounters class declaration
+
+/**
+ * Hardware performance counters of the calling thread, through Linux perf_event_open.
+ *
+ * Each event has its own counter, counting user space only from open until the
+ * object is destroyed; a measurement is the difference of two reads. When the
+ * kernel has more events than hardware counters it rotates them, and reads are
+ * scaled up by the share of time each one was running.
+ *
+ * Counters are often unavailable, e.g. in containers, virtual machines without
+ * a virtual PMU, or with kernel.perf_event_paranoid above 2. open then fails
+ * and says why, and callers carry on with wall-clock times only.
+ */
+class PerfCounters {
+
+	public:
+
+		PerfCounters();
+
+
+		/**
+		 * PerfCounters destructor that closes the counters.
+		 */
+		~PerfCounters();
+
+		PerfCounters(const PerfCounters&) = delete;
+		PerfCounters& operator=(const PerfCounters&) = delete;
+
+
+		/**
+		 * Opens a counter for every event the machine supports.
+		 *
+		 * @return false if no event can be counted; getError then says why.
+		 */
+		bool open();
+
+
+		/**
+		 * Returns true if at least one event is being counted.
+		 */
+		bool isOpen() const;
+
+
+		/**
+		 * Returns true if an event is being counted.
+		 */
+		bool has(int event) const;
+
+
+		/**
+		 * Reads the counts so far.
+		 */
+		PerfCounts read() const;
+
+
+		/**
+		 * Returns why open failed.
+		 */
+		string getError() const;
+
+
+	private:
+
+		int fds[PERF_EVENT_COUNT];
+		string error;
+};
+
+#endif
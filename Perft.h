@@ -0,0 +1,108 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "ChessBoard.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Shared table of perft subtree counts keyed by (position key, depth).
+ *
+ * Entries are written without locks: each entry stores its data and the key
+ * XORed with the data, so a read that sees half of one write and half of
+ * another fails the key check and is treated as a miss.
+ */
+class PerftCache {
+
+	public:
+
+		/**
+		 * PerftCache constructor.
+		 *
+		 * @param megabytes Size of the table; rounded down to a power of two number of entries.
+		 */
+		PerftCache(size_t megabytes);
+
+
+		/**
+		 * Looks up the node count of a subtree.
+		 *
+		 * @param key Zobrist key of the position.
+		 * @param depth Depth of the subtree.
+		 * @param nodes Set to the stored count on a hit.
+		 * @return true on a hit, false otherwise.
+		 */
+		bool probe(uint64_t key, int depth, uint64_t& nodes) const;
+
+
+		/**
+		 * Stores the node count of a subtree, replacing whatever shared its slot.
+		 */
+		void store(uint64_t key, int depth, uint64_t nodes);
+
+
+		/**
+		 * Empties the table.
+		 */
+		void clear();
+
+
+		/**
+		 * Returns the number of probes and hits since the table was created or cleared.
+		 */
+		uint64_t getProbes() const;
+		uint64_t getHits() const;
+
+
+	private:
+
+		struct Entry {
+			atomic<uint64_t> check;
+			atomic<uint64_t> data;
+		};
+
+		unique_ptr<Entry[]> entries;
+		size_t mask;
+
+		mutable atomic<uint64_t> probes;
+		mutable atomic<uint64_t> hits;
+};
+
+
+/* Result of a perft run */
+struct PerftResult {
+	uint64_t nodes;
+	double seconds;
+
+	/* Node count below each legal root move, in generation order */
+	vector<pair<Move, uint64_t>> divide;
+};
+
+
+/**
+ * Counts the leaf nodes of the legal move tree to a fixed depth on one thread.
+ *
+ * @param cb The board to count from; it is returned to the same position.
+ * @param depth The depth to count to.
+ * @param cache Optional cache of subtree counts (may be nullptr).
+ * @return The number of leaf nodes.
+ */
+uint64_t perft(ChessBoard& cb, int depth, PerftCache* cache = nullptr);
+
+
+/**
+ * Counts the same leaf nodes as perft, splitting the tree over a work-stealing thread pool.
+ *
+ * @param start The board to count from.
+ * @param depth The depth to count to.
+ * @param threads Number of worker threads (0 = one per hardware thread).
+ * @param cache Optional cache of subtree counts shared by all threads (may be nullptr).
+ * @param splitDepth Subtrees deeper than this are split into one task per move; smaller
+ * ones are counted by a single task.
+ * @return The total, the time taken and the count below each root move.
+ */
+PerftResult parallelPerft(const ChessBoard& start, int depth, int threads, PerftCache* cache = nullptr, int splitDepth = 4);
+
+#endif
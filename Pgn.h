@@ -0,0 +1,96 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * One game of a PGN (Portable Game Notation) file: the tag pairs and the moves
+ * of the main line in SAN. Comments, variations and annotation glyphs are dropped.
+ */
+struct PgnGame {
+
+	/* Tag values by name, e.g. tags["Result"] == "1-0" */
+	map<string, string> tags;
+
+	/* Moves of the main line as written, without move numbers */
+	vector<string> moves;
+
+	/* Result token at the end of the movetext ("1-0", "0-1", "1/2-1/2" or "*") */
+	string result;
+
+
+	/**
+	 * Returns the value of a tag, or a default if the tag is missing.
+	 */
+	string tag(const string& name, const string& missing = "") const;
+};
+
+
+// PgnReader class declaration
+
+/**
+ * Reads the games of a PGN stream one at a time, so files of any size can be
+ * processed without holding more than one game in memory.
+ */
+class PgnReader {
+
+	public:
+
+		/**
+		 * PgnReader constructor.
+		 *
+		 * @param input The stream to read; it must outlive the reader.
+		 */
+		PgnReader(istream& input);
+
+
+		/**
+		 * Reads the next game.
+		 *
+		 * @param game Filled in with the game.
+		 * @return false once there are no more games.
+		 */
+		bool next(PgnGame& game);
+
+
+		/**
+		 * Returns the number of the line the last game read started on.
+		 */
+		int getLineNo() const;
+
+
+		/**
+		 * Returns the byte offset of the line the last game read started on, so
+		 * the game can be read again by seeking the stream there.
+		 */
+		uint64_t getOffset() const;
+
+
+	private:
+
+		istream& input;
+		int lineNo;
+		int gameLineNo;
+		uint64_t gameOffset;
+
+		/* Nesting depth of variations, and whether a {comment} is open, carried across lines */
+		int variationDepth;
+		bool inComment;
+
+		// Helper functions
+
+		/**
+		 * Splits a line of movetext into moves, stopping at the result token.
+		 *
+		 * @return true once the result token has been read.
+		 */
+		bool readMovetext(const string& line, PgnGame& game);
+};
+
+#endif
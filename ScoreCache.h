@@ -0,0 +1,88 @@
+#ifndef SCORECACHE_H
+#define SCORECACHE_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/* One cached score */
+struct ScoreEntry {
+	uint64_t key;
+	int32_t score;
+	uint32_t reserved;
+};
+
+/* Four entries filling one 64 byte cache line, so a probe never touches two lines */
+struct alignas(64) ScoreLine {
+	ScoreEntry entries[4];
+};
+
+
+// ScoreCache class declaration
+
+/**
+ * Fixed size, always-replace cache of scores by Zobrist key, used for pawn
+ * structure scores (by pawn key) and whole evaluations (by position key).
+ *
+ * An empty slot holds key 0 and score 0. Key 0 only belongs to positions
+ * without any pieces (or, for pawn keys, without pawns), which score 0 anyway.
+ * A cache is meant to be owned by one thread and is not locked.
+ */
+class ScoreCache {
+
+	public:
+
+		/**
+		 * ScoreCache constructor.
+		 *
+		 * @param kilobytes Size of the cache; rounded down to a power of two number of cache lines.
+		 */
+		ScoreCache(size_t kilobytes);
+
+
+		/**
+		 * Looks up a score, counting the probe and any hit.
+		 *
+		 * @param key Zobrist key the score was stored under.
+		 * @param score Set to the stored score on a hit.
+		 * @return true on a hit, false otherwise.
+		 */
+		bool probe(uint64_t key, int& score);
+
+
+		/**
+		 * Stores a score, replacing whatever was in its slot.
+		 */
+		void store(uint64_t key, int score);
+
+
+		/**
+		 * Empties the cache and resets the counters.
+		 */
+		void clear();
+
+
+		/**
+		 * Returns the number of probes and hits since the last clear or resetCounters.
+		 */
+		uint64_t getProbes() const;
+		uint64_t getHits() const;
+
+
+		/**
+		 * Resets the probe and hit counters, keeping the entries.
+		 */
+		void resetCounters();
+
+
+	private:
+
+		vector<ScoreLine> lines;
+		size_t mask;
+
+		uint64_t probes;
+		uint64_t hits;
+};
+
+#endif
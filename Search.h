@@ -0,0 +1,282 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "ChessBoard.h"
+#include "ScoreCache.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/* Score of delivering mate now; a mate n plies away scores MATE_SCORE - n */
+const int MATE_SCORE = 30000;
+
+/* Scores beyond this are mates */
+const int MATE_BOUND = MATE_SCORE - 1000;
+
+/* Deepest ply the search can reach */
+const int MAX_PLY = 64;
+
+/* Sizes of each Searcher's pawn structure and evaluation caches */
+const size_t PAWN_CACHE_KILOBYTES = 256;
+const size_t EVAL_CACHE_KILOBYTES = 1024;
+
+/* Margin added to a capture's gain in quiescence search before it is judged unable to raise alpha */
+const int DELTA_MARGIN = 200;
+
+/* Nodes between clock reads when searching against a time limit */
+const uint64_t TIME_CHECK_INTERVAL = 256;
+
+struct SearchResult;
+
+/* When to stop searching */
+struct SearchLimits {
+	/* Deepest iteration of iterative deepening */
+	int depth = MAX_PLY - 1;
+
+	/* Stop once this many nodes have been searched (0 = no limit) */
+	uint64_t nodes = 0;
+
+	/* Time limits for this move (nullptr = no limit); the clock is read every TIME_CHECK_INTERVAL nodes */
+	TimeManager* time = nullptr;
+
+	/* Number of best root moves to find, each with its own line and score */
+	int multiPV = 1;
+
+	/* Called with the result so far each time an iteration completes (may be empty) */
+	function<void(const SearchResult&)> onIteration;
+};
+
+/* Counters gathered during a search */
+struct SearchStats {
+	uint64_t nodes = 0;
+
+	/* Nodes searched by the quiescence search (included in nodes) */
+	uint64_t qnodes = 0;
+
+	/* Nodes where a move failed high, and how many of those did so on the first move tried */
+	uint64_t cutoffs = 0;
+	uint64_t firstMoveCutoffs = 0;
+
+	/* Lookups in the pawn structure and evaluation caches, and how many found a score */
+	uint64_t pawnProbes = 0;
+	uint64_t pawnHits = 0;
+	uint64_t evalProbes = 0;
+	uint64_t evalHits = 0;
+};
+
+/* One of the best root moves found by a multi-PV search */
+struct PVLine {
+	/* Score in centipawns from the active player's side, or a mate score */
+	int score;
+
+	/* Depth of the iteration the line comes from */
+	int depth;
+
+	/* The move and the expected play after it */
+	vector<Move> pv;
+};
+
+/* Result of a search */
+struct SearchResult {
+	Move bestMove;
+
+	/* Score in centipawns from the active player's side, or a mate score */
+	int score;
+
+	/* Depth of the last completed iteration */
+	int depth;
+
+	/* Principal variation: the expected line of play */
+	vector<Move> pv;
+
+	/* The best SearchLimits::multiPV root moves, best first; lines[0] repeats bestMove, score and pv */
+	vector<PVLine> lines;
+
+	SearchStats stats;
+	double seconds;
+};
+
+
+// Searcher class declaration
+
+/**
+ * Iterative deepening alpha-beta search.
+ *
+ * Moves are tried in the order given by a MovePicker: transposition table move,
+ * good captures, killer moves, then quiet moves by history score. A Searcher
+ * keeps its transposition table, killers and history between searches; it is
+ * not shared between threads.
+ *
+ * At the end of the main search a quiescence search keeps playing captures that
+ * do not lose material until the position is quiet, so the evaluation is never
+ * taken in the middle of an exchange.
+ *
+ * Static evaluations are looked up in an evaluation cache by position key, and
+ * the pawn structure part of them in a pawn cache by pawn key; both belong to
+ * the Searcher, so threads never share them.
+ *
+ * A multi-PV search finds the best few root moves in each iteration by
+ * searching the root again with the moves already found left out. The later
+ * searches reuse the transposition table entries of the earlier ones, so the
+ * extra lines cost much less than separate searches.
+ */
+class Searcher {
+
+	public:
+
+		/**
+		 * Searcher constructor.
+		 *
+		 * @param ttMegabytes Size of the transposition table.
+		 */
+		Searcher(size_t ttMegabytes = 16);
+
+
+		/**
+		 * Searches a position.
+		 *
+		 * @param cb The board to search; it is returned to the same position.
+		 * @param limits When to stop.
+		 * @return The best move, its score and line from the deepest completed iteration.
+		 */
+		SearchResult search(ChessBoard& cb, const SearchLimits& limits);
+
+
+		/**
+		 * Runs the quiescence search alone, without limits, e.g. to find the quiet
+		 * position behind a position in the middle of an exchange.
+		 *
+		 * @param cb The board; it is returned to the same position.
+		 * @param line Set to the captures (or check evasions) leading to the quiet
+		 * position the score was taken in.
+		 * @return The score from the active player's side, or a mate score.
+		 */
+		int quiescenceSearch(ChessBoard& cb, vector<Move>& line);
+
+
+		/**
+		 * Turns move ordering on or off. With it off, moves are searched in generation
+		 * order and the transposition table is only used for cutoffs, which shows what
+		 * the ordering saves.
+		 */
+		void setMoveOrdering(bool enabled);
+
+
+		/**
+		 * Turns the quiescence search on or off. With it off, the main search
+		 * evaluates positions directly at depth 0.
+		 */
+		void setQuiescence(bool enabled);
+
+
+		/**
+		 * Turns the pawn structure and evaluation caches on or off. With them off,
+		 * every position is evaluated from scratch.
+		 */
+		void setEvalCache(bool enabled);
+
+
+		/**
+		 * Forgets everything learnt in previous searches: the transposition table,
+		 * evaluation caches, killer moves and history scores.
+		 */
+		void clear();
+
+
+	private:
+
+		TranspositionTable tt;
+
+		/* Pawn structure scores by pawn key, and evaluations by position key */
+		ScoreCache pawnCache;
+		ScoreCache evalCache;
+
+		/* Two quiet moves per ply that recently caused a cutoff */
+		Move killers[MAX_PLY][2];
+
+		/* Cutoff counts of quiet moves, by colour index, source and destination */
+		int history[2][64][64];
+
+		/* Triangular table of principal variations: pv[ply] is the line from that ply */
+		Move pv[MAX_PLY + 1][MAX_PLY + 1];
+		int pvLength[MAX_PLY + 1];
+
+		/* Root moves that already have a line in this iteration of a multi-PV search */
+		vector<Move> excludedRoot;
+
+		bool ordering;
+		bool useQuiescence;
+		bool useEvalCache;
+		uint64_t nodeLimit;
+		TimeManager* timer;
+
+		/* Node count at which the clock is next read */
+		uint64_t nextTimeCheck;
+		bool stopped;
+		SearchStats stats;
+
+		// Helper functions
+
+		/**
+		 * Fail-soft negamax alpha-beta search.
+		 *
+		 * @param cb The board at this node.
+		 * @param depth Plies left to search.
+		 * @param ply Distance from the root.
+		 * @param alpha Lower bound of the window.
+		 * @param beta Upper bound of the window.
+		 * @return The score from the active player's side.
+		 */
+		int alphaBeta(ChessBoard& cb, int depth, int ply, int alpha, int beta);
+
+
+		/**
+		 * Searches captures until the position is quiet. The active player may
+		 * stand pat on the static evaluation unless in check, in which case every
+		 * legal move is searched. Captures that lose material by static exchange
+		 * evaluation, or that cannot raise alpha even with DELTA_MARGIN added, are
+		 * skipped.
+		 *
+		 * @param cb The board at this node.
+		 * @param ply Distance from the root.
+		 * @param alpha Lower bound of the window.
+		 * @param beta Upper bound of the window.
+		 * @return The score from the active player's side.
+		 */
+		int quiescence(ChessBoard& cb, int ply, int alpha, int beta);
+
+
+		/**
+		 * Evaluates a position through the evaluation and pawn structure caches.
+		 *
+		 * @return The score from the active player's side.
+		 */
+		int staticEval(const ChessBoard& cb);
+
+
+		/**
+		 * Records a quiet move that caused a cutoff in the killer and history tables.
+		 */
+		void updateQuietStats(ChessBoard& cb, Move move, int depth, int ply);
+
+
+		/**
+		 * Returns true when the search should stop (node limit or hard time limit reached).
+		 */
+		bool shouldStop();
+};
+
+
+/**
+ * Converts a mate score relative to the root into one relative to the current node for storing.
+ */
+int scoreToTable(int score, int ply);
+
+/**
+ * Converts a stored mate score relative to its node back into one relative to the root.
+ */
+int scoreFromTable(int score, int ply);
+
+#endif
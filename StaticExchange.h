@@ -0,0 +1,31 @@
+#ifndef STATICEXCHANGE_H
+#define STATICEXCHANGE_H
+
+#include "ChessBoard.h"
+
+/**
+ * Static exchange evaluation: the material the active player wins or loses by a
+ * capture if both sides then keep recapturing on the destination square with
+ * their least valuable piece, each stopping when recapturing would lose more.
+ *
+ * Attackers are found with bitboards, including pieces hidden behind other
+ * attackers on the same line (x-rays). Pins are ignored.
+ *
+ * @param cb The board the move is made on.
+ * @param move The capture (or quiet move, which then risks the moving piece).
+ * @return The expected material gain in centipawns; negative for losing moves.
+ */
+int staticExchange(const ChessBoard& cb, Move move);
+
+
+/**
+ * Checks if the static exchange evaluation of a move is at least a threshold.
+ *
+ * @param cb The board the move is made on.
+ * @param move The move.
+ * @param threshold The smallest acceptable gain in centipawns.
+ * @return true if staticExchange(cb, move) >= threshold.
+ */
+bool staticExchangeAtLeast(const ChessBoard& cb, Move move, int threshold);
+
+#endif
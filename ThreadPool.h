@@ -0,0 +1,132 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// ThreadPool class declaration
+
+/**
+ * A pool of worker threads with one task queue per worker.
+ *
+ * A worker takes tasks from the back of its own queue (newest first, which keeps
+ * the board data it just used in its cache) and, when that is empty, steals from
+ * the front of another worker's queue (oldest first, which are usually the
+ * biggest pieces of work). Tasks may add further tasks to the pool while they run.
+ */
+class ThreadPool {
+
+	public:
+
+		/**
+		 * ThreadPool constructor that starts the worker threads.
+		 *
+		 * @param threadCount Number of workers; 0 uses one per hardware thread.
+		 */
+		ThreadPool(int threadCount = 0);
+
+		/**
+		 * ThreadPool destructor that waits for queued tasks and stops the workers.
+		 */
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+
+		/**
+		 * Adds a task to the pool.
+		 *
+		 * @param task The function to run.
+		 *
+		 * From inside a task the new task goes on the calling worker's own queue,
+		 * otherwise tasks are spread over the workers in turn.
+		 */
+		void submit(function<void()> task);
+
+
+		/**
+		 * Blocks until every submitted task (and every task they submitted) has finished.
+		 */
+		void wait();
+
+
+		/**
+		 * Returns the number of worker threads.
+		 */
+		int size() const;
+
+
+		/**
+		 * Returns the index (0 to size() - 1) of the worker running the calling code,
+		 * or -1 when called from a thread that is not a pool worker.
+		 */
+		static int workerIndex();
+
+
+		/**
+		 * Returns the number of tasks that were stolen from another worker's queue.
+		 */
+		long stolenTasks() const;
+
+
+		/**
+		 * Returns the number of hardware threads, at least 1.
+		 */
+		static int hardwareThreads();
+
+
+	private:
+
+		/* Task queue of one worker; the owner uses the back, thieves the front */
+		struct WorkQueue {
+			mutex lock;
+			deque<function<void()>> tasks;
+		};
+
+		vector<thread> workers;
+		vector<WorkQueue> queues;
+
+		/* Tasks submitted but not yet finished */
+		atomic<long> pending;
+
+		/* Tasks sitting in a queue */
+		atomic<long> queued;
+
+		atomic<long> stolen;
+		atomic<unsigned> nextQueue;
+		bool stopping;
+
+		/* Used to put idle workers to sleep and to wake wait() */
+		mutex sleepLock;
+		condition_variable workAvailable;
+		condition_variable allDone;
+
+		// Helper functions
+
+		/**
+		 * Main loop of a worker thread.
+		 *
+		 * @param index The index of the worker.
+		 */
+		void workerLoop(int index);
+
+
+		/**
+		 * Takes the next task for a worker: its own newest task or another worker's oldest.
+		 *
+		 * @param index The index of the worker.
+		 * @param task Set to the task if one was found.
+		 * @return true if a task was found, false otherwise.
+		 */
+		bool takeTask(int index, function<void()>& task);
+};
+
+#endif
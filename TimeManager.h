@@ -0,0 +1,94 @@
+#ifndef TIMEMANAGER_H
+#define TIMEMANAGER_H
+
+#include <chrono>
+
+using namespace std;
+
+/* The clock situation for one move; all times in seconds */
+struct TimeControl {
+	/* Time left on the active player's clock */
+	double timeLeft = 0;
+
+	/* Time added to the clock after each move */
+	double increment = 0;
+
+	/* Moves until the next time control (0 = rest of the game) */
+	int movesToGo = 0;
+
+	/* Fixed time for this move; when set, the clock fields are ignored (0 = not set) */
+	double moveTime = 0;
+
+	/* Time kept back for everything outside the search: returning the move, sending it, ... */
+	double overhead = 0.001;
+};
+
+
+// TimeManager class declaration
+
+/**
+ * Decides how long one move may be searched.
+ *
+ * The soft limit is the time the search aims for: no new iteration is started
+ * after it, and it is cut down while the best move stays the same from one
+ * iteration to the next. The hard limit is never passed; the search checks it
+ * every few hundred nodes and abandons the iteration in progress.
+ *
+ * The clock starts when the TimeManager is constructed.
+ */
+class TimeManager {
+
+	public:
+
+		/**
+		 * TimeManager constructor.
+		 *
+		 * @param tc The clock situation for this move.
+		 */
+		TimeManager(const TimeControl& tc);
+
+
+		/**
+		 * Returns the seconds since the TimeManager was constructed.
+		 */
+		double elapsed() const;
+
+
+		/**
+		 * Returns true once the hard limit has been reached.
+		 */
+		bool hardLimitReached() const;
+
+
+		/**
+		 * Called after each completed iteration to decide whether to start another.
+		 *
+		 * @param bestMoveChanged true if the iteration changed the best move.
+		 * @return true if the search should stop and play the current best move.
+		 */
+		bool stopAfterIteration(bool bestMoveChanged);
+
+
+		/**
+		 * Returns the soft limit in seconds.
+		 */
+		double getSoftLimit() const;
+
+
+		/**
+		 * Returns the hard limit in seconds.
+		 */
+		double getHardLimit() const;
+
+
+	private:
+
+		chrono::steady_clock::time_point start;
+		double softLimit;
+		double hardLimit;
+
+		/* Completed iterations in a row that kept the same best move */
+		int stableIterations;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+/* Events kept per thread; once a buffer is full the oldest events are overwritten */
+const size_t TRACE_BUFFER_EVENTS = 1 << 14;
+
+/* Set by enableTracing; read on every traced scope, so it is checked inline */
+extern atomic<bool> traceEnabled;
+
+
+/**
+ * Turns tracing on or off for every thread. Events already recorded are kept.
+ */
+void enableTracing(bool enabled);
+
+
+/**
+ * Returns true while tracing is on.
+ */
+inline bool tracingEnabled() {
+	return traceEnabled.load(memory_order_relaxed);
+}
+
+
+/**
+ * Returns the time since tracing was first used, in nanoseconds (never 0).
+ */
+uint64_t traceClock();
+
+
+/**
+ * Records one finished scope in the calling thread's ring buffer. Writing never
+ * blocks or allocates, except once per thread to claim a buffer.
+ *
+ * @param name What ran; must be a string literal or live as long as the program.
+ * @param category Group of the event, e.g. "board" or "search"; a string literal as well.
+ * @param start traceClock when the scope began.
+ * @param end traceClock when it ended.
+ * @param argName Name of the argument shown with the event (nullptr = none); a string literal.
+ * @param argValue Its value.
+ */
+void traceEvent(const char* name, const char* category, uint64_t start, uint64_t end, const char* argName, int64_t argValue);
+
+
+/**
+ * Names the calling thread in the trace (e.g. "pool worker 3"). Does nothing
+ * with tracing off. A thread is shown by the number of the buffer it holds, so
+ * when it exits, its events and the buffer pass to the next new thread, which
+ * replaces the name.
+ */
+void setTraceThreadName(const string& name);
+
+
+/**
+ * Writes every buffered event as Chrome trace_event JSON, which chrome://tracing
+ * and Perfetto open. Safe to call while other threads are still tracing; events
+ * overwritten during the copy are left out.
+ *
+ * @param path The file to write.
+ * @param events Set to the number of events written.
+ * @return false if the file cannot be written (the reason is printed).
+ */
+bool writeTrace(const string& path, size_t& events);
+
+
+// TraceScope class declaration
+
+/**
+ * Traces the lifetime of a scope as one complete event: the clock is read when
+ * it is constructed and the event recorded when it is destroyed. With tracing
+ * off this costs a relaxed load and a branch at each end.
+ *
+ * Usage: TraceScope trace("submitMove", "board");
+ */
+class TraceScope {
+
+	public:
+
+		TraceScope(const char* name, const char* category, const char* argName = nullptr, int64_t argValue = 0)
+			: name(name), category(category), argName(argName), argValue(argValue) {
+			start = (tracingEnabled() ? traceClock() : 0);
+		}
+
+
+		/**
+		 * TraceScope destructor that records the event if tracing was on when the scope began.
+		 */
+		~TraceScope() {
+			if (start != 0) {
+				traceEvent(name, category, start, traceClock(), argName, argValue);
+			}
+		}
+
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
+
+
+		/**
+		 * Changes the argument recorded with the event, e.g. to a count known only at the end.
+		 */
+		void setArg(int64_t value) {
+			argValue = value;
+		}
+
+
+	private:
+
+		const char* name;
+		const char* category;
+		const char* argName;
+		int64_t argValue;
+		uint64_t start;
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef TRAININGDATA_H
+#define TRAININGDATA_H
+
+#include "ChessBoard.h"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * One labelled position in a fixed 32 byte record, written as is (little-endian).
+ *
+ * The pieces are stored as the occupied squares plus a 4 bit code for each
+ * occupied square in square order, lowest square first, two to a byte (low
+ * nibble first). The code is colour index * 6 + PieceType, the same numbering
+ * as the Zobrist piece keys. 16 bytes hold 32 pieces, so positions with more
+ * cannot be stored.
+ */
+struct TrainingRecord {
+	uint64_t occupied;
+	uint8_t pieces[16];
+
+	/* Search or evaluation score in centipawns from White's side */
+	int16_t score;
+
+	/* Game result from White's side: 1 win, 0 draw, -1 loss */
+	int8_t result;
+
+	/* 0 = White to move, 1 = Black to move */
+	uint8_t sideToMove;
+
+	/* Plies from the start of the game */
+	uint16_t ply;
+
+	uint16_t reserved;
+};
+
+static_assert(sizeof(TrainingRecord) == 32, "TrainingRecord must stay 32 bytes");
+
+
+/**
+ * Packs a position and its labels into a record.
+ *
+ * @param cb The position.
+ * @param score Score from White's side, clamped to the int16_t range.
+ * @param result Game result from White's side (1, 0, -1).
+ * @param ply Plies from the start of the game.
+ * @param record The record to fill in.
+ * @return false if the position has more than 32 pieces (the record is unchanged).
+ */
+bool packTrainingRecord(const ChessBoard& cb, int score, int result, int ply, TrainingRecord& record);
+
+
+/**
+ * Checks a record read from a file: at most 32 occupied squares, a piece code
+ * below 12 for each of them, a side to move of 0 or 1, and pieces that pass
+ * ChessBoard::validPlacement.
+ *
+ * @param record The record.
+ * @return true if the record holds a position that can be unpacked.
+ */
+bool validTrainingRecord(const TrainingRecord& record);
+
+
+/**
+ * Restores the position stored in a record.
+ *
+ * @param record The record.
+ * @param cb Set to the position (labels are left in the record).
+ * @return false if the record is not valid (the board is unchanged).
+ */
+bool unpackTrainingRecord(const TrainingRecord& record, ChessBoard& cb);
+
+
+/**
+ * Finds the files holding a set of training records: the file itself, or the
+ * numbered shards PATH-00000, PATH-00001... written by TrainingWriter.
+ *
+ * @param path The file, or the path the shards were written under.
+ * @param files Set to the files, in order.
+ * @return false if there are none (the reason is printed).
+ */
+bool trainingDataFiles(const string& path, vector<string>& files);
+
+
+// TrainingWriter class declaration
+
+/**
+ * Writes TrainingRecords to one file or a numbered series of shard files.
+ *
+ * Records are collected in a large buffer and written with one call per full
+ * buffer. With shuffling on, each buffer is shuffled before it is written, so
+ * positions from the same game are spread over the whole buffer (and over the
+ * shards it spans); a bigger buffer gives a better mix.
+ */
+class TrainingWriter {
+
+	public:
+
+		/**
+		 * TrainingWriter constructor.
+		 *
+		 * @param path Output file; with sharding, shards are named path-00000, path-00001, ...
+		 * @param shardRecords Records per shard file, or 0 to write a single file.
+		 * @param bufferRecords Records held before writing.
+		 * @param shuffle true to shuffle each buffer before writing it.
+		 * @param seed Seed of the shuffle.
+		 */
+		TrainingWriter(const string& path, uint64_t shardRecords = 0, size_t bufferRecords = 1 << 20, bool shuffle = false, uint64_t seed = 1);
+
+
+		/**
+		 * Closes the writer, writing anything still buffered.
+		 */
+		~TrainingWriter();
+
+
+		/**
+		 * Adds a record.
+		 *
+		 * @return false if a write failed (the failure is printed once).
+		 */
+		bool add(const TrainingRecord& record);
+
+
+		/**
+		 * Writes anything still buffered and closes the current file.
+		 *
+		 * @return false if any write failed.
+		 */
+		bool close();
+
+
+		/**
+		 * Returns the number of records added and the number of files opened.
+		 */
+		uint64_t getRecords() const;
+		int getFiles() const;
+
+
+	private:
+
+		string basePath;
+		uint64_t shardRecords;
+		bool shuffle;
+		mt19937_64 random;
+
+		vector<TrainingRecord> buffer;
+		size_t bufferSize;
+
+		FILE* file;
+		int files;
+		uint64_t inShard;
+		uint64_t records;
+		bool failed;
+
+		// Helper functions
+
+		/**
+		 * Writes the buffer out, opening new shard files as shards fill up.
+		 */
+		bool flush();
+
+
+		/**
+		 * Opens the next output file.
+		 */
+		bool openFile();
+};
+
+#endif
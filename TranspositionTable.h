@@ -0,0 +1,77 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include "ChessMove.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/* What a stored score says about the true score of the position */
+enum Bound { BOUND_NONE, BOUND_UPPER, BOUND_LOWER, BOUND_EXACT };
+
+/* One stored search result */
+struct TTEntry {
+	uint64_t key;
+	Move move;
+	int16_t score;
+	int8_t depth;
+	uint8_t bound;
+};
+
+
+// TranspositionTable class declaration
+
+/**
+ * Fixed size table of search results indexed by Zobrist key.
+ *
+ * Each slot holds one entry; a new result replaces the old one unless the old
+ * one is for a different position and was searched deeper.
+ */
+class TranspositionTable {
+
+	public:
+
+		/**
+		 * TranspositionTable constructor.
+		 *
+		 * @param megabytes Size of the table; rounded down to a power of two number of entries.
+		 */
+		TranspositionTable(size_t megabytes);
+
+
+		/**
+		 * Looks up a position.
+		 *
+		 * @param key Zobrist key of the position.
+		 * @param entry Set to the stored entry on a hit.
+		 * @return true on a hit, false otherwise.
+		 */
+		bool probe(uint64_t key, TTEntry& entry) const;
+
+
+		/**
+		 * Stores a search result.
+		 *
+		 * @param key Zobrist key of the position.
+		 * @param move Best move found (NO_MOVE if none).
+		 * @param score Score of the position, with mate scores counted from this position.
+		 * @param depth Depth the position was searched to.
+		 * @param bound Whether the score is exact or a bound.
+		 */
+		void store(uint64_t key, Move move, int score, int depth, Bound bound);
+
+
+		/**
+		 * Empties the table.
+		 */
+		void clear();
+
+
+	private:
+
+		vector<TTEntry> entries;
+		size_t mask;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include "ChessBoard.h"
+#include "ThreadPool.h"
+#include "TrainingData.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * The evaluation weights being tuned, in one array of TUNE_PARAMETERS values:
+ * pieceValues by PieceType, then pieceSquare by PieceType and square, then the
+ * doubled, isolated and backward pawn penalties and passedPawn by rank.
+ */
+const int TUNE_MATERIAL = 0;
+const int TUNE_PIECE_SQUARE = TUNE_MATERIAL + 6;
+const int TUNE_DOUBLED = TUNE_PIECE_SQUARE + 6 * 64;
+const int TUNE_ISOLATED = TUNE_DOUBLED + 1;
+const int TUNE_BACKWARD = TUNE_ISOLATED + 1;
+const int TUNE_PASSED = TUNE_BACKWARD + 1;
+const int TUNE_PARAMETERS = TUNE_PASSED + 8;
+
+/*
+ * Features of a TunePosition: one piece-square weight per piece, the material
+ * weights of the five piece types besides the King and the eleven pawn structure
+ * weights. A position has at most 32 pieces, so 48 always hold them.
+ */
+const int TUNE_FEATURES = 48;
+
+/*
+ * A labelled position reduced to the weights its evaluation reads, each with
+ * its coefficient: +1 or -1 for a piece-square weight, White's count minus
+ * Black's for the material and pawn structure weights. The evaluation is the
+ * sum of weight times coefficient over a fixed number of entries, with unused
+ * entries left at coefficient 0, so the loops over them have no branches.
+ * 146 bytes, so ten million fit in 1.5 GB.
+ */
+struct TunePosition {
+	uint16_t features[TUNE_FEATURES];
+	int8_t coefficients[TUNE_FEATURES];
+
+	/* Game result from White's side: 1 win, 0 draw, -1 loss */
+	int8_t result;
+
+	uint8_t reserved;
+};
+
+static_assert(sizeof(TunePosition) == 146, "TunePosition must stay 146 bytes");
+
+
+/* How the tuner runs */
+struct TuneOptions {
+	/* Worker threads (0 = one per hardware thread) */
+	int threads = 0;
+
+	/* Passes of gradient descent over every position */
+	int epochs = 200;
+
+	/* Adam step size in centipawns */
+	double learningRate = 1.0;
+
+	/* Scaling of the evaluation in the win probability 1 / (1 + 10^(-K * eval / 400)); 0 = fit it first */
+	double scalingK = 0;
+
+	/* Replace each position by the quiet position its quiescence search ends in */
+	bool quiescence = true;
+
+	/* Stop loading after this many positions (0 = all) */
+	uint64_t limit = 0;
+};
+
+
+// Tuner class declaration
+
+/**
+ * Texel tuning of the evaluation weights against game results.
+ *
+ * Positions are loaded from training record files into one compact array of
+ * TunePositions, with each position first replaced by the quiet position at
+ * the end of its quiescence search line, so the evaluation is never judged in
+ * the middle of an exchange. The evaluation is linear in its weights, so the
+ * error of a set of weights and its gradient take a single pass over the array.
+ *
+ * Each epoch splits the array across the tuner's thread pool, which lives as
+ * long as the tuner; every worker adds up its
+ * squared errors and gradient in its own arrays, which are then summed, and an
+ * Adam step moves every weight. The King's material value is left alone, as it
+ * is never captured.
+ */
+class Tuner {
+
+	public:
+
+		/**
+		 * Tuner constructor: the weights start at the current evaluation's.
+		 */
+		Tuner(const TuneOptions& options);
+
+
+		/**
+		 * Loads training records, from a file or from the numbered shards PATH-00000,
+		 * PATH-00001... written by TrainingWriter. Positions without a legal move are
+		 * skipped.
+		 *
+		 * @param path The file, or the path the shards were written under.
+		 * @return false if nothing could be read (the reason is printed).
+		 */
+		bool load(const string& path);
+
+
+		/**
+		 * Fits the scaling constant K to the loaded positions with the current weights,
+		 * unless TuneOptions::scalingK fixed it, and returns it.
+		 */
+		double fitScaling();
+
+
+		/**
+		 * Runs one epoch: the error and gradient over every position and one Adam step.
+		 *
+		 * @return The mean squared error of the weights before the step.
+		 */
+		double epoch();
+
+
+		/**
+		 * Returns the mean squared error of the current weights.
+		 */
+		double error();
+
+
+		/**
+		 * Writes the weights, rounded to centipawns, as C++ constants in the form
+		 * of Evaluation.h and eval.cpp, ready to paste in.
+		 *
+		 * @param path The file to write.
+		 * @return false if it cannot be written (the reason is printed).
+		 */
+		bool writeParameters(const string& path) const;
+
+
+		/**
+		 * Returns the number of positions loaded.
+		 */
+		size_t getPositions() const;
+
+
+		/**
+		 * Returns the number of records skipped because they do not hold a valid position.
+		 */
+		size_t getInvalidRecords() const;
+
+
+		/**
+		 * Returns the evaluation of a loaded position with the current weights, from White's side.
+		 */
+		double evaluate(size_t index) const;
+
+
+	private:
+
+		TuneOptions options;
+		int threads;
+		ThreadPool pool;
+		vector<TunePosition> positions;
+		size_t invalidRecords;
+
+		vector<double> weights;
+		double scalingK;
+
+		/* Adam moment estimates and step count */
+		vector<double> firstMoment;
+		vector<double> secondMoment;
+		int steps;
+
+		// Helper functions
+
+		/**
+		 * Sums the squared error over every position and, if gradient is not
+		 * nullptr, the gradient of the mean squared error into it.
+		 *
+		 * @return The mean squared error.
+		 */
+		double errorAndGradient(double k, vector<double>* gradient);
+
+
+		/**
+		 * Reduces a batch of training records to TunePositions, in parallel.
+		 */
+		void addRecords(const vector<TrainingRecord>& records);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+/*
+ * Random keys for Zobrist hashing. A position's key is the XOR of the key of
+ * every piece on its square plus blackToMove when Black is to move, so it can
+ * be updated with a couple of XORs whenever a piece moves.
+ *
+ * The keys are generated at compile time from a fixed seed, so they are the
+ * same in every build and on every run.
+ */
+struct ZobristKeys {
+	/* Indexed by colour index * 6 + PieceType, then square */
+	uint64_t pieces[12][64];
+	uint64_t blackToMove;
+};
+
+// SplitMix64 step used to fill the key table
+constexpr uint64_t zobristNext(uint64_t& state) {
+	state += 0x9e3779b97f4a7c15ULL;
+	uint64_t z = state;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys makeZobristKeys() {
+	ZobristKeys keys = {};
+	uint64_t state = 0x43686573734b6579ULL;
+	for (int piece = 0; piece < 12; piece++) {
+		for (int square = 0; square < 64; square++) {
+			keys.pieces[piece][square] = zobristNext(state);
+		}
+	}
+	keys.blackToMove = zobristNext(state);
+	return keys;
+}
+
+inline constexpr ZobristKeys zobrist = makeZobristKeys();
+
+#endif
@@ -0,0 +1,135 @@
+#include <cstring>
+
+#include "AttackMaps.h"
+#include "ChessPieces.h"
+#include "Geometry.h"
+
+using namespace std;
+
+// Ray from a square in one direction, cut short at the first occupied square
+static inline Bitboard rayAttacks(int direction, int square, Bitboard occupied) {
+
+	Bitboard attacks = geometry.rays[direction][square];
+	Bitboard blockers = attacks & occupied;
+
+	// Everything beyond the nearest blocker is the same ray from the blocker
+	if (blockers) {
+		int blocker = (direction < 4 ? lowestSquare(blockers) : highestSquare(blockers));
+		attacks ^= geometry.rays[direction][blocker];
+	}
+	return attacks;
+}
+
+Bitboard rookAttacks(int square, Bitboard occupied) {
+	return rayAttacks(RAY_SOUTH, square, occupied) | rayAttacks(RAY_NORTH, square, occupied)
+		| rayAttacks(RAY_EAST, square, occupied) | rayAttacks(RAY_WEST, square, occupied);
+}
+
+Bitboard bishopAttacks(int square, Bitboard occupied) {
+	return rayAttacks(RAY_SOUTH_EAST, square, occupied) | rayAttacks(RAY_SOUTH_WEST, square, occupied)
+		| rayAttacks(RAY_NORTH_EAST, square, occupied) | rayAttacks(RAY_NORTH_WEST, square, occupied);
+}
+
+Bitboard knightAttacks(int square) {
+	return geometry.knight[square];
+}
+
+Bitboard kingAttacks(int square) {
+	return geometry.king[square];
+}
+
+Bitboard pawnAttacks(int colour, int square) {
+	return geometry.pawn[colour][square];
+}
+
+Bitboard pieceAttacks(int type, int colour, int square, Bitboard occupied) {
+
+	switch (type) {
+		case KING:
+			return kingAttacks(square);
+		case QUEEN:
+			return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+		case BISHOP:
+			return bishopAttacks(square, occupied);
+		case ROOK:
+			return rookAttacks(square, occupied);
+		case KNIGHT:
+			return knightAttacks(square);
+		default:
+			return pawnAttacks(colour, square);
+	}
+}
+
+/* ---------------------------------------------------------------------- */
+
+// Implementation of AttackMaps
+
+// Builds the maps for every piece on the board
+void AttackMaps::build(const Bitboard colourPieces[2], const Bitboard typePieces[6]) {
+
+	memset(attackers, 0, sizeof(attackers));
+	memset(attacksFrom, 0, sizeof(attacksFrom));
+	owners[0] = 0;
+	owners[1] = 0;
+
+	Bitboard occupied = colourPieces[0] | colourPieces[1];
+	while (occupied) {
+		refreshSquare(popLowestSquare(occupied), colourPieces, typePieces);
+	}
+}
+
+// Recomputes the pieces affected by a change on the given squares
+void AttackMaps::update(const Bitboard colourPieces[2], const Bitboard typePieces[6], Bitboard changed) {
+
+	// Sliding pieces reaching a changed square before the change may now be blocked
+	// or see further, so they are recomputed along with the changed squares themselves.
+	// A slider which only reaches a changed square after the change must also have
+	// reached one before it (the square that used to block it), so this covers all of them.
+	Bitboard sliders = (typePieces[QUEEN] | typePieces[ROOK] | typePieces[BISHOP]) & ~changed;
+	Bitboard affected = changed;
+
+	Bitboard squares = changed;
+	while (squares) {
+		int square = popLowestSquare(squares);
+		affected |= (attackers[0][square] | attackers[1][square]) & sliders;
+	}
+
+	while (affected) {
+		refreshSquare(popLowestSquare(affected), colourPieces, typePieces);
+	}
+}
+
+// Replaces the attacks credited to one square with the attacks of the piece now on it
+void AttackMaps::refreshSquare(int square, const Bitboard colourPieces[2], const Bitboard typePieces[6]) {
+
+	Bitboard bit = squareBit(square);
+
+	// Remove the old attacks from whichever colour they were counted for
+	if ((owners[0] | owners[1]) & bit) {
+		int oldColour = (owners[0] & bit ? 0 : 1);
+		Bitboard targets = attacksFrom[square];
+		while (targets) {
+			attackers[oldColour][popLowestSquare(targets)] &= ~bit;
+		}
+		owners[oldColour] &= ~bit;
+		attacksFrom[square] = 0;
+	}
+
+	// Add the attacks of the piece now on the square
+	if ((colourPieces[0] | colourPieces[1]) & bit) {
+		int colour = (colourPieces[0] & bit ? 0 : 1);
+		int type = 0;
+		while (!(typePieces[type] & bit)) {
+			type++;
+		}
+
+		Bitboard attacks = pieceAttacks(type, colour, square, colourPieces[0] | colourPieces[1]);
+		attacksFrom[square] = attacks;
+		owners[colour] |= bit;
+
+		Bitboard targets = attacks;
+		while (targets) {
+			attackers[colour][popLowestSquare(targets)] |= bit;
+		}
+	}
+}
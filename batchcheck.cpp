@@ -0,0 +1,202 @@
+#include <cstring>
+
+#include "BatchCheck.h"
+
+using namespace std;
+
+/* Four bitboards in one 256 bit AVX2 register; plain operators work on all four lanes */
+typedef uint64_t FourLanes __attribute__((vector_size(32)));
+
+/*
+ * The helpers below return FourLanes by value, which GCC warns changes the
+ * ABI without AVX. They are always inlined, so there is no call to disagree on.
+ */
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+/* Files the pieces on files A-B and G-H would wrap onto when shifted two files */
+static const Bitboard FILES_AB = FILE_A | (FILE_A << 1);
+static const Bitboard FILES_GH = FILE_H | (FILE_H >> 1);
+
+// BoardBatch implementation
+
+// Appends one position's bitboards to each array
+void BoardBatch::add(const ChessBoard& cb) {
+	for (int colour = 0; colour < 2; colour++) {
+		for (int type = 0; type < 6; type++) {
+			pieces[colour][type].push_back(cb.getPieces(colour == 0 ? 'w' : 'b', (PieceType)type));
+		}
+	}
+	sideToMove.push_back(cb.getActiveColour() == 'w' ? 0 : 1);
+}
+
+// Number of lanes
+size_t BoardBatch::size() const {
+	return sideToMove.size();
+}
+
+// Empties every array
+void BoardBatch::clear() {
+	for (int colour = 0; colour < 2; colour++) {
+		for (int type = 0; type < 6; type++) {
+			pieces[colour][type].clear();
+		}
+	}
+	sideToMove.clear();
+}
+
+
+// Shifts every lane towards higher squares for S > 0, lower squares for S < 0
+template <int S, class Lanes>
+static inline __attribute__((always_inline)) Lanes shift(const Lanes& bits) {
+	return (S > 0 ? bits << (S > 0 ? S : 0) : bits >> (S < 0 ? -S : 0));
+}
+
+/*
+ * Kogge-Stone occluded fill: the squares a slider on from attacks in direction
+ * S, stopping at the first occupied square. mask is the squares a one step
+ * shift in that direction may land on without wrapping to the other edge.
+ */
+template <int S, class Lanes>
+static inline __attribute__((always_inline)) Lanes slide(const Lanes& from, const Lanes& empty, Bitboard mask) {
+	Lanes gen = from;
+	Lanes pro = empty & mask;
+	gen |= pro & shift<S>(gen);
+	pro &= shift<S>(pro);
+	gen |= pro & shift<2 * S>(gen);
+	pro &= shift<2 * S>(pro);
+	gen |= pro & shift<4 * S>(gen);
+	return shift<S>(gen) & mask;
+}
+
+/*
+ * Finds whether the King of the side to move is attacked, in the lanes
+ * starting at first, and writes one result per lane. Lanes is a uint64_t for
+ * one lane at a time or FourLanes for four.
+ */
+template <class Lanes>
+static inline __attribute__((always_inline)) void checkLanes(const BoardBatch& batch, size_t first, uint8_t* results) {
+
+	const int count = sizeof(Lanes) / sizeof(Bitboard);
+
+	// All ones in the lanes where Black is to move
+	Lanes black;
+	for (int k = 0; k < count; k++) {
+		((uint64_t*)&black)[k] = -(uint64_t)batch.sideToMove[first + k];
+	}
+	Lanes white = ~black;
+
+	Lanes own[6];
+	Lanes enemy[6];
+	Lanes occupied = black ^ black;
+	for (int type = 0; type < 6; type++) {
+		Lanes w;
+		Lanes b;
+		memcpy(&w, &batch.pieces[0][type][first], sizeof(Lanes));
+		memcpy(&b, &batch.pieces[1][type][first], sizeof(Lanes));
+		own[type] = (w & white) | (b & black);
+		enemy[type] = (b & white) | (w & black);
+		occupied |= w | b;
+	}
+
+	Lanes king = own[KING];
+	Lanes empty = ~occupied;
+	Lanes rookLike = enemy[ROOK] | enemy[QUEEN];
+	Lanes bishopLike = enemy[BISHOP] | enemy[QUEEN];
+
+	// Sliding attacks: fill out from the King and see which enemy sliders the rays reach
+	Lanes hits = (slide<1>(king, empty, ~FILE_A) | slide<-1>(king, empty, ~FILE_H)
+		| slide<8>(king, empty, ~0ULL) | slide<-8>(king, empty, ~0ULL)) & rookLike;
+	hits |= (slide<9>(king, empty, ~FILE_A) | slide<-9>(king, empty, ~FILE_H)
+		| slide<7>(king, empty, ~FILE_H) | slide<-7>(king, empty, ~FILE_A)) & bishopLike;
+
+	// Knight squares: one file and two ranks away, or two files and one rank
+	Lanes oneFile = (shift<1>(king) & ~FILE_A) | (shift<-1>(king) & ~FILE_H);
+	Lanes twoFiles = (shift<2>(king) & ~FILES_AB) | (shift<-2>(king) & ~FILES_GH);
+	hits |= (shift<16>(oneFile) | shift<-16>(oneFile) | shift<8>(twoFiles) | shift<-8>(twoFiles)) & enemy[KNIGHT];
+
+	Lanes around = oneFile | king;
+	hits |= (around | shift<8>(around) | shift<-8>(around)) & enemy[KING];
+
+	// White's King is attacked by Black pawns on the row above it, Black's by White pawns on the row below
+	Lanes above = (shift<-7>(king) & ~FILE_A) | (shift<-9>(king) & ~FILE_H);
+	Lanes below = (shift<7>(king) & ~FILE_H) | (shift<9>(king) & ~FILE_A);
+	hits |= ((above & white) | (below & black)) & enemy[PAWN];
+
+	for (int k = 0; k < count; k++) {
+		results[first + k] = (((uint64_t*)&hits)[k] != 0);
+	}
+}
+
+// One lane at a time from first to the end of the batch
+static void scalarKernel(const BoardBatch& batch, size_t first, uint8_t* results) {
+	for (size_t lane = first; lane < batch.size(); lane++) {
+		checkLanes<uint64_t>(batch, lane, results);
+	}
+}
+
+// Four lanes per step; the lanes left over are done by the scalar kernel
+__attribute__((target("avx2")))
+static void avx2Kernel(const BoardBatch& batch, uint8_t* results) {
+	size_t lane = 0;
+	for (; lane + 4 <= batch.size(); lane += 4) {
+		checkLanes<FourLanes>(batch, lane, results);
+	}
+	scalarKernel(batch, lane, results);
+}
+
+// Checked once; the answer cannot change while the program runs
+bool batchAvx2Supported() {
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+}
+
+// Runs the kernel asked for, or the scalar one when AVX2 is not there
+static void runKernel(const BoardBatch& batch, uint8_t* results, BatchKernel kernel) {
+	if (kernel != BATCH_SCALAR && batchAvx2Supported()) {
+		avx2Kernel(batch, results);
+	}
+	else {
+		scalarKernel(batch, 0, results);
+	}
+}
+
+// Side to move in check, per lane
+void batchInCheck(const BoardBatch& batch, vector<uint8_t>& inCheck, BatchKernel kernel) {
+	inCheck.resize(batch.size());
+	runKernel(batch, inCheck.data(), kernel);
+}
+
+// Makes each lane's move on a copy, then tests the movers' Kings together
+void batchIsLegal(const BoardBatch& batch, const vector<Move>& moves, vector<uint8_t>& legal, BatchKernel kernel) {
+
+	BoardBatch after = batch;
+	vector<uint8_t> valid(batch.size());
+
+	for (size_t lane = 0; lane < batch.size(); lane++) {
+		int us = batch.sideToMove[lane];
+		Bitboard source = squareBit(moveSource(moves[lane]));
+		Bitboard dest = squareBit(moveDest(moves[lane]));
+
+		int moving = -1;
+		for (int type = 0; type < 6; type++) {
+			if (after.pieces[us][type][lane] & source) {
+				moving = type;
+			}
+		}
+		if (moving < 0) {
+			continue;
+		}
+
+		for (int type = 0; type < 6; type++) {
+			after.pieces[1 - us][type][lane] &= ~dest;
+		}
+		after.pieces[us][moving][lane] ^= source | dest;
+		valid[lane] = 1;
+	}
+
+	legal.resize(batch.size());
+	runKernel(after, legal.data(), kernel);
+	for (size_t lane = 0; lane < batch.size(); lane++) {
+		legal[lane] = valid[lane] && !legal[lane];
+	}
+}
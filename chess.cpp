@@ -1,486 +1,1167 @@
-#include <iostream>
-#include <map>
-#include <cctype>
-#include <cstring>
-#include <string>
-
-#include "ChessBoard.h"
-#include "ChessPieces.h"
-
-using namespace std;
-
-// ChessBoard class implementation
-
-/* Base constructor definition */
-ChessBoard::ChessBoard() {
-
-	// Create map of char inserts and Piece pointers
-	pieceMap.insert(make_pair('K', new King('K')));
-	pieceMap.insert(make_pair('Q', new Queen('Q')));
-	pieceMap.insert(make_pair('B', new Bishop('B')));
-	pieceMap.insert(make_pair('R', new Rook('R')));
-	pieceMap.insert(make_pair('N', new Knight('N')));
-	pieceMap.insert(make_pair('P', new Pawn('P')));
-	pieceMap.insert(make_pair('k', new King('k')));
-	pieceMap.insert(make_pair('q', new Queen('q')));
-	pieceMap.insert(make_pair('b', new Bishop('b')));
-	pieceMap.insert(make_pair('r', new Rook('r')));
-	pieceMap.insert(make_pair('n', new Knight('n')));
-	pieceMap.insert(make_pair('p', new Pawn('p')));
-
-}
-
-/* ChessBoard destructor */
-ChessBoard::~ChessBoard() {
-
-	for (auto it = pieceMap.begin(); it != pieceMap.end(); it++) {
-		Piece* ptr = it->second;
-		delete ptr;
-	}
-
-	pieceMap.clear();
-}
-
-/* Returns active colour character */
-char ChessBoard::getActiveColour() const {
-	return activeColour;
-}
-
-/* Returns active colour string */
-string ChessBoard::outputActiveColour() const {
-	if (activeColour == 'w') {
-		return "White's ";
-	}
-	return "Black's ";
-}
-
-/* Definition of loadState which converts FEN notation into 2D array of piece pointers */
-void ChessBoard::loadState(const char* boardState) {
-
-	int whiteSpace = 0;
-
-	char pieceData[64];
-
-	int i = 0;
-	while (boardState[i] != '\0') {
-		if (boardState[i] == ' ') {
-			whiteSpace++;
-		}
-		if (whiteSpace == 0) {
-			pieceData[i] = boardState[i];
-			pieceData[i + 1] = '\0';
-		}
-		if (whiteSpace == 1) {
-			i++;
-			activeColour = boardState[i];
-		}
-		i++;
-	}
-
-	// Convert string into chess board of piece pointers
-	convertToBoardOfPointers(pieceData);
-
-	cout << "A new board state is loaded!" << endl;
-
-}
-
-// Function to convert the piece data into an array of Piece pointers
-void ChessBoard::convertToBoardOfPointers(char* pieceData) {
-
-	int row = 0;
-	int col = 0;
-
-	// Loop through piece data and create pointers
-	int i = 0;
-	while (pieceData[i] != '\0' && row < 8) {
-
-		if (pieceData[i] == '/') {
-			i++;
-			row++;
-			col = 0;
-		}
-		if (pieceData[i] >= '1' && pieceData[i] <= '8') {
-			int noEmptySpaces = pieceData[i] - '0';
-			for (int i = 0; i < noEmptySpaces; i++) {
-					board[row][col] = nullptr; // Spaces = null pointers
-				col++;
-			}
-			i++;
-		}
-		else {
-			board[row][col] = pieceMap[pieceData[i]];
-			col++;
-			i++;
-		}
-	}
-}
-
-// Function used in debugging to test moves
-void ChessBoard::printBoard() {
-
-	for (int i = 0; i < 8; i++) {
-		for (int j = 0; j < 8; j++) {
-			
-			if (!board[i][j]) {
-				cout << " ";
-			}
-			else {
-				cout << board[i][j]->getName();
-			}
-
-		}
-		cout << "\n";
-	}
-	cout << "\n";
-}
-
-// Function used to submit a move from source square to destination square
-void ChessBoard::submitMove(const char* sourceSquare, const char* destSquare) {
-
-	// Check if the game is already over
-	if (inCheckmate) {
-		cout << "The game already ended in checkmate!" << endl;
-		return;
-	}
-	if (inStalemate) {
-		cout << "The game already ended in stalemate!" << endl;
-		return;
-	}
-
-	// Create variables for source and destination row and column
-	char sourceCol = sourceSquare[0];
-	char sourceRow = sourceSquare[1];
-	char destCol = destSquare[0];
-	char destRow = destSquare[1];
-
-	// Convert characters to integer indices 0-7
-	int sourceColNo = sourceCol - 'A';
-	int sourceRowNo = '8' - sourceRow;
-	int destColNo = destCol - 'A';
-	int destRowNo = '8' - destRow;
-
-	// Set boolean for piece being captured
-	bool capture = false;
-
-	// Pointers to pieces / null for source and destination squares
-	Piece* currentPiece = board[sourceRowNo][sourceColNo];
-	Piece* destPiece = board[destRowNo][destColNo];
-
-	// Check input character length is valid
-	if (!inputLengthIsValid(sourceSquare, destSquare)) {
-		cout << "Input sqaure string entry invalid" << endl;
-		return;
-	}
-
-	// Check source and destination squares are on the board
-	if (!onBoard(sourceCol, sourceRow, destCol, destRow)) {
-		cout << "Input squares are not on the board" << endl;
-		return;
-	}	
-
-	// Check there is a piece in the source square
-	if (!currentPiece) {
-		cout << "There is no piece at position " << sourceSquare << "!" << endl;
-		return;
-	}
-
-	// Check if source and destinations squares are the same
-	if (sourceRow == destRow && sourceCol == destCol) {
-		cout << "Cannot submit move to the same square!" << endl;
-		return;
-	}
-
-	// Check that the correct colour piece is being moved for this turn	
-	if (currentPiece->getColour() != activeColour) {
-		cout << "It is not ";
-		if (activeColour == 'w') {
-			cout << "Black's ";
-		}
-		else {
-			cout << "White's ";
-		}
-		cout << "turn to move!" << endl;
-		return;
-	}
-
-	// Check that source piece and destination pieces are not the same colour 
-	// if not then set capture to true as moving to a square with opponent's piece 
-	if (destPiece) {
-		if (destPiece->getColour() == currentPiece->getColour()) {
-			cout << this->outputActiveColour() << currentPiece->outputName() << " cannot move to " << destSquare << "!" << endl;
-			return;
-		}
-		capture = true;
-	}
-
-	// Checks if piece at source square can move in line with logic
-	// and checks if move will lead to player being in check - as if it does it is illegal
-	if (moveIsValidAndNotInCheck(sourceRowNo, sourceColNo, destRowNo, destColNo, capture)) {
-
-		// If move is possible and doesn't put the king in check then make the move
-		makeMove(sourceSquare, destSquare);
-	
-		// After move was made check if the move puts the opponent's King in check
-		char opponentColour = (activeColour == 'w' ? 'b' : 'w');
-		string opponent = (opponentColour == 'w' ? "White " : "Black ");
-
-		if (inCheck(opponentColour, board)) {
-				
-			// If opponenet King in check and opponent has no response to check then checkmate
-			if (!legalResponse(opponentColour)) {
-				cout << opponent << "is in checkmate" << endl;
-				inCheckmate = true;
-				return;
-			}
-			else {
-				// If in check and there is a legal response then opponent is just in check
-				cout << opponent << "is in check" << endl;
-			}
-		}
-		else {
-			// If not in check and no legal response then opponent is in stalemate
-			if (!legalResponse(opponentColour)) {
-				cout << "Game is in stalemate" << endl;
-				inStalemate = true;
-				return;
-			}
-		}
-	}
-	else {
-		// Otherwise move is not valid
-		cout << this->outputActiveColour() << currentPiece->outputName()
-		 << " cannot move to " << destSquare << "!" << endl;
-	}
-
-	// At the end of the turn switch colour of active player
-	switchPlayer(activeColour);
-}
-
-// Checks that moves follows chess logic and does not put player's King in check
-bool ChessBoard::moveIsValidAndNotInCheck(int sourceRowNo, int sourceColNo, int destRowNo, int destColNo, bool capture) {
-	
-	Piece* currentPiece = board[sourceRowNo][sourceColNo];
-	char pieceColour = currentPiece->getColour();
-
-	// Check that the piece can move from source to destination according to logic
-	if (currentPiece->validMove(sourceRowNo, sourceColNo, destRowNo, destColNo, board, capture)) {
-
-		// Create a copy of the board to simulate the move
-		Piece* testBoard[8][8];
-		testMove(sourceRowNo, sourceColNo, destRowNo, destColNo, testBoard);
-
-		// See if the move will put active player's King in check
-		if(inCheck(pieceColour, testBoard)) {
-			return false;
-		}
-
-		// Move is valid logically and does not lead to check
-		return true;
-	}
-
-	// Move is not valid logically
-	return false;
-}
-
-// Checks if player has any legal moves in response to check
-bool ChessBoard::legalResponse(char playerColour) {
-
-	// Loop through board to get all player pieces
-	for (int row = 0; row < 8; row++) {
-		for (int col = 0; col < 8; col++) {
-			Piece* piece = board[row][col];
-
-			if (piece != NULL && piece->getColour() == playerColour) {
-				// See if player's pieces can make any legal moves
-
-				if (pieceCanMove(row, col)) {
-					return true;
-				}
-			}
-		}
-	}
-	// No player piece can make any legal moves
-	return false;
-}
-
-// Check if player piece can make any legal moves
-bool ChessBoard::pieceCanMove(int pieceRow, int pieceCol) {
-
-	char pieceColour = board[pieceRow][pieceCol]->getColour();
-	char opponentColour = (pieceColour == 'w' ? 'b' : 'w');
-
-	// Loop through the board to see if specified piece can make a valid move
-	for (int destRow = 0; destRow < 8; destRow++) {
-		for (int destCol = 0; destCol < 8; destCol++) {
-			Piece* dest = board[destRow][destCol];
-
-			// Move to empty square or opponent piece
-			if (!dest || dest->getColour() == opponentColour) {
-				
-				// Capture opponent piece if it exists
-				bool capture = (dest == NULL ? false : true);	
-
-				if (moveIsValidAndNotInCheck(pieceRow, pieceCol, destRow, destCol, capture)) {
-					return true;
-				}
-			}
-		}
-	}
-	// Selected piece has no valid moves where the King is not in check
-	return false;
-}
-
-// Moves source piece to destination square and handles capturing
-void ChessBoard::makeMove(const char* sourceSquare, const char* destSquare) {
-
-	// Create variables for source and destination row and column
-	char sourceCol = sourceSquare[0];
-	char sourceRow = sourceSquare[1];
-	char destCol = destSquare[0];
-	char destRow = destSquare[1];
-
-	// Convert characters to integer indices 0-7
-	int sourceColNo = sourceCol - 'A';
-	int sourceRowNo = '8' - sourceRow;
-	int destColNo = destCol - 'A';
-	int destRowNo = '8' - destRow;
-
-	// Piece pointers to source, destination and captured piece if relevant
-	Piece* sourcePiece = board[sourceRowNo][sourceColNo];
-	Piece* capturedPiece = nullptr;
-	
-	string capturedName;
-	string capturedColour;
-
-	// If there is a piece to be captured - handle capturing
-	if (board[destRowNo][destColNo]) {
-		// Destination piece is captured
-		capturedPiece = board[destRowNo][destColNo];		
-		capturedName = capturedPiece->outputName();
-		capturedColour = capturedPiece->outputColour();
-
-		board[destRowNo][destColNo] = board[sourceRowNo][sourceColNo]; // Move source piece
-		board[sourceRowNo][sourceColNo] = nullptr;
-		 
-	}
-	// Else if there is no piece to be captured, move source piece to destination square
-	else {
-		// Move source piece to destination square and make source square empty
-		board[destRowNo][destColNo] = board[sourceRowNo][sourceColNo]; // Move source piece
-		board[sourceRowNo][sourceColNo] = nullptr;
-	}
-
-	// Output scenarios
-	if (capturedPiece) {
-		cout << sourcePiece->outputColour() << sourcePiece->outputName()
-		 << " moves from " << sourceSquare << " to " << destSquare << " taking "
-		 << capturedColour << capturedName << endl; 
-	}
-	else {
-		cout << sourcePiece->outputColour() << sourcePiece->outputName()
-		 << " moves from " << sourceSquare << " to " << destSquare << endl;
-	}
-
-}
-
-// Checks if specified colour's King is in check by opponent's pieces
-bool ChessBoard::inCheck(char playerColour, Piece* board[8][8]) {
-
-	int kingRow;
-	int kingCol;
-
-	bool capture = true;
-
-	// Gets the coordinates of the King square
-	findKing(board, playerColour, kingRow, kingCol);
-
-	// Set opposition colour
-	char oppColour = (playerColour == 'w' ? 'b' : 'w');
-
-	// Loop through each square of the board and identify opponent's pieces
-	for (int row = 0; row < 8; row++) {
-		for (int col = 0; col < 8; col++) {
-			Piece* piece = board[row][col];
-
-			// Identify opponent's pieces
-			if (piece != NULL && piece->getColour() == oppColour) {
-				// Check if opponents piece can move towards the King
-				if (piece->validMove(row, col, kingRow, kingCol, board, capture)) {
-					// If move is possible then King is in check
-					return true;
-				}
-			}
-		}
-	}
-	// King is not in check
-	return false;
-}
-
-// Simulates a proposed move on a test board
-void ChessBoard::testMove(int sourceRow, int sourceCol, int destRow, int destCol, Piece* testBoard[8][8]) {
-
-	// Make testBoard a copy of the actual board
-	for (int row = 0; row < 8; row++) {
-		for (int col = 0; col < 8; col++) {
-			testBoard[row][col] = board[row][col];
-		}
-	}
-	// Make the simulated move on the test board
-	testBoard[destRow][destCol] = testBoard[sourceRow][sourceCol];
-	testBoard[sourceRow][sourceCol] = nullptr;
-}
-
-// Returns position of the king of a specified colour
-void ChessBoard::findKing(Piece* board[8][8], char colour, int& kingRow, int& kingCol) {
-
-	for (int row = 0; row < 8; row++) {
-		for (int col = 0; col < 8; col++) {
-			if (board[row][col]) {
-				if (colour == 'w') {
-					if (board[row][col]->getName() == 'K') {
-						kingRow = row;
-						kingCol = col;
-					}
-				}
-				if (colour == 'b') {
-					if (board[row][col]->getName() == 'k') {
-						kingRow = row;
-						kingCol = col;
-					}
-				}
-			}
-		}
-	}
-
-}
-
-// Switches active player
-void ChessBoard::switchPlayer(char colour) {
-	if (colour == 'w') {
-		this->activeColour = 'b';
-	}
-	else {
-		this->activeColour = 'w';
-	}
-}
-
-// Checks input length of string is valid
-bool ChessBoard::inputLengthIsValid(const char* sourceSquare, const char* destSquare) {
-	
-	if (strlen(sourceSquare) != 2 || strlen(destSquare) != 2) {
-		return false;
-	}
-	return true;
-}
-
-// Checks square exists on the board
-bool ChessBoard::onBoard(char sourceCol, char sourceRow, char destCol, char destRow) {
-
-	if (sourceCol < 'A' || sourceCol > 'H' || 
-			sourceRow < '1' || sourceRow > '8' || 
-			destCol < 'A' || destCol > 'H' || 
-			destRow < '1' || destRow > '8') {
-			return false;
-		}
-	return true;
-}
+#include <iostream>
+#include <cctype>
+#include <cstring>
+#include <string>
+
+#include "ChessBoard.h"
+#include "ChessPieces.h"
+#include "Geometry.h"
+#include "Trace.h"
+
+using namespace std;
+
+// ChessBoard class implementation
+
+/* Base constructor definition */
+ChessBoard::ChessBoard() {
+
+	// Start with an empty board
+	for (int row = 0; row < 8; row++) {
+		for (int col = 0; col < 8; col++) {
+			board[row][col] = nullptr;
+		}
+	}
+	activeColour = 'w';
+	syncBitboards();
+}
+
+/* Returns active colour character */
+char ChessBoard::getActiveColour() const {
+	return activeColour;
+}
+
+/* Returns active colour string */
+string ChessBoard::outputActiveColour() const {
+	if (activeColour == 'w') {
+		return "White's ";
+	}
+	return "Black's ";
+}
+
+/* Definition of loadState which converts FEN notation into 2D array of piece pointers */
+void ChessBoard::loadState(const char* boardState) {
+
+	TraceScope trace("loadState", "board");
+	if (!setPosition(boardState)) {
+		cout << "Invalid board state " << boardState << ", the board is unchanged" << endl;
+		return;
+	}
+
+	cout << "A new board state is loaded!" << endl;
+
+}
+
+// Loads a FEN string without any output, leaving the board as it was if the string is not a position
+bool ChessBoard::setPosition(const char* boardState) {
+
+	Piece* squares[8][8];
+	char colour;
+	if (!parseFen(boardState, squares, colour)) {
+		return false;
+	}
+
+	for (int row = 0; row < 8; row++) {
+		for (int col = 0; col < 8; col++) {
+			board[row][col] = squares[row][col];
+		}
+	}
+	activeColour = colour;
+	syncBitboards();
+
+	inCheckmate = false;
+	inStalemate = false;
+	return true;
+}
+
+// Parses into a scratch board that is thrown away
+bool ChessBoard::validFen(const char* boardState) {
+	Piece* squares[8][8];
+	char colour;
+	return parseFen(boardState, squares, colour);
+}
+
+// The piece placement runs to the first space; the active colour is the next field
+bool ChessBoard::parseFen(const char* boardState, Piece* squares[8][8], char& colour) {
+
+	const char* space = strchr(boardState, ' ');
+	if (!space) {
+		return false;
+	}
+	const char* field = space;
+	while (*field == ' ') {
+		field++;
+	}
+	if ((*field != 'w' && *field != 'b') || (field[1] != '\0' && field[1] != ' ')) {
+		return false;
+	}
+
+	if (!convertToBoardOfPointers(boardState, space - boardState, squares)) {
+		return false;
+	}
+
+	uint8_t codes[64];
+	for (int square = 0; square < 64; square++) {
+		Piece* piece = squares[squareRow(square)][squareCol(square)];
+		codes[square] = (piece ? (piece->getColour() == 'w' ? 0 : 6) + piece->getType() + 1 : 0);
+	}
+	if (!validPlacement(codes)) {
+		return false;
+	}
+
+	colour = *field;
+	return true;
+}
+
+// Unpacks the square codes, which may be anything in a packed position read from outside
+bool ChessBoard::validPacked(const PackedPosition& packed) {
+
+	if (packed.activeColour != 'w' && packed.activeColour != 'b') {
+		return false;
+	}
+
+	uint8_t codes[64];
+	for (int square = 0; square < 64; square++) {
+		codes[square] = (packed.squares[square >> 1] >> ((square & 1) * 4)) & 15;
+	}
+	return validPlacement(codes);
+}
+
+// Pieces beyond the starting set can only come from promoted pawns, so each one needs a missing pawn
+bool ChessBoard::validPlacement(const uint8_t codes[64]) {
+
+	static const int startingCounts[6] = { 1, 1, 2, 2, 2, 8 };
+	int counts[2][6] = { { 0 } };
+
+	for (int square = 0; square < 64; square++) {
+		int code = codes[square];
+		if (code == 0) {
+			continue;
+		}
+		if (code > 12) {
+			return false;
+		}
+		int type = (code - 1) % 6;
+		int colour = (code - 1) / 6;
+
+		// Without promotion a Pawn stays on the last rank once it gets there, but it can never be behind its second rank
+		if (type == PAWN && squareRow(square) == (colour == 0 ? 7 : 0)) {
+			return false;
+		}
+		counts[colour][type]++;
+	}
+
+	// The search and the move generator both assume each side has exactly one King
+	for (int colour = 0; colour < 2; colour++) {
+		int pieces = 0;
+		int promoted = 0;
+		for (int type = 0; type < 6; type++) {
+			pieces += counts[colour][type];
+			if (type != PAWN && counts[colour][type] > startingCounts[type]) {
+				promoted += counts[colour][type] - startingCounts[type];
+			}
+		}
+		if (counts[colour][KING] != 1 || counts[colour][PAWN] > 8 || pieces > 16 || promoted > 8 - counts[colour][PAWN]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Function to convert the piece data into an array of Piece pointers
+bool ChessBoard::convertToBoardOfPointers(const char* pieceData, int length, Piece* squares[8][8]) {
+
+	int row = 0;
+	int col = 0;
+
+	// Every rank must fill exactly eight files, and there must be eight ranks
+	for (int i = 0; i < length; i++) {
+
+		if (pieceData[i] == '/') {
+			if (col != 8 || row == 7) {
+				return false;
+			}
+			row++;
+			col = 0;
+		}
+		else if (pieceData[i] >= '1' && pieceData[i] <= '8') {
+			int noEmptySpaces = pieceData[i] - '0';
+			if (col + noEmptySpaces > 8) {
+				return false;
+			}
+			for (int empty = 0; empty < noEmptySpaces; empty++) {
+				squares[row][col] = nullptr; // Spaces = null pointers
+				col++;
+			}
+		}
+		else {
+			Piece* piece = pieceFromName(pieceData[i]);
+			if (!piece || col == 8) {
+				return false;
+			}
+			squares[row][col] = piece;
+			col++;
+		}
+	}
+	return row == 7 && col == 8;
+}
+
+// Function used in debugging to test moves
+void ChessBoard::printBoard() {
+
+	for (int i = 0; i < 8; i++) {
+		for (int j = 0; j < 8; j++) {
+			
+			if (!board[i][j]) {
+				cout << " ";
+			}
+			else {
+				cout << board[i][j]->getName();
+			}
+
+		}
+		cout << "\n";
+	}
+	cout << "\n";
+}
+
+// Stores the board in 4 bits per square
+void ChessBoard::packState(PackedPosition& packed) const {
+
+	const char* pieceChars = "KQBRNPkqbrnp";
+
+	for (int i = 0; i < 32; i++) {
+		packed.squares[i] = 0;
+	}
+
+	for (int square = 0; square < 64; square++) {
+		Piece* piece = board[squareRow(square)][squareCol(square)];
+		if (piece) {
+			uint8_t code = strchr(pieceChars, piece->getName()) - pieceChars + 1;
+			packed.squares[square >> 1] |= code << ((square & 1) * 4);
+		}
+	}
+	packed.activeColour = activeColour;
+}
+
+// Restores a board stored with packState
+void ChessBoard::unpackState(const PackedPosition& packed) {
+
+	const char* pieceChars = "KQBRNPkqbrnp";
+
+	for (int square = 0; square < 64; square++) {
+		int code = (packed.squares[square >> 1] >> ((square & 1) * 4)) & 15;
+		board[squareRow(square)][squareCol(square)] = (code == 0 ? nullptr : pieceFromName(pieceChars[code - 1]));
+	}
+	activeColour = packed.activeColour;
+	syncBitboards();
+
+	inCheckmate = false;
+	inStalemate = false;
+}
+
+// Checks an encoded move is legal for the active player without any output
+bool ChessBoard::isLegalMove(Move move) {
+
+	int sourceRowNo = squareRow(moveSource(move));
+	int sourceColNo = squareCol(moveSource(move));
+	int destRowNo = squareRow(moveDest(move));
+	int destColNo = squareCol(moveDest(move));
+
+	Piece* currentPiece = board[sourceRowNo][sourceColNo];
+	Piece* destPiece = board[destRowNo][destColNo];
+
+	if (moveSource(move) == moveDest(move) || !currentPiece) {
+		return false;
+	}
+	if (currentPiece->getColour() != activeColour) {
+		return false;
+	}
+	if (destPiece && destPiece->getColour() == activeColour) {
+		return false;
+	}
+
+	return moveIsValidAndNotInCheck(sourceRowNo, sourceColNo, destRowNo, destColNo, destPiece != nullptr);
+}
+
+// Makes an encoded move without validating it or producing any output
+void ChessBoard::applyMove(Move move) {
+
+	movePiece(moveSource(move), moveDest(move));
+	switchPlayer(activeColour);
+}
+
+// Makes a move that can be taken back with undoMove
+MoveUndo ChessBoard::doMove(Move move) {
+
+	MoveUndo undo;
+	undo.captured = pieceAt(moveDest(move));
+
+	movePiece(moveSource(move), moveDest(move));
+	switchPlayer(activeColour);
+
+	return undo;
+}
+
+// Takes back a move made with doMove
+void ChessBoard::undoMove(Move move, const MoveUndo& undo) {
+
+	int source = moveSource(move);
+	int dest = moveDest(move);
+
+	setSquare(source, pieceAt(dest));
+	setSquare(dest, undo.captured);
+
+	if (useAttackMaps) {
+		attackMaps.update(colourPieces, typePieces, squareBit(source) | squareBit(dest));
+	}
+
+	switchPlayer(activeColour);
+}
+
+// Moves a piece keeping bitboards and attack maps in step with the board array
+void ChessBoard::movePiece(int source, int dest) {
+
+	setSquare(dest, pieceAt(source));
+	setSquare(source, nullptr);
+
+	if (useAttackMaps) {
+		attackMaps.update(colourPieces, typePieces, squareBit(source) | squareBit(dest));
+	}
+}
+
+// Places a piece on a square, or empties it, and updates the bitboards
+void ChessBoard::setSquare(int square, Piece* piece) {
+
+	Bitboard bit = squareBit(square);
+	Piece* oldPiece = board[squareRow(square)][squareCol(square)];
+
+	if (oldPiece) {
+		colourPieces[colourIndex(oldPiece->getColour())] &= ~bit;
+		typePieces[oldPiece->getType()] &= ~bit;
+		key ^= zobrist.pieces[colourIndex(oldPiece->getColour()) * 6 + oldPiece->getType()][square];
+		if (oldPiece->getType() == PAWN) {
+			pawnKey ^= zobrist.pieces[colourIndex(oldPiece->getColour()) * 6 + PAWN][square];
+		}
+	}
+	if (piece) {
+		colourPieces[colourIndex(piece->getColour())] |= bit;
+		typePieces[piece->getType()] |= bit;
+		key ^= zobrist.pieces[colourIndex(piece->getColour()) * 6 + piece->getType()][square];
+		if (piece->getType() == PAWN) {
+			pawnKey ^= zobrist.pieces[colourIndex(piece->getColour()) * 6 + PAWN][square];
+		}
+	}
+
+	board[squareRow(square)][squareCol(square)] = piece;
+	legalCacheValid = false;
+	statusKnown[0] = false;
+	statusKnown[1] = false;
+}
+
+// Rebuilds the bitboards from the board array
+void ChessBoard::syncBitboards() {
+
+	colourPieces[0] = 0;
+	colourPieces[1] = 0;
+	for (int type = 0; type < 6; type++) {
+		typePieces[type] = 0;
+	}
+	key = (activeColour == 'b' ? zobrist.blackToMove : 0);
+	pawnKey = 0;
+	legalCacheValid = false;
+	statusKnown[0] = false;
+	statusKnown[1] = false;
+
+	for (int square = 0; square < 64; square++) {
+		Piece* piece = board[squareRow(square)][squareCol(square)];
+		if (piece) {
+			colourPieces[colourIndex(piece->getColour())] |= squareBit(square);
+			typePieces[piece->getType()] |= squareBit(square);
+			key ^= zobrist.pieces[colourIndex(piece->getColour()) * 6 + piece->getType()][square];
+			if (piece->getType() == PAWN) {
+				pawnKey ^= zobrist.pieces[colourIndex(piece->getColour()) * 6 + PAWN][square];
+			}
+		}
+	}
+
+	if (useAttackMaps) {
+		attackMaps.build(colourPieces, typePieces);
+	}
+}
+
+// Turns the attack maps on or off
+void ChessBoard::enableAttackMaps(bool enable) {
+
+	useAttackMaps = enable;
+
+	if (useAttackMaps) {
+		attackMaps.build(colourPieces, typePieces);
+	}
+}
+
+// Returns true if the attack maps are on
+bool ChessBoard::attackMapsEnabled() const {
+	return useAttackMaps;
+}
+
+// Returns the pieces of a colour attacking a square, from the maps or computed on demand
+Bitboard ChessBoard::attackersTo(int square, char colour) const {
+
+	int us = colourIndex(colour);
+
+	if (useAttackMaps) {
+		return attackMaps.attackers[us][square];
+	}
+
+	return allAttackersTo(square, getOccupied()) & colourPieces[us];
+}
+
+// Returns the pieces of both colours attacking a square with the given occupancy
+Bitboard ChessBoard::allAttackersTo(int square, Bitboard occupied) const {
+
+	Bitboard diagonal = typePieces[QUEEN] | typePieces[BISHOP];
+	Bitboard straight = typePieces[QUEEN] | typePieces[ROOK];
+
+	// A pawn attacks the square if a pawn of the other colour on the square would attack it
+	return (knightAttacks(square) & typePieces[KNIGHT])
+		| (kingAttacks(square) & typePieces[KING])
+		| (pawnAttacks(1, square) & typePieces[PAWN] & colourPieces[0])
+		| (pawnAttacks(0, square) & typePieces[PAWN] & colourPieces[1])
+		| (bishopAttacks(square, occupied) & diagonal)
+		| (rookAttacks(square, occupied) & straight);
+}
+
+// Checks if a square is attacked by a colour
+bool ChessBoard::squareAttacked(int square, char byColour) const {
+	return attackersTo(square, byColour) != 0;
+}
+
+// Checks if a colour's King is in check
+bool ChessBoard::kingInCheck(char colour) const {
+
+	int king = kingSquare(colour);
+	if (king < 0) {
+		return false;
+	}
+	return squareAttacked(king, (colour == 'w' ? 'b' : 'w'));
+}
+
+// Checks if a King could stand on a square without being attacked
+bool ChessBoard::kingMoveIsSafe(char colour, int destSquare) const {
+
+	char oppColour = (colour == 'w' ? 'b' : 'w');
+	int king = kingSquare(colour);
+
+	if (squareAttacked(destSquare, oppColour)) {
+		return false;
+	}
+	if (king < 0) {
+		return true;
+	}
+
+	// A slider checking the King would also attack squares behind the King once it moves away
+	Bitboard checkers = attackersTo(king, oppColour) & (typePieces[QUEEN] | typePieces[ROOK] | typePieces[BISHOP]);
+	Bitboard occupied = getOccupied() & ~squareBit(king);
+
+	while (checkers) {
+		int checker = popLowestSquare(checkers);
+		Piece* piece = pieceAt(checker);
+		if (pieceAttacks(piece->getType(), colourIndex(oppColour), checker, occupied) & squareBit(destSquare)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Returns the square of a colour's King
+int ChessBoard::kingSquare(char colour) const {
+
+	Bitboard king = typePieces[KING] & colourPieces[colourIndex(colour)];
+	return (king ? lowestSquare(king) : -1);
+}
+
+// Returns all occupied squares
+Bitboard ChessBoard::getOccupied() const {
+	return colourPieces[0] | colourPieces[1];
+}
+
+// Returns the squares of a colour's pieces
+Bitboard ChessBoard::getPieces(char colour) const {
+	return colourPieces[colourIndex(colour)];
+}
+
+// Returns the squares of a colour's pieces of one type
+Bitboard ChessBoard::getPieces(char colour, PieceType type) const {
+	return colourPieces[colourIndex(colour)] & typePieces[type];
+}
+
+// Returns the Zobrist key of the position
+uint64_t ChessBoard::getKey() const {
+	return key;
+}
+
+// Returns the Zobrist key of the pawns
+uint64_t ChessBoard::getPawnKey() const {
+	return pawnKey;
+}
+
+// Works out the key after a move from the key before it
+uint64_t ChessBoard::keyAfter(Move move) const {
+
+	int source = moveSource(move);
+	int dest = moveDest(move);
+	Piece* piece = pieceAt(source);
+	Piece* captured = pieceAt(dest);
+
+	int pieceIndex = colourIndex(piece->getColour()) * 6 + piece->getType();
+	uint64_t newKey = key ^ zobrist.pieces[pieceIndex][source] ^ zobrist.pieces[pieceIndex][dest] ^ zobrist.blackToMove;
+
+	if (captured) {
+		newKey ^= zobrist.pieces[colourIndex(captured->getColour()) * 6 + captured->getType()][dest];
+	}
+	return newKey;
+}
+
+// Generates all legal moves for the active player
+void ChessBoard::generateLegalMoves(MoveList& moves) {
+	generateMoves(moves, GEN_ALL);
+}
+
+// Destinations of one piece from the cached legal moves
+Bitboard ChessBoard::legalMovesFrom(int square) {
+	fillLegalCache();
+	return legalTargets[square];
+}
+
+// Pieces with a legal move from the cached legal moves
+Bitboard ChessBoard::legalMoveMask() {
+	fillLegalCache();
+	return legalSources;
+}
+
+// Regenerates the legal move cache after the board has changed
+void ChessBoard::fillLegalCache() {
+
+	if (legalCacheValid) {
+		return;
+	}
+
+	TraceScope trace("legalMoves", "board");
+	MoveList moves;
+	generateLegalMoves(moves);
+
+	for (int square = 0; square < 64; square++) {
+		legalTargets[square] = 0;
+	}
+	legalSources = 0;
+
+	for (int i = 0; i < moves.size; i++) {
+		legalTargets[moveSource(moves.moves[i])] |= squareBit(moveDest(moves.moves[i]));
+		legalSources |= squareBit(moveSource(moves.moves[i]));
+	}
+	legalCacheValid = true;
+}
+
+// Check, checkmate or stalemate for a player, from the cache if no piece has moved since
+GameStatus ChessBoard::gameStatus(char colour) {
+
+	int us = colourIndex(colour);
+	if (statusKnown[us]) {
+		return statusCache[us];
+	}
+
+	TraceScope trace("gameStatus", "board");
+	int king = kingSquare(colour);
+	Bitboard checkers = (king >= 0 ? attackersTo(king, (colour == 'w' ? 'b' : 'w')) : 0);
+
+	GameStatus status;
+	if (hasLegalMove(colour, checkers)) {
+		status = (checkers ? STATUS_CHECK : STATUS_ONGOING);
+	}
+	else {
+		status = (checkers ? STATUS_CHECKMATE : STATUS_STALEMATE);
+	}
+
+	// Trying moves on the board may have cleared the cache, so it is filled in last
+	statusCache[us] = status;
+	statusKnown[us] = true;
+	return status;
+}
+
+/* Destinations of a set of pawns by kind of move, each a shift of the whole set */
+struct PawnTargets {
+	Bitboard push;
+	Bitboard doublePush;
+	Bitboard captureEast;
+	Bitboard captureWest;
+
+	Bitboard all() const {
+		return push | doublePush | captureEast | captureWest;
+	}
+};
+
+/*
+ * Square offsets of the pawn moves of colour index Us: White pawns advance
+ * towards row 0, Black pawns towards row 7. Capturing towards file H is east.
+ */
+template <int Us> struct PawnStep {
+	static const int PUSH = (Us == 0 ? -8 : 8);
+	static const int EAST = (Us == 0 ? -7 : 9);
+	static const int WEST = (Us == 0 ? -9 : 7);
+
+	/* Row a pawn reaches by a single push from its starting row (row 5 for White, row 2 for Black) */
+	static const Bitboard PUSHED_ROW = (Us == 0 ? 0xFFULL << 40 : 0xFFULL << 16);
+};
+
+// Moves every square of a bitboard by a fixed offset, dropping squares that leave the top or bottom
+template <int Offset>
+static inline Bitboard shiftBy(Bitboard squares) {
+	return (Offset > 0 ? squares << (Offset > 0 ? Offset : 0) : squares >> (Offset < 0 ? -Offset : 0));
+}
+
+// Pseudo-legal destinations of every pawn in pawns, of colour index Us
+template <int Us>
+static PawnTargets pawnTargets(Bitboard pawns, Bitboard empty, Bitboard enemy) {
+
+	PawnTargets targets;
+	targets.push = shiftBy<PawnStep<Us>::PUSH>(pawns) & empty;
+	targets.doublePush = shiftBy<PawnStep<Us>::PUSH>(targets.push & PawnStep<Us>::PUSHED_ROW) & empty;
+	targets.captureEast = shiftBy<PawnStep<Us>::EAST>(pawns) & ~FILE_A & enemy;
+	targets.captureWest = shiftBy<PawnStep<Us>::WEST>(pawns) & ~FILE_H & enemy;
+	return targets;
+}
+
+// Searches for one legal move, trying the cheapest kinds first
+bool ChessBoard::hasLegalMove(char colour, Bitboard checkers) {
+
+	int us = colourIndex(colour);
+	int king = kingSquare(colour);
+
+	if (king >= 0) {
+		Bitboard kingTargets = kingAttacks(king) & ~colourPieces[us];
+		while (kingTargets) {
+			if (kingMoveIsSafe(colour, popLowestSquare(kingTargets))) {
+				return true;
+			}
+		}
+	}
+
+	// Against a double check only the King can move
+	if (popCount(checkers) > 1) {
+		return false;
+	}
+
+	// Against a single check the other pieces must take the checker or step between it and the King
+	Bitboard wanted = ~colourPieces[us];
+	if (checkers) {
+		int checker = lowestSquare(checkers);
+		wanted = checkers;
+		PieceType type = pieceAt(checker)->getType();
+		if (type == QUEEN || type == ROOK || type == BISHOP) {
+			wanted |= geometry.between[king][checker];
+		}
+	}
+
+	Bitboard pinned = pinnedPieces(colour);
+
+	// Pawns that are not pinned move freely, so all of them are tried at once
+	Bitboard freePawns = colourPieces[us] & typePieces[PAWN] & ~pinned;
+	Bitboard empty = ~getOccupied();
+	PawnTargets pawnMoves = (us == 0 ? pawnTargets<0>(freePawns, empty, colourPieces[1]) : pawnTargets<1>(freePawns, empty, colourPieces[0]));
+	if (pawnMoves.all() & wanted) {
+		return true;
+	}
+
+	Bitboard pieces = colourPieces[us] & ~typePieces[KING] & ~freePawns;
+
+	while (pieces) {
+		int source = popLowestSquare(pieces);
+		Bitboard targets = pseudoTargets(source, pieceAt(source)) & wanted;
+
+		// A pinned piece can never answer a check, and otherwise may only move along the pin
+		if (pinned & squareBit(source)) {
+			if (checkers) {
+				continue;
+			}
+			targets &= geometry.line[king][source];
+		}
+
+		if (targets) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Generates the legal captures, quiet moves or both for the active player
+void ChessBoard::generateMoves(MoveList& moves, GenType type) {
+
+	moves.size = 0;
+
+	int us = colourIndex(activeColour);
+	Bitboard enemy = colourPieces[1 - us];
+
+	Bitboard wanted = enemy | ~getOccupied();
+	if (type == GEN_CAPTURES) {
+		wanted = enemy;
+	}
+	else if (type == GEN_QUIETS) {
+		wanted = ~getOccupied();
+	}
+
+	int king = kingSquare(activeColour);
+	bool check = kingInCheck(activeColour);
+	Bitboard pinned = pinnedPieces(activeColour);
+
+	Bitboard pieces = colourPieces[us] & ~typePieces[PAWN];
+	while (pieces) {
+		int source = popLowestSquare(pieces);
+		Bitboard targets = pseudoTargets(source, pieceAt(source)) & wanted;
+
+		while (targets) {
+			Move move = encodeMove(source, popLowestSquare(targets));
+			if (moveKeepsKingSafe(move, king, check, pinned)) {
+				moves.add(move);
+			}
+		}
+	}
+
+	if (us == 0) {
+		generatePawnMoves<0>(moves, wanted, king, check, pinned);
+	}
+	else {
+		generatePawnMoves<1>(moves, wanted, king, check, pinned);
+	}
+}
+
+// Adds the legal pawn moves of one colour, a kind of move at a time for all pawns together
+template <int Us>
+void ChessBoard::generatePawnMoves(MoveList& moves, Bitboard wanted, int king, bool check, Bitboard pinned) {
+
+	PawnTargets targets = pawnTargets<Us>(typePieces[PAWN] & colourPieces[Us], ~getOccupied(), colourPieces[1 - Us]);
+
+	// Each destination's pawn is found by stepping back by the offset of its kind of move
+	const Bitboard dests[4] = { targets.push, targets.doublePush, targets.captureEast, targets.captureWest };
+	const int offsets[4] = { PawnStep<Us>::PUSH, 2 * PawnStep<Us>::PUSH, PawnStep<Us>::EAST, PawnStep<Us>::WEST };
+
+	for (int kind = 0; kind < 4; kind++) {
+		Bitboard kindDests = dests[kind] & wanted;
+		while (kindDests) {
+			int dest = popLowestSquare(kindDests);
+			Move move = encodeMove(dest - offsets[kind], dest);
+			if (moveKeepsKingSafe(move, king, check, pinned)) {
+				moves.add(move);
+			}
+		}
+	}
+}
+
+// Squares a piece may move to by its own rules
+Bitboard ChessBoard::pseudoTargets(int source, Piece* piece) const {
+
+	int us = colourIndex(piece->getColour());
+	Bitboard occupied = getOccupied();
+
+	if (piece->getType() != PAWN) {
+		return pieceAttacks(piece->getType(), us, source, occupied) & ~colourPieces[us];
+	}
+
+	// The set-wise pawn moves of a set holding just this pawn
+	if (us == 0) {
+		return pawnTargets<0>(squareBit(source), ~occupied, colourPieces[1]).all();
+	}
+	return pawnTargets<1>(squareBit(source), ~occupied, colourPieces[0]).all();
+}
+
+// Checks the King is safe after a pseudo-legal move
+bool ChessBoard::moveKeepsKingSafe(Move move, int king, bool check, Bitboard pinned) {
+
+	int source = moveSource(move);
+
+	if (source == king) {
+		return kingMoveIsSafe(activeColour, moveDest(move));
+	}
+	// A piece that is not pinned can only expose the King if it is already in check
+	if (!check && !(pinned & squareBit(source))) {
+		return true;
+	}
+	// A pinned piece is safe moving along the pin, towards or away from the King
+	if (!check) {
+		return (geometry.line[king][source] & squareBit(moveDest(move))) != 0;
+	}
+
+	char colour = activeColour;
+	MoveUndo undo = doMove(move);
+	bool illegal = kingInCheck(colour);
+	undoMove(move, undo);
+
+	return !illegal;
+}
+
+// Checks a move matches the movement rules of the active player's piece
+bool ChessBoard::isPseudoLegal(Move move) const {
+
+	int source = moveSource(move);
+	int dest = moveDest(move);
+	Piece* piece = pieceAt(source);
+
+	if (moveFlags(move) != 0 || !piece || piece->getColour() != activeColour) {
+		return false;
+	}
+	return (pseudoTargets(source, piece) & squareBit(dest)) != 0;
+}
+
+// Checks a pseudo-legal move is legal
+bool ChessBoard::isLegal(Move move) {
+	return moveKeepsKingSafe(move, kingSquare(activeColour), kingInCheck(activeColour), pinnedPieces(activeColour));
+}
+
+// Finds pieces standing alone between a King and an opponent's slider
+Bitboard ChessBoard::pinnedPieces(char colour) const {
+
+	int us = colourIndex(colour);
+	int king = kingSquare(colour);
+	if (king < 0) {
+		return 0;
+	}
+
+	Bitboard occupied = getOccupied();
+	Bitboard pinned = 0;
+
+	// Sliders that would attack the King if the King's own pieces were not there
+	Bitboard opponents = colourPieces[1 - us];
+	Bitboard snipers = (rookAttacks(king, opponents) & (typePieces[QUEEN] | typePieces[ROOK]) & opponents)
+		| (bishopAttacks(king, opponents) & (typePieces[QUEEN] | typePieces[BISHOP]) & opponents);
+
+	while (snipers) {
+		int sniper = popLowestSquare(snipers);
+
+		Bitboard blockers = geometry.between[king][sniper] & occupied;
+
+		if (popCount(blockers) == 1 && (blockers & colourPieces[us])) {
+			pinned |= blockers;
+		}
+	}
+	return pinned;
+}
+
+// Returns the piece on a square
+Piece* ChessBoard::pieceAt(int square) const {
+	return board[squareRow(square)][squareCol(square)];
+}
+
+// Function used to submit a move from source square to destination square
+void ChessBoard::submitMove(const char* sourceSquare, const char* destSquare) {
+
+	TraceScope trace("submitMove", "board");
+
+	// Check if the game is already over
+	if (inCheckmate) {
+		cout << "The game already ended in checkmate!" << endl;
+		return;
+	}
+	if (inStalemate) {
+		cout << "The game already ended in stalemate!" << endl;
+		return;
+	}
+
+	// Create variables for source and destination row and column
+	char sourceCol = sourceSquare[0];
+	char sourceRow = sourceSquare[1];
+	char destCol = destSquare[0];
+	char destRow = destSquare[1];
+
+	// Convert characters to integer indices 0-7
+	int sourceColNo = sourceCol - 'A';
+	int sourceRowNo = '8' - sourceRow;
+	int destColNo = destCol - 'A';
+	int destRowNo = '8' - destRow;
+
+	// Set boolean for piece being captured
+	bool capture = false;
+
+	// Pointers to pieces / null for source and destination squares
+	Piece* currentPiece = board[sourceRowNo][sourceColNo];
+	Piece* destPiece = board[destRowNo][destColNo];
+
+	// Check input character length is valid
+	if (!inputLengthIsValid(sourceSquare, destSquare)) {
+		cout << "Input sqaure string entry invalid" << endl;
+		return;
+	}
+
+	// Check source and destination squares are on the board
+	if (!onBoard(sourceCol, sourceRow, destCol, destRow)) {
+		cout << "Input squares are not on the board" << endl;
+		return;
+	}	
+
+	// Check there is a piece in the source square
+	if (!currentPiece) {
+		cout << "There is no piece at position " << sourceSquare << "!" << endl;
+		return;
+	}
+
+	// Check if source and destinations squares are the same
+	if (sourceRow == destRow && sourceCol == destCol) {
+		cout << "Cannot submit move to the same square!" << endl;
+		return;
+	}
+
+	// Check that the correct colour piece is being moved for this turn	
+	if (currentPiece->getColour() != activeColour) {
+		cout << "It is not ";
+		if (activeColour == 'w') {
+			cout << "Black's ";
+		}
+		else {
+			cout << "White's ";
+		}
+		cout << "turn to move!" << endl;
+		return;
+	}
+
+	// Check that source piece and destination pieces are not the same colour 
+	// if not then set capture to true as moving to a square with opponent's piece 
+	if (destPiece) {
+		if (destPiece->getColour() == currentPiece->getColour()) {
+			cout << this->outputActiveColour() << currentPiece->outputName() << " cannot move to " << destSquare << "!" << endl;
+			return;
+		}
+		capture = true;
+	}
+
+	// Checks if piece at source square can move in line with logic
+	// and checks if move will lead to player being in check - as if it does it is illegal
+	bool valid;
+	{
+		TraceScope trace("validateMove", "board");
+		valid = moveIsValidAndNotInCheck(sourceRowNo, sourceColNo, destRowNo, destColNo, capture);
+	}
+	if (valid) {
+
+		// If move is possible and doesn't put the king in check then make the move
+		makeMove(sourceSquare, destSquare);
+	
+		// After move was made check if the move puts the opponent's King in check
+		char opponentColour = (activeColour == 'w' ? 'b' : 'w');
+		string opponent = (opponentColour == 'w' ? "White " : "Black ");
+
+		GameStatus status = gameStatus(opponentColour);
+
+		if (status == STATUS_CHECKMATE) {
+			// If opponent King in check and opponent has no response to check then checkmate
+			cout << opponent << "is in checkmate" << endl;
+			inCheckmate = true;
+			return;
+		}
+		else if (status == STATUS_CHECK) {
+			// If in check and there is a legal response then opponent is just in check
+			cout << opponent << "is in check" << endl;
+		}
+		else if (status == STATUS_STALEMATE) {
+			// If not in check and no legal response then opponent is in stalemate
+			cout << "Game is in stalemate" << endl;
+			inStalemate = true;
+			return;
+		}
+	}
+	else {
+		// Otherwise move is not valid
+		cout << this->outputActiveColour() << currentPiece->outputName()
+		 << " cannot move to " << destSquare << "!" << endl;
+	}
+
+	// At the end of the turn switch colour of active player
+	switchPlayer(activeColour);
+}
+
+// Checks that moves follows chess logic and does not put player's King in check
+bool ChessBoard::moveIsValidAndNotInCheck(int sourceRowNo, int sourceColNo, int destRowNo, int destColNo, bool capture) {
+	
+	Piece* currentPiece = board[sourceRowNo][sourceColNo];
+	char pieceColour = currentPiece->getColour();
+
+	// Check that the piece can move from source to destination according to logic
+	if (currentPiece->validMove(sourceRowNo, sourceColNo, destRowNo, destColNo, board, capture)) {
+
+		// With attack maps on, make the move on the real board and look the King up in the maps
+		if (useAttackMaps) {
+			Move move = encodeMove(squareIndex(sourceRowNo, sourceColNo), squareIndex(destRowNo, destColNo));
+			MoveUndo undo = doMove(move);
+			bool check = kingInCheck(pieceColour);
+			undoMove(move, undo);
+			return !check;
+		}
+
+		// Create a copy of the board to simulate the move
+		Piece* testBoard[8][8];
+		testMove(sourceRowNo, sourceColNo, destRowNo, destColNo, testBoard);
+
+		// See if the move will put active player's King in check
+		if(inCheck(pieceColour, testBoard)) {
+			return false;
+		}
+
+		// Move is valid logically and does not lead to check
+		return true;
+	}
+
+	// Move is not valid logically
+	return false;
+}
+
+// Moves source piece to destination square and handles capturing
+void ChessBoard::makeMove(const char* sourceSquare, const char* destSquare) {
+
+	// Create variables for source and destination row and column
+	char sourceCol = sourceSquare[0];
+	char sourceRow = sourceSquare[1];
+	char destCol = destSquare[0];
+	char destRow = destSquare[1];
+
+	// Convert characters to integer indices 0-7
+	int sourceColNo = sourceCol - 'A';
+	int sourceRowNo = '8' - sourceRow;
+	int destColNo = destCol - 'A';
+	int destRowNo = '8' - destRow;
+
+	// Piece pointers to source, destination and captured piece if relevant
+	Piece* sourcePiece = board[sourceRowNo][sourceColNo];
+	Piece* capturedPiece = nullptr;
+	
+	string capturedName;
+	string capturedColour;
+
+	// If there is a piece to be captured - handle capturing
+	if (board[destRowNo][destColNo]) {
+		// Destination piece is captured
+		capturedPiece = board[destRowNo][destColNo];		
+		capturedName = capturedPiece->outputName();
+		capturedColour = capturedPiece->outputColour();
+
+		movePiece(squareIndex(sourceRowNo, sourceColNo), squareIndex(destRowNo, destColNo)); // Move source piece
+		 
+	}
+	// Else if there is no piece to be captured, move source piece to destination square
+	else {
+		// Move source piece to destination square and make source square empty
+		movePiece(squareIndex(sourceRowNo, sourceColNo), squareIndex(destRowNo, destColNo)); // Move source piece
+	}
+
+	// Output scenarios
+	if (capturedPiece) {
+		cout << sourcePiece->outputColour() << sourcePiece->outputName()
+		 << " moves from " << sourceSquare << " to " << destSquare << " taking "
+		 << capturedColour << capturedName << endl; 
+	}
+	else {
+		cout << sourcePiece->outputColour() << sourcePiece->outputName()
+		 << " moves from " << sourceSquare << " to " << destSquare << endl;
+	}
+
+}
+
+// Checks if specified colour's King is in check by opponent's pieces
+bool ChessBoard::inCheck(char playerColour, Piece* board[8][8]) {
+
+	int kingRow;
+	int kingCol;
+
+	bool capture = true;
+
+	// Gets the coordinates of the King square
+	findKing(board, playerColour, kingRow, kingCol);
+
+	// Set opposition colour
+	char oppColour = (playerColour == 'w' ? 'b' : 'w');
+
+	// Loop through each square of the board and identify opponent's pieces
+	for (int row = 0; row < 8; row++) {
+		for (int col = 0; col < 8; col++) {
+			Piece* piece = board[row][col];
+
+			// Identify opponent's pieces
+			if (piece != NULL && piece->getColour() == oppColour) {
+				// Check if opponents piece can move towards the King
+				if (piece->validMove(row, col, kingRow, kingCol, board, capture)) {
+					// If move is possible then King is in check
+					return true;
+				}
+			}
+		}
+	}
+	// King is not in check
+	return false;
+}
+
+// Simulates a proposed move on a test board
+void ChessBoard::testMove(int sourceRow, int sourceCol, int destRow, int destCol, Piece* testBoard[8][8]) {
+
+	// Make testBoard a copy of the actual board
+	for (int row = 0; row < 8; row++) {
+		for (int col = 0; col < 8; col++) {
+			testBoard[row][col] = board[row][col];
+		}
+	}
+	// Make the simulated move on the test board
+	testBoard[destRow][destCol] = testBoard[sourceRow][sourceCol];
+	testBoard[sourceRow][sourceCol] = nullptr;
+}
+
+// Returns position of the king of a specified colour
+void ChessBoard::findKing(Piece* board[8][8], char colour, int& kingRow, int& kingCol) {
+
+	for (int row = 0; row < 8; row++) {
+		for (int col = 0; col < 8; col++) {
+			if (board[row][col]) {
+				if (colour == 'w') {
+					if (board[row][col]->getName() == 'K') {
+						kingRow = row;
+						kingCol = col;
+					}
+				}
+				if (colour == 'b') {
+					if (board[row][col]->getName() == 'k') {
+						kingRow = row;
+						kingCol = col;
+					}
+				}
+			}
+		}
+	}
+
+}
+
+// Switches active player
+void ChessBoard::switchPlayer(char colour) {
+	if (colour == 'w') {
+		this->activeColour = 'b';
+	}
+	else {
+		this->activeColour = 'w';
+	}
+	key ^= zobrist.blackToMove;
+	legalCacheValid = false;
+}
+
+// Checks input length of string is valid
+bool ChessBoard::inputLengthIsValid(const char* sourceSquare, const char* destSquare) {
+	
+	if (strlen(sourceSquare) != 2 || strlen(destSquare) != 2) {
+		return false;
+	}
+	return true;
+}
+
+// Checks square exists on the board
+bool ChessBoard::onBoard(char sourceCol, char sourceRow, char destCol, char destRow) {
+
+	if (sourceCol < 'A' || sourceCol > 'H' || 
+			sourceRow < '1' || sourceRow > '8' || 
+			destCol < 'A' || destCol > 'H' || 
+			destRow < '1' || destRow > '8') {
+			return false;
+		}
+	return true;
+}
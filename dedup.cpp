@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <queue>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Dedup.h"
+#include "ThreadPool.h"
+#include "TrainingData.h"
+
+using namespace std;
+
+/* Most records read in one batch */
+static const size_t MAX_READ_BATCH = 1 << 20;
+
+/* Slices of a batch per worker, so a slow worker does not hold up the batch */
+static const int SLICES_PER_THREAD = 4;
+
+/* Smallest buffer of each run while merging; a merge takes fewer runs at once rather than go below it */
+static const size_t MIN_MERGE_BUFFER = 1 << 16;
+
+/* Buffer for joining the parts into the output */
+static const size_t COPY_BUFFER = 1 << 22;
+
+// Spreads every input bit over the whole value (the splitmix64 finaliser)
+static uint64_t mix(uint64_t value) {
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ULL;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebULL;
+	value ^= value >> 31;
+	return value;
+}
+
+// Hash of the position a tally is for
+static uint64_t positionHash(const PositionTally& tally) {
+	uint64_t halves[2];
+	memcpy(halves, tally.pieces, sizeof(halves));
+	return mix(tally.occupied ^ mix(halves[0] ^ mix(halves[1] ^ mix(tally.sideToMove + 1))));
+}
+
+// Order of tallies in runs and in the output
+static bool tallyBefore(const PositionTally& a, const PositionTally& b) {
+	if (a.hash != b.hash) {
+		return a.hash < b.hash;
+	}
+	if (a.occupied != b.occupied) {
+		return a.occupied < b.occupied;
+	}
+	int pieces = memcmp(a.pieces, b.pieces, sizeof(a.pieces));
+	if (pieces != 0) {
+		return pieces < 0;
+	}
+	return a.sideToMove < b.sideToMove;
+}
+
+// Checks two tallies are for the same position; equal hashes alone could be a collision
+static bool samePosition(const PositionTally& a, const PositionTally& b) {
+	return a.hash == b.hash && a.occupied == b.occupied && a.sideToMove == b.sideToMove
+		&& memcmp(a.pieces, b.pieces, sizeof(a.pieces)) == 0;
+}
+
+// Adds the labels of one tally into another of the same position
+static void addTally(PositionTally& into, const PositionTally& from) {
+	into.count += from.count;
+	into.wins += from.wins;
+	into.draws += from.draws;
+	into.losses += from.losses;
+	into.minPly = min(into.minPly, from.minPly);
+	into.scoreSum += from.scoreSum;
+}
+
+// Canonical position and labels of one record, as a tally of one; an invalid record leaves a tally of none
+static void recordTally(const TrainingRecord& record, bool foldColours, PositionTally& tally) {
+
+	memset(&tally, 0, sizeof(tally));
+	if (!validTrainingRecord(record)) {
+		return;
+	}
+	bool flip = foldColours && record.sideToMove;
+	int result = (flip ? -record.result : record.result);
+
+	// The pieces are repacked, so nibbles past the last piece are always zero; a flip mirrors the rows
+	uint8_t codes[64];
+	Bitboard squares = record.occupied;
+	int index = 0;
+	while (squares) {
+		int square = popLowestSquare(squares);
+		int code = (record.pieces[index >> 1] >> ((index & 1) * 4)) & 15;
+		if (flip) {
+			square ^= 56;
+			code = (code < 6 ? code + 6 : code - 6);
+		}
+		codes[square] = code;
+		tally.occupied |= squareBit(square);
+		index++;
+	}
+
+	squares = tally.occupied;
+	index = 0;
+	while (squares) {
+		tally.pieces[index >> 1] |= codes[popLowestSquare(squares)] << ((index & 1) * 4);
+		index++;
+	}
+
+	tally.sideToMove = (flip ? 0 : record.sideToMove);
+	tally.hash = positionHash(tally);
+	tally.count = 1;
+	tally.wins = (result > 0);
+	tally.draws = (result == 0);
+	tally.losses = (result < 0);
+	tally.minPly = record.ply;
+	tally.scoreSum = (flip ? -record.score : record.score);
+}
+
+// Adds up the tallies of each position in sorted tallies, returning the new end
+static PositionTally* collapseTallies(PositionTally* begin, PositionTally* end) {
+	if (begin == end) {
+		return end;
+	}
+	PositionTally* last = begin;
+	for (PositionTally* tally = begin + 1; tally < end; tally++) {
+		if (samePosition(*last, *tally)) {
+			addTally(*last, *tally);
+		}
+		else {
+			*++last = *tally;
+		}
+	}
+	return last + 1;
+}
+
+// Sorts a slice of tallies, adds up each position's and writes the rest to a run file
+static bool writeRun(PositionTally* begin, PositionTally* end, const string& path) {
+
+	sort(begin, end, tallyBefore);
+	end = collapseTallies(begin, end);
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file) {
+		cerr << "Cannot open " << path << endl;
+		return false;
+	}
+	size_t count = end - begin;
+	bool written = fwrite(begin, sizeof(PositionTally), count, file) == count;
+	written = (fclose(file) == 0) && written;
+	if (!written) {
+		cerr << "Cannot write " << path << endl;
+	}
+	return written;
+}
+
+// Moves a run file that has not been read yet to its first tally with at least the given hash
+static bool seekToHash(FILE* run, uint64_t hash) {
+
+	int fd = fileno(run);
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		return false;
+	}
+
+	// Binary search reading only the hashes; the stream's buffer is untouched until the seek
+	uint64_t low = 0;
+	uint64_t high = info.st_size / sizeof(PositionTally);
+	while (low < high) {
+		uint64_t middle = low + (high - low) / 2;
+		uint64_t middleHash;
+		if (pread(fd, &middleHash, sizeof(middleHash), middle * sizeof(PositionTally)) != sizeof(middleHash)) {
+			return false;
+		}
+		if (middleHash < hash) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return fseeko(run, low * sizeof(PositionTally), SEEK_SET) == 0;
+}
+
+// K-way merge of the tallies with hashes from first to last of sorted runs, adding up each position's
+static bool mergeRuns(const vector<string>& runs, uint64_t first, uint64_t last, const string& outPath, size_t bufferBytes, uint64_t& written) {
+
+	written = 0;
+
+	FILE* out = fopen(outPath.c_str(), "wb");
+	if (!out) {
+		cerr << "Cannot open " << outPath << endl;
+		return false;
+	}
+	setvbuf(out, nullptr, _IOFBF, bufferBytes);
+
+	bool ok = true;
+	vector<FILE*> inputs;
+	for (const string& run : runs) {
+		FILE* in = fopen(run.c_str(), "rb");
+		if (!in) {
+			cerr << "Cannot open " << run << endl;
+			ok = false;
+			break;
+		}
+		setvbuf(in, nullptr, _IOFBF, bufferBytes);
+		inputs.push_back(in);
+		if (first > 0 && !seekToHash(in, first)) {
+			cerr << "Cannot read " << run << endl;
+			ok = false;
+			break;
+		}
+	}
+
+	// Smallest head tally of all runs at the top
+	auto after = [](const pair<PositionTally, size_t>& a, const pair<PositionTally, size_t>& b) {
+		return tallyBefore(b.first, a.first);
+	};
+	priority_queue<pair<PositionTally, size_t>, vector<pair<PositionTally, size_t>>, decltype(after)> heads(after);
+
+	PositionTally tally;
+	for (size_t i = 0; ok && i < inputs.size(); i++) {
+		if (fread(&tally, sizeof(tally), 1, inputs[i]) == 1) {
+			heads.push(make_pair(tally, i));
+		}
+	}
+
+	// The tally being added up is written once a different position comes off the heap
+	PositionTally pending;
+	bool havePending = false;
+
+	while (ok && !heads.empty()) {
+		pair<PositionTally, size_t> head = heads.top();
+		heads.pop();
+
+		// A run whose head is past the range has nothing more for this merge
+		if (head.first.hash > last) {
+			continue;
+		}
+
+		if (havePending && samePosition(pending, head.first)) {
+			addTally(pending, head.first);
+		}
+		else {
+			if (havePending) {
+				ok = fwrite(&pending, sizeof(pending), 1, out) == 1;
+				written++;
+			}
+			pending = head.first;
+			havePending = true;
+		}
+
+		if (fread(&tally, sizeof(tally), 1, inputs[head.second]) == 1) {
+			heads.push(make_pair(tally, head.second));
+		}
+	}
+	if (ok && havePending) {
+		ok = fwrite(&pending, sizeof(pending), 1, out) == 1;
+		written++;
+	}
+
+	for (FILE* in : inputs) {
+		fclose(in);
+	}
+	ok = (fclose(out) == 0) && ok;
+	if (!ok) {
+		cerr << "Cannot merge into " << outPath << endl;
+	}
+	return ok;
+}
+
+// Writes the header, then the parts one after another
+static bool joinParts(const vector<string>& parts, const string& outPath, uint64_t tallies, uint64_t records, size_t bufferBytes) {
+
+	FILE* out = fopen(outPath.c_str(), "wb");
+	if (!out) {
+		cerr << "Cannot open " << outPath << endl;
+		return false;
+	}
+
+	uint64_t header[4] = { 0, tallies, records, 0 };
+	memcpy(header, DEDUP_MAGIC, 8);
+	bool ok = fwrite(header, sizeof(header), 1, out) == 1;
+
+	vector<char> buffer(bufferBytes);
+	for (size_t i = 0; ok && i < parts.size(); i++) {
+		FILE* in = fopen(parts[i].c_str(), "rb");
+		if (!in) {
+			cerr << "Cannot open " << parts[i] << endl;
+			ok = false;
+			break;
+		}
+		size_t count;
+		while (ok && (count = fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+			ok = fwrite(buffer.data(), 1, count, out) == count;
+		}
+		fclose(in);
+	}
+
+	ok = (fclose(out) == 0) && ok;
+	if (!ok) {
+		cerr << "Cannot write " << outPath << endl;
+	}
+	return ok;
+}
+
+// Hashes batches into sorted runs on the pool, merges them down to what the memory allows, then merges a hash range per worker
+bool deduplicate(const vector<string>& inputPaths, const string& outPath, const DedupOptions& options, DedupStats& stats) {
+
+	auto start = chrono::steady_clock::now();
+	stats = DedupStats();
+
+	vector<string> files;
+	for (const string& path : inputPaths) {
+		vector<string> found;
+		if (!trainingDataFiles(path, found)) {
+			return false;
+		}
+		files.insert(files.end(), found.begin(), found.end());
+	}
+
+	ThreadPool pool(options.threads);
+	int threads = pool.size();
+	size_t memory = max(options.memoryMegabytes, (size_t)1) << 20;
+
+	// An eighth of the memory holds the records read, the rest their tallies until they are written as runs
+	size_t readBatch = min(MAX_READ_BATCH, memory / 8 / sizeof(TrainingRecord));
+	size_t capacity = (memory - readBatch * sizeof(TrainingRecord)) / sizeof(PositionTally);
+	vector<TrainingRecord> records(readBatch);
+	vector<PositionTally> tallies(capacity);
+	size_t filled = 0;
+
+	vector<string> runs;
+	atomic<bool> failed(false);
+
+	// Each worker sorts a slice of the filled tallies into a run of its own
+	auto spill = [&]() {
+		for (int slice = 0; slice < threads; slice++) {
+			size_t begin = filled * slice / threads;
+			size_t end = filled * (slice + 1) / threads;
+			if (begin == end) {
+				continue;
+			}
+			string path = outPath + ".run" + to_string(runs.size());
+			runs.push_back(path);
+			pool.submit([&, begin, end, path] {
+				if (!writeRun(&tallies[begin], &tallies[end], path)) {
+					failed = true;
+				}
+			});
+		}
+		pool.wait();
+		filled = 0;
+	};
+
+	for (size_t f = 0; f < files.size() && !failed; f++) {
+		FILE* file = fopen(files[f].c_str(), "rb");
+		if (!file) {
+			cerr << "Cannot open " << files[f] << endl;
+			failed = true;
+			break;
+		}
+
+		while (!failed) {
+			if (capacity - filled < readBatch) {
+				spill();
+			}
+			size_t count = fread(records.data(), sizeof(TrainingRecord), readBatch, file);
+			if (count == 0) {
+				break;
+			}
+
+			int slices = threads * SLICES_PER_THREAD;
+			for (int slice = 0; slice < slices; slice++) {
+				pool.submit([&, slice, count, filled] {
+					size_t end = count * (slice + 1) / slices;
+					for (size_t r = count * slice / slices; r < end; r++) {
+						recordTally(records[r], options.foldColours, tallies[filled + r]);
+					}
+				});
+			}
+			pool.wait();
+
+			// The tallies of invalid records are dropped, keeping the rest in order
+			PositionTally* end = remove_if(&tallies[filled], &tallies[filled] + count,
+				[](const PositionTally& tally) { return tally.count == 0; });
+			size_t valid = end - &tallies[filled];
+			stats.invalid += count - valid;
+			filled += valid;
+			stats.records += valid;
+		}
+
+		if (ferror(file)) {
+			cerr << "Cannot read " << files[f] << endl;
+			failed = true;
+		}
+		fclose(file);
+	}
+
+	if (!failed && filled > 0) {
+		spill();
+	}
+	stats.runs = runs.size();
+
+	// The buffers are freed so the merges have the whole memory between the workers
+	vector<TrainingRecord>().swap(records);
+	vector<PositionTally>().swap(tallies);
+
+	// Runs a worker can merge at once with MIN_MERGE_BUFFER for each and for its output
+	size_t share = memory / threads;
+	size_t fanIn = max(share / MIN_MERGE_BUFFER, (size_t)3) - 1;
+	int nextRun = runs.size();
+
+	while (!failed && runs.size() > fanIn) {
+		vector<string> merged;
+		for (size_t group = 0; group < runs.size(); group += fanIn) {
+			vector<string> groupRuns(runs.begin() + group, runs.begin() + min(group + fanIn, runs.size()));
+			string path = outPath + ".run" + to_string(nextRun++);
+			merged.push_back(path);
+
+			pool.submit([&, groupRuns, path] {
+				uint64_t written;
+				if (!mergeRuns(groupRuns, 0, UINT64_MAX, path, share / (groupRuns.size() + 1), written)) {
+					failed = true;
+				}
+				for (const string& run : groupRuns) {
+					remove(run.c_str());
+				}
+			});
+		}
+		pool.wait();
+		runs.swap(merged);
+		stats.passes++;
+	}
+
+	// Hashes are spread evenly, so equal hash ranges give the workers about equal shares
+	vector<string> parts;
+	vector<uint64_t> partTallies(threads);
+	uint64_t span = UINT64_MAX / threads;
+	uint64_t first = 0;
+
+	for (int part = 0; part < threads && !failed; part++) {
+		uint64_t last = (part == threads - 1 ? UINT64_MAX : first + span);
+		string path = outPath + ".part" + to_string(part);
+		parts.push_back(path);
+
+		pool.submit([&, part, first, last, path] {
+			if (!mergeRuns(runs, first, last, path, share / (runs.size() + 1), partTallies[part])) {
+				failed = true;
+			}
+		});
+		first = last + 1;
+	}
+	pool.wait();
+
+	for (const string& run : runs) {
+		remove(run.c_str());
+	}
+
+	for (uint64_t count : partTallies) {
+		stats.positions += count;
+	}
+	bool ok = !failed && joinParts(parts, outPath, stats.positions, stats.records, min(COPY_BUFFER, memory));
+	for (const string& part : parts) {
+		remove(part.c_str());
+	}
+
+	stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return ok;
+}
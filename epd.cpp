@@ -0,0 +1,97 @@
+#include <fstream>
+#include <sstream>
+
+#include "Epd.h"
+
+using namespace std;
+
+// Returns an opcode's operand or the default
+string EpdRecord::operation(const string& opcode, const string& missing) const {
+	auto it = operations.find(opcode);
+	return (it == operations.end() ? missing : it->second);
+}
+
+// Checks if an opcode is present
+bool EpdRecord::hasOperation(const string& opcode) const {
+	return operations.count(opcode) > 0;
+}
+
+// Splits a line into the four position fields and the opcode list
+bool parseEpdLine(const string& line, EpdRecord& record) {
+
+	istringstream stream(line);
+	string fields[4];
+
+	for (int i = 0; i < 4; i++) {
+		if (!(stream >> fields[i])) {
+			return false;
+		}
+	}
+	if (fields[0][0] == '#' || (fields[1] != "w" && fields[1] != "b")) {
+		return false;
+	}
+
+	record.fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+	record.operations.clear();
+
+	// Everything left is "opcode operand...;" groups; quoted operands may hold semicolons
+	string rest;
+	getline(stream, rest);
+
+	size_t i = 0;
+	while (i < rest.size()) {
+		while (i < rest.size() && (rest[i] == ' ' || rest[i] == '\t' || rest[i] == ';')) {
+			i++;
+		}
+		if (i >= rest.size()) {
+			break;
+		}
+
+		size_t opcodeEnd = i;
+		while (opcodeEnd < rest.size() && rest[opcodeEnd] != ' ' && rest[opcodeEnd] != ';') {
+			opcodeEnd++;
+		}
+		string opcode = rest.substr(i, opcodeEnd - i);
+
+		string operand;
+		bool quoted = false;
+		i = opcodeEnd;
+		while (i < rest.size() && (quoted || rest[i] != ';')) {
+			if (rest[i] == '"') {
+				quoted = !quoted;
+			}
+			else {
+				operand += rest[i];
+			}
+			i++;
+		}
+
+		// Trim the spaces around the operand
+		size_t first = operand.find_first_not_of(' ');
+		size_t last = operand.find_last_not_of(' ');
+		record.operations[opcode] = (first == string::npos ? "" : operand.substr(first, last - first + 1));
+	}
+
+	return true;
+}
+
+// Reads all the positions in a file
+bool readEpdFile(const string& path, vector<EpdRecord>& records) {
+
+	ifstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	string line;
+	int lineNo = 0;
+	while (getline(file, line)) {
+		lineNo++;
+		EpdRecord record;
+		if (parseEpdLine(line, record)) {
+			record.lineNo = lineNo;
+			records.push_back(record);
+		}
+	}
+	return true;
+}
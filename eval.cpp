@@ -0,0 +1,179 @@
+#include "Evaluation.h"
+#include "Geometry.h"
+
+using namespace std;
+
+/*
+ * Piece-square bonuses for White in centipawns, indexed by square, so each table
+ * reads like the board from White's side with rank 8 at the top. Black uses the
+ * same tables with the ranks flipped.
+ */
+const int pieceSquare[6][64] = {
+	// King: stay behind the pawns
+	{
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-20, -30, -30, -40, -40, -30, -30, -20,
+		-10, -20, -20, -20, -20, -20, -20, -10,
+		 20,  20,   0,   0,   0,   0,  20,  20,
+		 20,  30,  10,   0,   0,  10,  30,  20
+	},
+	// Queen
+	{
+		-20, -10, -10,  -5,  -5, -10, -10, -20,
+		-10,   0,   0,   0,   0,   0,   0, -10,
+		-10,   0,   5,   5,   5,   5,   0, -10,
+		 -5,   0,   5,   5,   5,   5,   0,  -5,
+		  0,   0,   5,   5,   5,   5,   0,  -5,
+		-10,   5,   5,   5,   5,   5,   0, -10,
+		-10,   0,   5,   0,   0,   0,   0, -10,
+		-20, -10, -10,  -5,  -5, -10, -10, -20
+	},
+	// Bishop
+	{
+		-20, -10, -10, -10, -10, -10, -10, -20,
+		-10,   0,   0,   0,   0,   0,   0, -10,
+		-10,   0,   5,  10,  10,   5,   0, -10,
+		-10,   5,   5,  10,  10,   5,   5, -10,
+		-10,   0,  10,  10,  10,  10,   0, -10,
+		-10,  10,  10,  10,  10,  10,  10, -10,
+		-10,   5,   0,   0,   0,   0,   5, -10,
+		-20, -10, -10, -10, -10, -10, -10, -20
+	},
+	// Rook
+	{
+		  0,   0,   0,   0,   0,   0,   0,   0,
+		  5,  10,  10,  10,  10,  10,  10,   5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		  0,   0,   0,   5,   5,   0,   0,   0
+	},
+	// Knight: centralise
+	{
+		-50, -40, -30, -30, -30, -30, -40, -50,
+		-40, -20,   0,   0,   0,   0, -20, -40,
+		-30,   0,  10,  15,  15,  10,   0, -30,
+		-30,   5,  15,  20,  20,  15,   5, -30,
+		-30,   0,  15,  20,  20,  15,   0, -30,
+		-30,   5,  10,  15,  15,  10,   5, -30,
+		-40, -20,   0,   5,   5,   0, -20, -40,
+		-50, -40, -30, -30, -30, -30, -40, -50
+	},
+	// Pawn: advance, keep the centre pawns moving
+	{
+		  0,   0,   0,   0,   0,   0,   0,   0,
+		 50,  50,  50,  50,  50,  50,  50,  50,
+		 10,  10,  20,  30,  30,  20,  10,  10,
+		  5,   5,  10,  25,  25,  10,   5,   5,
+		  0,   0,   0,  20,  20,   0,   0,   0,
+		  5,  -5, -10,   0,   0, -10,  -5,   5,
+		  5,  10,  10, -20, -20,  10,  10,   5,
+		  0,   0,   0,   0,   0,   0,   0,   0
+	}
+};
+
+// Adds the pawn structure terms of one colour to the counts, with sign +1 for White and -1 for Black
+static void addPawnTerms(Bitboard ours, Bitboard theirs, int us, int sign, PawnTermCounts& counts) {
+
+	// White pawns advance towards row 0 (north), Black pawns towards row 7
+	RayDirection forward = (us == 0 ? RAY_NORTH : RAY_SOUTH);
+	RayDirection backward = (us == 0 ? RAY_SOUTH : RAY_NORTH);
+
+	Bitboard pawns = ours;
+
+	while (pawns) {
+		int square = popLowestSquare(pawns);
+		int col = squareCol(square);
+
+		Bitboard ahead = geometry.rays[forward][square];
+		Bitboard adjacentAhead = 0;
+		Bitboard adjacentBehind = 0;
+		if (col > 0) {
+			adjacentAhead |= geometry.rays[forward][square - 1];
+			adjacentBehind |= geometry.rays[backward][square - 1] | squareBit(square - 1);
+		}
+		if (col < 7) {
+			adjacentAhead |= geometry.rays[forward][square + 1];
+			adjacentBehind |= geometry.rays[backward][square + 1] | squareBit(square + 1);
+		}
+
+		// Only pawns with another behind them are counted, so two pawns on a file cost one penalty
+		if (geometry.rays[backward][square] & ours) {
+			counts.doubled += sign;
+		}
+
+		if (!((adjacentAhead | adjacentBehind) & ours)) {
+			counts.isolated += sign;
+		}
+		else if (!(adjacentBehind & ours) && ahead) {
+			// No pawn can come up to support it and an enemy pawn controls the square in front
+			int stop = square + (us == 0 ? -8 : 8);
+			if (geometry.pawn[us][stop] & theirs) {
+				counts.backward += sign;
+			}
+		}
+
+		if (!((ahead | adjacentAhead) & theirs)) {
+			counts.passed[us == 0 ? 7 - squareRow(square) : squareRow(square)] += sign;
+		}
+	}
+}
+
+// White's pawn structure terms minus Black's
+void countPawnTerms(const ChessBoard& cb, PawnTermCounts& counts) {
+	counts = PawnTermCounts();
+	Bitboard white = cb.getPieces('w', PAWN);
+	Bitboard black = cb.getPieces('b', PAWN);
+	addPawnTerms(white, black, 0, 1, counts);
+	addPawnTerms(black, white, 1, -1, counts);
+}
+
+// Pawn structure score from White's side
+int pawnStructure(const ChessBoard& cb) {
+
+	PawnTermCounts counts;
+	countPawnTerms(cb, counts);
+
+	int score = DOUBLED_PAWN * counts.doubled + ISOLATED_PAWN * counts.isolated + BACKWARD_PAWN * counts.backward;
+	for (int rank = 0; rank < 8; rank++) {
+		score += passedPawn[rank] * counts.passed[rank];
+	}
+	return score;
+}
+
+// Material, piece-square and pawn structure score from the active player's side
+int evaluate(const ChessBoard& cb, ScoreCache* pawnCache) {
+
+	int score = 0;
+
+	for (int type = 0; type < 6; type++) {
+		Bitboard white = cb.getPieces('w', (PieceType)type);
+		Bitboard black = cb.getPieces('b', (PieceType)type);
+
+		score += pieceValues[type] * (popCount(white) - popCount(black));
+
+		while (white) {
+			score += pieceSquare[type][popLowestSquare(white)];
+		}
+		// Flipping the row (square ^ 56) reads the table from Black's side
+		while (black) {
+			score -= pieceSquare[type][popLowestSquare(black) ^ 56];
+		}
+	}
+
+	int pawns;
+	if (!pawnCache || !pawnCache->probe(cb.getPawnKey(), pawns)) {
+		pawns = pawnStructure(cb);
+		if (pawnCache) {
+			pawnCache->store(cb.getPawnKey(), pawns);
+		}
+	}
+	score += pawns;
+
+	return (cb.getActiveColour() == 'w' ? score : -score);
+}
@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <queue>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ChessBoard.h"
+#include "GameIndex.h"
+#include "Notation.h"
+#include "Pgn.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+static const char* startPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq";
+
+/* Games handed to a worker at a time */
+static const size_t BATCH_GAMES = 256;
+
+/* Buffer of each run file while merging */
+static const size_t MERGE_BUFFER = 1 << 18;
+
+/* Interpolation steps before the lookup falls back to binary search, in case the keys are unevenly spread */
+static const int INTERPOLATION_STEPS = 4;
+
+// Order of entries in the index
+static bool entryBefore(const IndexEntry& a, const IndexEntry& b) {
+	if (a.key != b.key) {
+		return a.key < b.key;
+	}
+	if (a.game != b.game) {
+		return a.game < b.game;
+	}
+	return a.ply < b.ply;
+}
+
+// Replays one game, adding the first ply each position was reached at
+static bool replayGame(const PgnGame& game, uint32_t id, int maxPly, vector<IndexEntry>& entries) {
+
+	ChessBoard cb;
+	if (!cb.setPosition(game.tag("FEN", startPosition).c_str())) {
+		return false;
+	}
+
+	size_t first = entries.size();
+	bool legal = true;
+	int plies = (int)game.moves.size();
+	if (maxPly > 0 && plies > maxPly) {
+		plies = maxPly;
+	}
+
+	IndexEntry entry;
+	entry.game = id;
+	entry.reserved = 0;
+
+	for (int ply = 0; ; ply++) {
+		entry.key = cb.getKey();
+		entry.ply = (uint16_t)ply;
+		entries.push_back(entry);
+
+		if (ply == plies) {
+			break;
+		}
+		Move move = parseMove(cb, game.moves[ply]);
+		if (move == NO_MOVE) {
+			legal = false;
+			break;
+		}
+		cb.doMove(move);
+	}
+
+	// A position repeated within the game is only listed at its first ply
+	sort(entries.begin() + first, entries.end(), entryBefore);
+	entries.erase(unique(entries.begin() + first, entries.end(),
+		[](const IndexEntry& a, const IndexEntry& b) { return a.key == b.key; }), entries.end());
+
+	return legal;
+}
+
+// Sorts a buffer and writes it to a run file
+static bool writeRun(vector<IndexEntry>& entries, const string& path) {
+
+	sort(entries.begin(), entries.end(), entryBefore);
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file) {
+		cerr << "Cannot open " << path << endl;
+		return false;
+	}
+	bool written = fwrite(entries.data(), sizeof(IndexEntry), entries.size(), file) == entries.size();
+	written = (fclose(file) == 0) && written;
+	if (!written) {
+		cerr << "Cannot write " << path << endl;
+	}
+
+	entries.clear();
+	return written;
+}
+
+// K-way merge of the sorted runs into the index file, followed by the game offsets
+static bool mergeRuns(const vector<string>& runs, const vector<uint64_t>& offsets, const string& indexPath, uint64_t& entryCount) {
+
+	FILE* out = fopen(indexPath.c_str(), "wb");
+	if (!out) {
+		cerr << "Cannot open " << indexPath << endl;
+		return false;
+	}
+	setvbuf(out, nullptr, _IOFBF, 1 << 22);
+
+	// The header is written again at the end, once the entry count is known
+	uint64_t header[4] = { 0, 0, offsets.size(), 0 };
+	memcpy(header, GAMEINDEX_MAGIC, 8);
+	bool ok = fwrite(header, sizeof(header), 1, out) == 1;
+
+	vector<FILE*> inputs;
+	for (const string& run : runs) {
+		FILE* in = fopen(run.c_str(), "rb");
+		if (!in) {
+			cerr << "Cannot open " << run << endl;
+			ok = false;
+			break;
+		}
+		setvbuf(in, nullptr, _IOFBF, MERGE_BUFFER);
+		inputs.push_back(in);
+	}
+
+	// Smallest head entry of all runs at the top
+	auto after = [](const pair<IndexEntry, size_t>& a, const pair<IndexEntry, size_t>& b) {
+		return entryBefore(b.first, a.first);
+	};
+	priority_queue<pair<IndexEntry, size_t>, vector<pair<IndexEntry, size_t>>, decltype(after)> heads(after);
+
+	IndexEntry entry;
+	for (size_t i = 0; ok && i < inputs.size(); i++) {
+		if (fread(&entry, sizeof(entry), 1, inputs[i]) == 1) {
+			heads.push(make_pair(entry, i));
+		}
+	}
+
+	entryCount = 0;
+	while (ok && !heads.empty()) {
+		pair<IndexEntry, size_t> head = heads.top();
+		heads.pop();
+		ok = fwrite(&head.first, sizeof(IndexEntry), 1, out) == 1;
+		entryCount++;
+		if (fread(&entry, sizeof(entry), 1, inputs[head.second]) == 1) {
+			heads.push(make_pair(entry, head.second));
+		}
+	}
+
+	for (FILE* in : inputs) {
+		fclose(in);
+	}
+
+	ok = ok && fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), out) == offsets.size();
+
+	header[1] = entryCount;
+	ok = ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(header, sizeof(header), 1, out) == 1;
+	ok = (fclose(out) == 0) && ok;
+
+	if (!ok) {
+		cerr << "Cannot write " << indexPath << endl;
+	}
+	return ok;
+}
+
+// Reads games on this thread, replays them on the pool, then merges the runs the workers wrote
+bool buildGameIndex(const string& pgnPath, const string& indexPath, const IndexOptions& options, IndexBuildStats& stats) {
+
+	auto start = chrono::steady_clock::now();
+	stats = IndexBuildStats();
+
+	ifstream file(pgnPath);
+	if (!file) {
+		cerr << "Cannot open " << pgnPath << endl;
+		return false;
+	}
+
+	ThreadPool pool(options.threads);
+
+	// Each worker fills its own buffer; its share of the memory budget decides the run length
+	size_t runEntries = options.memoryMegabytes * (1 << 20) / sizeof(IndexEntry) / pool.size();
+	if (runEntries < 4096) {
+		runEntries = 4096;
+	}
+	vector<vector<IndexEntry>> buffers(pool.size());
+
+	mutex lock;
+	condition_variable batchDone;
+	int batchesInFlight = 0;
+	vector<string> runs;
+	atomic<uint64_t> badGames(0);
+	atomic<bool> failed(false);
+
+	// Sorts a full buffer into a new run file
+	auto spill = [&](vector<IndexEntry>& buffer) {
+		string path;
+		{
+			lock_guard<mutex> guard(lock);
+			path = indexPath + ".run" + to_string(runs.size());
+			runs.push_back(path);
+		}
+		if (!writeRun(buffer, path)) {
+			failed = true;
+		}
+	};
+
+	vector<uint64_t> offsets;
+	PgnReader reader(file);
+	vector<PgnGame> batch;
+	uint32_t firstId = 0;
+	PgnGame game;
+
+	while (!failed) {
+		bool more = reader.next(game);
+		if (more) {
+			offsets.push_back(reader.getOffset());
+			batch.push_back(game);
+		}
+		if (batch.size() < BATCH_GAMES && (more || batch.empty())) {
+			if (!more) {
+				break;
+			}
+			continue;
+		}
+
+		// Keep only a few batches waiting so a large file is never read far ahead of the workers
+		{
+			unique_lock<mutex> guard(lock);
+			batchDone.wait(guard, [&] { return batchesInFlight < 2 * pool.size(); });
+			batchesInFlight++;
+		}
+
+		auto games = make_shared<vector<PgnGame>>();
+		games->swap(batch);
+		uint32_t id = firstId;
+		firstId += games->size();
+
+		pool.submit([&, games, id] {
+			vector<IndexEntry>& buffer = buffers[ThreadPool::workerIndex()];
+			for (size_t g = 0; g < games->size(); g++) {
+				if (buffer.capacity() < runEntries) {
+					buffer.reserve(runEntries);
+				}
+				if (!replayGame((*games)[g], id + g, options.maxPly, buffer)) {
+					badGames++;
+				}
+				if (buffer.size() >= runEntries - 1024) {
+					spill(buffer);
+				}
+			}
+
+			lock_guard<mutex> guard(lock);
+			batchesInFlight--;
+			batchDone.notify_one();
+		});
+
+		if (!more) {
+			break;
+		}
+	}
+
+	pool.wait();
+	for (vector<IndexEntry>& buffer : buffers) {
+		if (!buffer.empty()) {
+			spill(buffer);
+		}
+		vector<IndexEntry>().swap(buffer);
+	}
+
+	bool ok = !failed && mergeRuns(runs, offsets, indexPath, stats.entries);
+	for (const string& run : runs) {
+		remove(run.c_str());
+	}
+
+	stats.games = offsets.size();
+	stats.badGames = badGames;
+	stats.runs = runs.size();
+	stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return ok;
+}
+
+// GameIndex class implementation
+
+/* GameIndex constructor */
+GameIndex::GameIndex() {
+	mapping = nullptr;
+	mappingSize = 0;
+	entries = nullptr;
+	offsets = nullptr;
+	entryCount = 0;
+	gameCount = 0;
+}
+
+/* GameIndex destructor */
+GameIndex::~GameIndex() {
+	close();
+}
+
+// Maps the file and checks the header against its size
+bool GameIndex::open(const string& path) {
+
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		cerr << "Cannot open " << path << endl;
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size < 32) {
+		cerr << path << " is not an index file" << endl;
+		::close(fd);
+		return false;
+	}
+
+	void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		cerr << "Cannot map " << path << endl;
+		return false;
+	}
+
+	const uint64_t* header = (const uint64_t*)data;
+	uint64_t size = info.st_size;
+	if (memcmp(header, GAMEINDEX_MAGIC, 8) != 0 || 32 + header[1] * sizeof(IndexEntry) + header[2] * sizeof(uint64_t) != size) {
+		cerr << path << " is not an index file" << endl;
+		munmap(data, info.st_size);
+		return false;
+	}
+
+	mapping = data;
+	mappingSize = info.st_size;
+	entryCount = header[1];
+	gameCount = header[2];
+	entries = (const IndexEntry*)(header + 4);
+	offsets = (const uint64_t*)(entries + entryCount);
+	return true;
+}
+
+// Unmaps the file
+void GameIndex::close() {
+	if (mapping) {
+		munmap(mapping, mappingSize);
+	}
+	mapping = nullptr;
+	mappingSize = 0;
+	entries = nullptr;
+	offsets = nullptr;
+	entryCount = 0;
+	gameCount = 0;
+}
+
+// Interpolation search narrows the range while it is large, binary search finishes it
+int GameIndex::lookup(uint64_t key, vector<IndexEntry>& found) const {
+
+	found.clear();
+
+	// Invariant: entries before low have keys up to lowKey (< key), entries from high on have keys from highKey (>= key)
+	uint64_t low = 0;
+	uint64_t high = entryCount;
+	uint64_t lowKey = 0;
+	uint64_t highKey = UINT64_MAX;
+	int probes = 0;
+
+	if (key == 0) {
+		high = 0;
+	}
+
+	for (int step = 0; step < INTERPOLATION_STEPS && high - low > 16; step++) {
+
+		uint64_t range = high - low;
+		uint64_t guess = low + (uint64_t)((long double)(key - lowKey) / ((long double)highKey - lowKey) * range);
+		guess = min(guess, high - 1);
+		probes++;
+
+		// A guess into evenly spread keys misses by about sqrt(range) / 2, nearly always to one side; a step of
+		// that size the other way usually brackets the key from both sides, doubling if it does not
+		uint64_t stride = max((uint64_t)sqrt((double)range) / 2, (uint64_t)4);
+		if (entries[guess].key < key) {
+			low = guess + 1;
+			lowKey = entries[guess].key;
+			for (uint64_t next = guess + stride; next < high; stride *= 2, next = guess + stride) {
+				probes++;
+				if (entries[next].key >= key) {
+					high = next;
+					highKey = entries[next].key;
+					break;
+				}
+				low = next + 1;
+				lowKey = entries[next].key;
+			}
+		}
+		else {
+			high = guess;
+			highKey = entries[guess].key;
+			for (; guess >= low + stride; stride *= 2) {
+				uint64_t next = guess - stride;
+				probes++;
+				if (entries[next].key < key) {
+					low = next + 1;
+					lowKey = entries[next].key;
+					break;
+				}
+				high = next;
+				highKey = entries[next].key;
+			}
+		}
+	}
+
+	const IndexEntry* first = lower_bound(entries + low, entries + high, key,
+		[](const IndexEntry& entry, uint64_t value) { return entry.key < value; });
+	while (first < entries + entryCount && first->key == key) {
+		found.push_back(*first);
+		first++;
+		probes++;
+	}
+	return probes + 1;
+}
+
+// Byte offset of a game in the PGN file
+uint64_t GameIndex::gameOffset(uint32_t game) const {
+	return (game < gameCount ? offsets[game] : 0);
+}
+
+// Number of entries
+uint64_t GameIndex::getEntries() const {
+	return entryCount;
+}
+
+// Number of games
+uint64_t GameIndex::getGames() const {
+	return gameCount;
+}
@@ -0,0 +1,198 @@
+#include <cctype>
+#include <cstdio>
+#include <sstream>
+
+#include "Json.h"
+#include "Notation.h"
+
+using namespace std;
+
+// Quotes a string for JSON
+string jsonString(const string& text) {
+	string quoted = "\"";
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			quoted += '\\';
+			quoted += c;
+		}
+		else if ((unsigned char)c < 0x20) {
+			char escape[8];
+			snprintf(escape, sizeof(escape), "\\u%04x", c);
+			quoted += escape;
+		}
+		else {
+			quoted += c;
+		}
+	}
+	return quoted + "\"";
+}
+
+// Skips white space
+static void skipSpace(const string& text, size_t& i) {
+	while (i < text.size() && isspace((unsigned char)text[i])) {
+		i++;
+	}
+}
+
+// Reads a quoted string starting at text[i], leaving i after the closing quote
+static bool readString(const string& text, size_t& i, string& value) {
+
+	value.clear();
+	if (i >= text.size() || text[i] != '"') {
+		return false;
+	}
+	i++;
+
+	while (i < text.size() && text[i] != '"') {
+		char c = text[i++];
+		if (c != '\\') {
+			value += c;
+			continue;
+		}
+		if (i >= text.size()) {
+			return false;
+		}
+		char escaped = text[i++];
+		switch (escaped) {
+			case 'n': value += '\n'; break;
+			case 't': value += '\t'; break;
+			case 'r': value += '\r'; break;
+			case 'b': value += '\b'; break;
+			case 'f': value += '\f'; break;
+			case 'u':
+				// Only the ASCII range is kept; anything else becomes '?'
+				if (i + 4 > text.size()) {
+					return false;
+				}
+				{
+					unsigned code = strtoul(text.substr(i, 4).c_str(), nullptr, 16);
+					value += (code < 0x80 ? (char)code : '?');
+				}
+				i += 4;
+				break;
+			default: value += escaped; break;
+		}
+	}
+
+	if (i >= text.size()) {
+		return false;
+	}
+	i++;
+	return true;
+}
+
+// Members are read in turn as "name": value, separated by commas
+bool parseJsonObject(const string& text, map<string, string>& fields) {
+
+	fields.clear();
+	size_t i = 0;
+	skipSpace(text, i);
+	if (i >= text.size() || text[i] != '{') {
+		return false;
+	}
+	i++;
+	skipSpace(text, i);
+
+	if (i < text.size() && text[i] == '}') {
+		i++;
+	}
+	else {
+		while (true) {
+			string name;
+			string value;
+			skipSpace(text, i);
+			if (!readString(text, i, name)) {
+				return false;
+			}
+			skipSpace(text, i);
+			if (i >= text.size() || text[i] != ':') {
+				return false;
+			}
+			i++;
+			skipSpace(text, i);
+
+			if (i < text.size() && text[i] == '"') {
+				if (!readString(text, i, value)) {
+					return false;
+				}
+			}
+			else {
+				size_t end = text.find_first_of(",}", i);
+				if (end == string::npos) {
+					return false;
+				}
+				value = text.substr(i, end - i);
+				while (!value.empty() && isspace((unsigned char)value.back())) {
+					value.pop_back();
+				}
+				if (value.empty() || value[0] == '{' || value[0] == '[') {
+					return false;
+				}
+				i = end;
+			}
+			fields[name] = value;
+
+			skipSpace(text, i);
+			if (i < text.size() && text[i] == ',') {
+				i++;
+				continue;
+			}
+			if (i < text.size() && text[i] == '}') {
+				i++;
+				break;
+			}
+			return false;
+		}
+	}
+
+	skipSpace(text, i);
+	return i == text.size();
+}
+
+// A search score as a JSON object
+string scoreJson(int score) {
+	if (score > MATE_BOUND) {
+		return "{\"mate\":" + to_string((MATE_SCORE - score + 1) / 2) + "}";
+	}
+	if (score < -MATE_BOUND) {
+		return "{\"mate\":" + to_string(-(MATE_SCORE + score) / 2) + "}";
+	}
+	return "{\"cp\":" + to_string(score) + "}";
+}
+
+// The lines of a multi-PV search as a JSON array
+string linesJson(const ChessBoard& cb, const vector<PVLine>& lines) {
+	ostringstream json;
+	json << "[";
+	for (size_t i = 0; i < lines.size(); i++) {
+		vector<string> pv = lineToSan(cb, lines[i].pv);
+		json << (i > 0 ? "," : "") << "{\"move\":" << jsonString(pv[0]) << ",\"score\":" << scoreJson(lines[i].score)
+			<< ",\"depth\":" << lines[i].depth << ",\"pv\":[";
+		for (size_t m = 0; m < pv.size(); m++) {
+			json << (m > 0 ? "," : "") << jsonString(pv[m]);
+		}
+		json << "]}";
+	}
+	json << "]";
+	return json.str();
+}
+
+// The members describing a search result
+string resultJson(const ChessBoard& cb, const SearchResult& result) {
+
+	ostringstream json;
+	json << "\"depth\":" << result.depth << ",\"score\":" << scoreJson(result.score)
+		<< ",\"bestmove\":" << (result.bestMove == NO_MOVE ? "null" : jsonString(moveToSan(cb, result.bestMove)));
+
+	vector<string> pv = lineToSan(cb, result.pv);
+	json << ",\"pv\":[";
+	for (size_t i = 0; i < pv.size(); i++) {
+		json << (i > 0 ? "," : "") << jsonString(pv[i]);
+	}
+	json << "]";
+
+	if (result.lines.size() > 1) {
+		json << ",\"lines\":" << linesJson(cb, result.lines);
+	}
+	return json.str();
+}
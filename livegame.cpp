@@ -0,0 +1,188 @@
+#include "LiveGame.h"
+
+using namespace std;
+
+static const char* startPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq";
+
+// GameSnapshot implementation
+
+// Decodes the 4 bit code of a square
+char GameSnapshot::pieceAt(int square) const {
+	int code = (position.squares[square >> 1] >> ((square & 1) * 4)) & 15;
+	return code == 0 ? 0 : "KQBRNPkqbrnp"[code - 1];
+}
+
+// Returns the side to move
+char GameSnapshot::getActiveColour() const {
+	return position.activeColour;
+}
+
+
+// LiveGame class implementation
+
+/* LiveGame constructor */
+LiveGame::LiveGame() {
+
+	current = nullptr;
+	epoch = 1;
+	readers = nullptr;
+
+	lock_guard<mutex> hold(writeLock);
+	board.setPosition(startPosition);
+	moves = 0;
+	publish(NO_MOVE);
+}
+
+/* LiveGame destructor */
+LiveGame::~LiveGame() {
+
+	for (const Retired& r : retired) {
+		delete r.snapshot;
+	}
+	delete current.load();
+
+	ReaderSlot* slot = readers.load();
+	while (slot) {
+		ReaderSlot* next = slot->next;
+		delete slot;
+		slot = next;
+	}
+}
+
+// Loads a new position and publishes it; an invalid one leaves the game as it was
+bool LiveGame::loadState(const char* boardState) {
+
+	lock_guard<mutex> hold(writeLock);
+	if (!board.setPosition(boardState)) {
+		return false;
+	}
+	moves = 0;
+	publish(NO_MOVE);
+	return true;
+}
+
+// Submits a move with the board's messages. A refused move can still pass the turn, which is published too
+bool LiveGame::submitMove(const char* sourceSquare, const char* destSquare) {
+
+	lock_guard<mutex> hold(writeLock);
+
+	int source = parseSquare(sourceSquare);
+	int dest = parseSquare(destSquare);
+	Move move = encodeMove(source, dest);
+	bool legal = (source >= 0 && dest >= 0 && source != dest && board.isLegalMove(move));
+
+	uint64_t before = board.getKey();
+	board.submitMove(sourceSquare, destSquare);
+	if (board.getKey() == before) {
+		return false;
+	}
+
+	if (legal) {
+		moves++;
+	}
+	publish(legal ? move : current.load()->lastMove);
+	return legal;
+}
+
+// Makes an encoded move quietly
+bool LiveGame::playMove(Move move) {
+
+	lock_guard<mutex> hold(writeLock);
+	if (!board.isLegalMove(move)) {
+		return false;
+	}
+
+	board.applyMove(move);
+	moves++;
+	publish(move);
+	return true;
+}
+
+// Counts the retired snapshots not yet freed
+size_t LiveGame::pendingSnapshots() {
+	lock_guard<mutex> hold(writeLock);
+	return retired.size();
+}
+
+// Swaps in a snapshot of the board and retires the old one under the epoch it was replaced in
+void LiveGame::publish(Move lastMove) {
+
+	GameSnapshot* snapshot = new GameSnapshot;
+	board.packState(snapshot->position);
+	snapshot->key = board.getKey();
+	snapshot->status = board.gameStatus(board.getActiveColour());
+	snapshot->moves = moves;
+	snapshot->lastMove = lastMove;
+
+	const GameSnapshot* old = current.exchange(snapshot);
+	if (old) {
+		retired.push_back({ old, epoch.fetch_add(1) });
+	}
+	reclaim();
+}
+
+// Frees what no reader can hold: a reader that entered after a snapshot was replaced loaded its successor
+void LiveGame::reclaim() {
+
+	uint64_t oldest = UINT64_MAX;
+	for (ReaderSlot* slot = readers.load(); slot; slot = slot->next) {
+		uint64_t entered = slot->epoch.load();
+		if (entered != 0 && entered < oldest) {
+			oldest = entered;
+		}
+	}
+
+	size_t kept = 0;
+	for (const Retired& r : retired) {
+		if (r.epoch < oldest) {
+			delete r.snapshot;
+		} else {
+			retired[kept++] = r;
+		}
+	}
+	retired.resize(kept);
+}
+
+// Reuses a slot given back by an earlier reader, or pushes a new one onto the list
+ReaderSlot* LiveGame::claimSlot() {
+
+	for (ReaderSlot* slot = readers.load(); slot; slot = slot->next) {
+		bool expected = false;
+		if (!slot->inUse.load() && slot->inUse.compare_exchange_strong(expected, true)) {
+			return slot;
+		}
+	}
+
+	ReaderSlot* slot = new ReaderSlot;
+	slot->epoch = 0;
+	slot->inUse = true;
+	slot->next = readers.load();
+	while (!readers.compare_exchange_weak(slot->next, slot)) {
+	}
+	return slot;
+}
+
+
+// SnapshotReader class implementation
+
+/* SnapshotReader constructor */
+SnapshotReader::SnapshotReader(LiveGame& game) : game(game) {
+	slot = game.claimSlot();
+}
+
+/* SnapshotReader destructor */
+SnapshotReader::~SnapshotReader() {
+	release();
+	slot->inUse = false;
+}
+
+// Announces the epoch before loading the pointer, so the writer either sees the announcement or has already swapped
+const GameSnapshot* SnapshotReader::acquire() {
+	slot->epoch.store(game.epoch.load());
+	return game.current.load();
+}
+
+// Leaves the epoch
+void SnapshotReader::release() {
+	slot->epoch.store(0);
+}
@@ -0,0 +1,287 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+#include "Match.h"
+#include "Notation.h"
+
+using namespace std;
+
+// Reads an on/off setting
+static bool parseSwitch(const string& value, bool& setting) {
+	if (value == "on" || value == "1" || value == "true") {
+		setting = true;
+		return true;
+	}
+	if (value == "off" || value == "0" || value == "false") {
+		setting = false;
+		return true;
+	}
+	return false;
+}
+
+// Splits the spec at commas, then each pair at '='
+bool parseEngineConfig(const string& spec, EngineConfig& config) {
+
+	istringstream stream(spec);
+	string pair;
+
+	while (getline(stream, pair, ',')) {
+		size_t equals = pair.find('=');
+		if (equals == string::npos) {
+			return false;
+		}
+		string key = pair.substr(0, equals);
+		string value = pair.substr(equals + 1);
+
+		if (key == "name") {
+			config.name = value;
+		}
+		else if (key == "hash") {
+			config.hashMegabytes = strtoul(value.c_str(), nullptr, 10);
+		}
+		else if (key == "qsearch") {
+			if (!parseSwitch(value, config.quiescence)) {
+				return false;
+			}
+		}
+		else if (key == "ordering") {
+			if (!parseSwitch(value, config.ordering)) {
+				return false;
+			}
+		}
+		else if (key == "depth") {
+			config.depth = atoi(value.c_str());
+		}
+		else if (key == "nodes") {
+			config.nodes = strtoull(value.c_str(), nullptr, 10);
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Checks for bare Kings, or King and one minor piece against King
+static bool insufficientMaterial(const ChessBoard& cb) {
+
+	Bitboard heavy = cb.getPieces('w', QUEEN) | cb.getPieces('b', QUEEN) | cb.getPieces('w', ROOK) | cb.getPieces('b', ROOK)
+		| cb.getPieces('w', PAWN) | cb.getPieces('b', PAWN);
+	Bitboard minors = cb.getPieces('w', BISHOP) | cb.getPieces('b', BISHOP) | cb.getPieces('w', KNIGHT) | cb.getPieces('b', KNIGHT);
+
+	return !heavy && popCount(minors) <= 1;
+}
+
+// Alternates searches between the two sides until the game is decided
+PlayedGame playGame(const string& fen, Searcher* engines[2], const EngineConfig* configs[2], const TimeControl& tc, int maxPlies) {
+
+	PlayedGame game;
+	game.fen = fen;
+	game.outcome = DRAW;
+
+	ChessBoard cb;
+	if (!cb.setPosition(fen.c_str())) {
+		game.termination = "invalid position";
+		return game;
+	}
+
+	for (int side = 0; side < 2; side++) {
+		engines[side]->clear();
+		engines[side]->setQuiescence(configs[side]->quiescence);
+		engines[side]->setMoveOrdering(configs[side]->ordering);
+	}
+
+	double clocks[2] = { tc.timeLeft, tc.timeLeft };
+
+	// Keys since the last capture or pawn move, the only positions that can repeat
+	vector<uint64_t> keys(1, cb.getKey());
+
+	while (true) {
+		char colour = cb.getActiveColour();
+		int side = colourIndex(colour);
+
+		GameStatus status = cb.gameStatus(colour);
+		if (status == STATUS_CHECKMATE) {
+			game.outcome = (colour == 'w' ? BLACK_WINS : WHITE_WINS);
+			game.termination = "checkmate";
+			return game;
+		}
+		if (status == STATUS_STALEMATE) {
+			game.termination = "stalemate";
+			return game;
+		}
+		if (insufficientMaterial(cb)) {
+			game.termination = "insufficient material";
+			return game;
+		}
+		if (keys.size() > 100) {
+			game.termination = "fifty-move rule";
+			return game;
+		}
+		if ((int)game.moves.size() >= maxPlies) {
+			game.termination = "adjudication";
+			return game;
+		}
+
+		TimeControl moveTc = tc;
+		moveTc.timeLeft = clocks[side];
+		TimeManager timer(moveTc);
+
+		SearchLimits limits;
+		limits.depth = configs[side]->depth;
+		limits.nodes = configs[side]->nodes;
+		limits.time = (tc.moveTime > 0 || tc.timeLeft > 0 ? &timer : nullptr);
+
+		SearchResult result = engines[side]->search(cb, limits);
+		double spent = timer.elapsed();
+
+		if (tc.moveTime <= 0 && tc.timeLeft > 0) {
+			clocks[side] -= spent;
+			if (clocks[side] < 0) {
+				game.outcome = (colour == 'w' ? BLACK_WINS : WHITE_WINS);
+				game.termination = "time forfeit";
+				return game;
+			}
+			clocks[side] += tc.increment;
+		}
+
+		Move move = result.bestMove;
+		bool irreversible = cb.pieceAt(moveDest(move)) || cb.pieceAt(moveSource(move))->getType() == PAWN;
+
+		cb.applyMove(move);
+		game.moves.push_back(move);
+
+		if (irreversible) {
+			keys.clear();
+		}
+		keys.push_back(cb.getKey());
+
+		// Positions only repeat with the same player to move, so every other key is compared
+		int repeats = 0;
+		for (int i = (int)keys.size() - 1; i >= 0; i -= 2) {
+			repeats += (keys[i] == cb.getKey());
+		}
+		if (repeats >= 3) {
+			game.termination = "repetition";
+			return game;
+		}
+	}
+}
+
+// Tags, then the move text on one line
+string gamePgn(const PlayedGame& game, const string& white, const string& black, int round) {
+
+	const char* results[3] = { "1-0", "0-1", "1/2-1/2" };
+	const char* result = results[game.outcome];
+
+	// PGN wants all six FEN fields; EPD positions have four
+	string fen = game.fen;
+	istringstream fields(fen);
+	string field;
+	int fieldCount = 0;
+	while (fields >> field) {
+		fieldCount++;
+	}
+	if (fieldCount == 4) {
+		fen += " 0 1";
+	}
+
+	ostringstream pgn;
+	pgn << "[Event \"self-play\"]\n"
+		<< "[Round \"" << round << "\"]\n"
+		<< "[White \"" << white << "\"]\n"
+		<< "[Black \"" << black << "\"]\n"
+		<< "[Result \"" << result << "\"]\n"
+		<< "[SetUp \"1\"]\n"
+		<< "[FEN \"" << fen << "\"]\n"
+		<< "[PlyCount \"" << game.moves.size() << "\"]\n"
+		<< "[Termination \"" << game.termination << "\"]\n\n";
+
+	ChessBoard cb;
+	cb.setPosition(game.fen.c_str());
+	vector<string> sans = lineToSan(cb, game.moves);
+
+	// Black to move first is numbered "1..."
+	bool whiteFirst = (cb.getActiveColour() == 'w');
+	for (size_t i = 0; i < sans.size(); i++) {
+		bool whiteMove = ((i % 2 == 0) == whiteFirst);
+		int number = (int)(i + (whiteFirst ? 0 : 1)) / 2 + 1;
+		if (whiteMove) {
+			pgn << number << ". ";
+		}
+		else if (i == 0) {
+			pgn << number << "... ";
+		}
+		pgn << sans[i] << ' ';
+	}
+	pgn << result << "\n\n";
+
+	return pgn.str();
+}
+
+// MatchStats implementation
+
+// Number of games
+int MatchStats::games() const {
+	return wins + draws + losses;
+}
+
+// Points per game
+double MatchStats::score() const {
+	return (games() > 0 ? (wins + 0.5 * draws) / games() : 0.5);
+}
+
+// Logistic Elo difference of a score, kept finite for scores of 0 and 1
+static double scoreToElo(double score) {
+	if (score < 0.001) {
+		score = 0.001;
+	}
+	if (score > 0.999) {
+		score = 0.999;
+	}
+	return -400 * log10(1 / score - 1);
+}
+
+// Variance of a single game's result around the mean score
+static double gameVariance(const MatchStats& stats) {
+	int n = stats.games();
+	if (n == 0) {
+		return 0;
+	}
+	double s = stats.score();
+	return (stats.wins * (1 - s) * (1 - s) + stats.draws * (0.5 - s) * (0.5 - s) + stats.losses * s * s) / n;
+}
+
+// Elo of the score
+double MatchStats::elo() const {
+	return scoreToElo(score());
+}
+
+// Half-width of the 95% interval, mapped through the Elo curve
+double MatchStats::eloError() const {
+	int n = games();
+	if (n == 0) {
+		return 0;
+	}
+	double margin = 1.96 * sqrt(gameVariance(*this) / n);
+	return (scoreToElo(score() + margin) - scoreToElo(score() - margin)) / 2;
+}
+
+// Normal approximation to the log-likelihood ratio
+double MatchStats::llr(double elo0, double elo1) const {
+	double variance = gameVariance(*this);
+	if (variance <= 0) {
+		return 0;
+	}
+	double s0 = 1 / (1 + pow(10, -elo0 / 400));
+	double s1 = 1 / (1 + pow(10, -elo1 / 400));
+	return games() * (s1 - s0) * (2 * score() - s0 - s1) / (2 * variance);
+}
+
+// Wald's bounds
+void sprtBounds(double alpha, double beta, double& lower, double& upper) {
+	lower = log(beta / (1 - alpha));
+	upper = log((1 - beta) / alpha);
+}
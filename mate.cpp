@@ -0,0 +1,300 @@
+#include <chrono>
+
+#include "MateSolver.h"
+
+using namespace std;
+
+// MateSolver class implementation
+
+/* Proof or disproof number of a node that is settled */
+static const uint32_t INFINITE_PROOF = 100000000;
+
+// Adds proof numbers without going past INFINITE_PROOF
+static uint32_t addProof(uint32_t a, uint32_t b) {
+	return (a + b >= INFINITE_PROOF ? INFINITE_PROOF : a + b);
+}
+
+/* MateSolver constructor */
+MateSolver::MateSolver(size_t megabytes) {
+
+	size_t buckets = 1;
+	while (buckets * 2 * bucketSize * sizeof(Entry) <= megabytes * 1024 * 1024) {
+		buckets *= 2;
+	}
+
+	table.resize(buckets * bucketSize);
+	bucketMask = buckets - 1;
+	nodes = 0;
+	nodeLimit = 0;
+	clear();
+}
+
+// Empties the table
+void MateSolver::clear() {
+	for (Entry& entry : table) {
+		entry.key = 0;
+		entry.work = 0;
+	}
+}
+
+// Mixes the plies left into the position key, as the same position is a different node at a different depth
+uint64_t MateSolver::nodeKey(const ChessBoard& cb, int plies) {
+	return cb.getKey() ^ ((uint64_t)(plies + 1) * 0x9e3779b97f4a7c15ULL);
+}
+
+// Reads a node's proof and disproof numbers
+void MateSolver::lookup(uint64_t key, uint32_t& proof, uint32_t& disproof) {
+
+	Entry* bucket = &table[(key & bucketMask) * bucketSize];
+	for (int i = 0; i < bucketSize; i++) {
+		if (bucket[i].key == key) {
+			proof = bucket[i].proof;
+			disproof = bucket[i].disproof;
+			return;
+		}
+	}
+	proof = 1;
+	disproof = 1;
+}
+
+// Writes a node's numbers, replacing the entry that took the least work if the bucket is full
+void MateSolver::store(uint64_t key, uint32_t proof, uint32_t disproof, uint32_t work) {
+
+	Entry* bucket = &table[(key & bucketMask) * bucketSize];
+	Entry* replace = &bucket[0];
+
+	for (int i = 0; i < bucketSize; i++) {
+		if (bucket[i].key == key) {
+			replace = &bucket[i];
+			break;
+		}
+		if (bucket[i].work < replace->work) {
+			replace = &bucket[i];
+		}
+	}
+
+	replace->key = key;
+	replace->proof = proof;
+	replace->disproof = disproof;
+	replace->work = work;
+}
+
+// The df-pn node expansion
+uint32_t MateSolver::multipleIterativeDeepening(ChessBoard& cb, int plies, bool attacker, uint32_t proofThreshold, uint32_t disproofThreshold) {
+
+	nodes++;
+
+	uint64_t key = nodeKey(cb, plies);
+
+	MoveList moves;
+	cb.generateLegalMoves(moves);
+
+	// No moves: the defender is mated only if in check, anything else is not a win for the attacker
+	if (moves.size == 0) {
+		bool mated = !attacker && cb.kingInCheck(cb.getActiveColour());
+		store(key, mated ? 0 : INFINITE_PROOF, mated ? INFINITE_PROOF : 0, 1);
+		return 1;
+	}
+
+	// Out of plies and the defender still has moves
+	if (plies == 0) {
+		store(key, INFINITE_PROOF, 0, 1);
+		return 1;
+	}
+
+	uint32_t work = 1;
+	uint64_t childKeys[MAX_MOVES];
+	for (int i = 0; i < moves.size; i++) {
+		childKeys[i] = cb.keyAfter(moves.moves[i]) ^ ((uint64_t)plies * 0x9e3779b97f4a7c15ULL);
+	}
+
+	while (true) {
+
+		// Combine the children: min / sum of proof numbers at attacker / defender nodes and the reverse for disproof
+		uint32_t proof = (attacker ? INFINITE_PROOF : 0);
+		uint32_t disproof = (attacker ? 0 : INFINITE_PROOF);
+		uint32_t best = INFINITE_PROOF;
+		uint32_t secondBest = INFINITE_PROOF;
+		uint32_t bestProof = 0;
+		uint32_t bestDisproof = 0;
+		int bestChild = 0;
+
+		for (int i = 0; i < moves.size; i++) {
+			uint32_t childProof, childDisproof;
+			lookup(childKeys[i], childProof, childDisproof);
+
+			// Attacker nodes follow the child easiest to prove, defender nodes the child easiest to disprove
+			uint32_t value = (attacker ? childProof : childDisproof);
+			if (value < best) {
+				secondBest = best;
+				best = value;
+				bestChild = i;
+				bestProof = childProof;
+				bestDisproof = childDisproof;
+			}
+			else if (value < secondBest) {
+				secondBest = value;
+			}
+
+			if (attacker) {
+				proof = (childProof < proof ? childProof : proof);
+				disproof = addProof(disproof, childDisproof);
+			}
+			else {
+				proof = addProof(proof, childProof);
+				disproof = (childDisproof < disproof ? childDisproof : disproof);
+			}
+		}
+
+		bool outOfNodes = (nodeLimit > 0 && nodes >= nodeLimit);
+		if (proof >= proofThreshold || disproof >= disproofThreshold || outOfNodes) {
+			store(key, proof, disproof, work);
+			return work;
+		}
+
+		// Give the chosen child as much room as possible while this node stays under its thresholds
+		uint32_t childProofThreshold, childDisproofThreshold;
+		if (attacker) {
+			childProofThreshold = (proofThreshold < secondBest + 1 ? proofThreshold : secondBest + 1);
+			childDisproofThreshold = addProof(disproofThreshold - disproof, bestDisproof);
+		}
+		else {
+			childDisproofThreshold = (disproofThreshold < secondBest + 1 ? disproofThreshold : secondBest + 1);
+			childProofThreshold = addProof(proofThreshold - proof, bestProof);
+		}
+
+		Move move = moves.moves[bestChild];
+		MoveUndo undo = cb.doMove(move);
+		work += multipleIterativeDeepening(cb, plies - 1, !attacker, childProofThreshold, childDisproofThreshold);
+		cb.undoMove(move, undo);
+	}
+}
+
+// Runs df-pn from a node until it is proven or disproven
+bool MateSolver::proveNode(ChessBoard& cb, int plies, bool attacker) {
+
+	uint32_t proof, disproof;
+	lookup(nodeKey(cb, plies), proof, disproof);
+
+	if (proof != 0 && disproof != 0) {
+		multipleIterativeDeepening(cb, plies, attacker, INFINITE_PROOF, INFINITE_PROOF);
+		lookup(nodeKey(cb, plies), proof, disproof);
+	}
+	return proof == 0;
+}
+
+// Public proof of a mate within some plies
+bool MateSolver::proveMate(ChessBoard& cb, int plies) {
+	return proveNode(cb, plies, true);
+}
+
+// Finds the fewest plies a node needs for mate
+int MateSolver::shortestMate(ChessBoard& cb, int plies, bool attacker) {
+
+	// Mates end on the attacker's move, so attacker nodes need an odd number of plies
+	for (int depth = (attacker ? 1 : 0); depth <= plies; depth += 2) {
+		if (proveNode(cb, depth, attacker)) {
+			return depth;
+		}
+		if (nodeLimit > 0 && nodes >= nodeLimit) {
+			return -1;
+		}
+	}
+	return -1;
+}
+
+// Walks the proof picking the attacker's fastest mate and the defender's slowest loss
+void MateSolver::buildLine(ChessBoard& cb, int plies, bool attacker, vector<Move>& line) {
+
+	MoveList moves;
+	cb.generateLegalMoves(moves);
+
+	if (moves.size == 0 || plies <= 0) {
+		return;
+	}
+
+	Move chosen = NO_MOVE;
+	int chosenPlies = -1;
+
+	if (attacker) {
+		int depth = shortestMate(cb, plies, true);
+		if (depth < 0) {
+			return;
+		}
+		for (int i = 0; i < moves.size && chosen == NO_MOVE; i++) {
+			MoveUndo undo = cb.doMove(moves.moves[i]);
+			if (proveNode(cb, depth - 1, false)) {
+				chosen = moves.moves[i];
+				chosenPlies = depth - 1;
+			}
+			cb.undoMove(moves.moves[i], undo);
+		}
+	}
+	else {
+		for (int i = 0; i < moves.size; i++) {
+			MoveUndo undo = cb.doMove(moves.moves[i]);
+			int depth = shortestMate(cb, plies - 1, true);
+			cb.undoMove(moves.moves[i], undo);
+			if (depth > chosenPlies) {
+				chosen = moves.moves[i];
+				chosenPlies = depth;
+			}
+		}
+	}
+
+	if (chosen == NO_MOVE || chosenPlies < 0) {
+		return;
+	}
+
+	line.push_back(chosen);
+	MoveUndo undo = cb.doMove(chosen);
+	buildLine(cb, chosenPlies, !attacker, line);
+	cb.undoMove(chosen, undo);
+}
+
+// Finds the shortest mate, its line and how many first moves also mate
+MateResult MateSolver::solve(ChessBoard& cb, int maxMoves, uint64_t limit) {
+
+	auto start = chrono::steady_clock::now();
+
+	MateResult result;
+	result.found = false;
+	result.aborted = false;
+	result.mateIn = 0;
+	result.solutions = 0;
+	result.unique = false;
+
+	nodes = 0;
+	nodeLimit = limit;
+
+	// One proof for the whole length first, so positions without a mate are rejected quickly
+	if (maxMoves > 0 && proveNode(cb, 2 * maxMoves - 1, true)) {
+
+		int plies = shortestMate(cb, 2 * maxMoves - 1, true);
+
+		if (plies > 0) {
+			result.found = true;
+			result.mateIn = (plies + 1) / 2;
+
+			MoveList moves;
+			cb.generateLegalMoves(moves);
+			for (int i = 0; i < moves.size; i++) {
+				MoveUndo undo = cb.doMove(moves.moves[i]);
+				if (proveNode(cb, plies - 1, false)) {
+					result.solutions++;
+				}
+				cb.undoMove(moves.moves[i], undo);
+			}
+
+			buildLine(cb, plies, true, result.line);
+		}
+	}
+
+	result.aborted = (nodeLimit > 0 && nodes >= nodeLimit);
+	result.unique = (result.found && !result.aborted && result.solutions == 1);
+	result.nodes = nodes;
+	result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	nodeLimit = 0;
+	return result;
+}
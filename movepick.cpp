@@ -0,0 +1,172 @@
+#include "Evaluation.h"
+#include "MovePicker.h"
+#include "StaticExchange.h"
+
+using namespace std;
+
+// MovePicker class implementation
+
+/* MovePicker constructor */
+MovePicker::MovePicker(ChessBoard& cb, Move hashMove, const Move* killerMoves, const int (*historyTable)[64], bool ordered) : board(cb) {
+
+	ttMove = hashMove;
+	killers[0] = (killerMoves ? killerMoves[0] : NO_MOVE);
+	killers[1] = (killerMoves && killerMoves[1] != killers[0] ? killerMoves[1] : NO_MOVE);
+	history = historyTable;
+
+	index = 0;
+	badIndex = 0;
+	killerIndex = 0;
+	stage = (ordered ? STAGE_TT_MOVE : STAGE_UNORDERED);
+	quiescence = false;
+
+	if (!ordered) {
+		board.generateLegalMoves(moves);
+	}
+}
+
+/* Quiescence MovePicker constructor */
+MovePicker::MovePicker(ChessBoard& cb) : board(cb) {
+
+	ttMove = NO_MOVE;
+	killers[0] = NO_MOVE;
+	killers[1] = NO_MOVE;
+	history = nullptr;
+
+	index = 0;
+	badIndex = 0;
+	killerIndex = 0;
+	stage = STAGE_GENERATE_CAPTURES;
+	quiescence = true;
+}
+
+// Hands out the next move, moving through the stages as each runs out
+Move MovePicker::next() {
+
+	while (true) {
+		switch (stage) {
+
+			case STAGE_TT_MOVE:
+				stage = STAGE_GENERATE_CAPTURES;
+				if (ttMove != NO_MOVE && board.isPseudoLegal(ttMove) && board.isLegal(ttMove)) {
+					return ttMove;
+				}
+				ttMove = NO_MOVE;
+				break;
+
+			case STAGE_GENERATE_CAPTURES:
+				board.generateMoves(moves, GEN_CAPTURES);
+				for (int i = 0; i < moves.size; i++) {
+					Move move = moves.moves[i];
+					// Most valuable victim first, then least valuable attacker
+					scores[i] = pieceValues[board.pieceAt(moveDest(move))->getType()] * 16
+						- pieceValues[board.pieceAt(moveSource(move))->getType()] / 16;
+				}
+				index = 0;
+				stage = STAGE_GOOD_CAPTURES;
+				break;
+
+			case STAGE_GOOD_CAPTURES:
+				while (index < moves.size) {
+					Move move = pickBest();
+					if (move == ttMove) {
+						continue;
+					}
+					if (losingCapture(move)) {
+						if (!quiescence) {
+							badCaptures.add(move);
+						}
+						continue;
+					}
+					return move;
+				}
+				stage = (quiescence ? STAGE_DONE : STAGE_KILLERS);
+				break;
+
+			case STAGE_KILLERS:
+				while (killerIndex < 2) {
+					Move move = killers[killerIndex++];
+					if (move != NO_MOVE && move != ttMove && board.isPseudoLegal(move)
+							&& !board.pieceAt(moveDest(move)) && board.isLegal(move)) {
+						return move;
+					}
+				}
+				stage = STAGE_GENERATE_QUIETS;
+				break;
+
+			case STAGE_GENERATE_QUIETS:
+				board.generateMoves(moves, GEN_QUIETS);
+				for (int i = 0; i < moves.size; i++) {
+					scores[i] = (history ? history[moveSource(moves.moves[i])][moveDest(moves.moves[i])] : 0);
+				}
+				index = 0;
+				stage = STAGE_QUIETS;
+				break;
+
+			case STAGE_QUIETS:
+				while (index < moves.size) {
+					Move move = pickBest();
+					if (!alreadyTried(move)) {
+						return move;
+					}
+				}
+				stage = STAGE_BAD_CAPTURES;
+				break;
+
+			case STAGE_BAD_CAPTURES:
+				if (badIndex < badCaptures.size) {
+					return badCaptures.moves[badIndex++];
+				}
+				stage = STAGE_DONE;
+				break;
+
+			case STAGE_UNORDERED:
+				if (index < moves.size) {
+					return moves.moves[index++];
+				}
+				stage = STAGE_DONE;
+				break;
+
+			case STAGE_DONE:
+				return NO_MOVE;
+		}
+	}
+}
+
+// Returns the current stage
+PickStage MovePicker::getStage() const {
+	return stage;
+}
+
+// Selection sort step: swap the best remaining move to the front and return it
+Move MovePicker::pickBest() {
+
+	int best = index;
+	for (int i = index + 1; i < moves.size; i++) {
+		if (scores[i] > scores[best]) {
+			best = i;
+		}
+	}
+
+	Move move = moves.moves[best];
+	moves.moves[best] = moves.moves[index];
+	scores[best] = scores[index];
+	moves.moves[index] = move;
+	index++;
+
+	return move;
+}
+
+// Checks for moves already returned by earlier stages
+bool MovePicker::alreadyTried(Move move) const {
+	return move == ttMove || (killerIndex > 0 && move == killers[0]) || (killerIndex > 1 && move == killers[1]);
+}
+
+// A capture of an equal or more valuable piece can never lose material, so only the others need an exchange evaluation
+bool MovePicker::losingCapture(Move move) const {
+
+	int attacker = pieceValues[board.pieceAt(moveSource(move))->getType()];
+	int victim = pieceValues[board.pieceAt(moveDest(move))->getType()];
+
+	return victim < attacker && staticExchange(board, move) < 0;
+}
@@ -0,0 +1,161 @@
+#include <cctype>
+
+#include "Notation.h"
+
+using namespace std;
+
+/* SAN letters of the piece types, indexed by PieceType (pawns have none) */
+static const char sanLetters[6] = { 'K', 'Q', 'B', 'R', 'N', 0 };
+
+// Writes a square in lowercase as SAN does
+static string sanSquare(int square) {
+	string name = squareName(square);
+	name[0] = tolower(name[0]);
+	return name;
+}
+
+// Adds the file, rank or both when another piece of the same type can reach the same square
+string moveToSan(const ChessBoard& cb, Move move) {
+
+	ChessBoard board = cb;
+
+	int source = moveSource(move);
+	int dest = moveDest(move);
+	PieceType type = board.pieceAt(source)->getType();
+	bool capture = board.pieceAt(dest) != nullptr;
+
+	string san;
+	if (type == PAWN) {
+		if (capture) {
+			san += sanSquare(source)[0];
+		}
+	}
+	else {
+		san += sanLetters[type];
+
+		MoveList moves;
+		board.generateLegalMoves(moves);
+
+		bool ambiguous = false;
+		bool sameFile = false;
+		bool sameRank = false;
+		for (int i = 0; i < moves.size; i++) {
+			int other = moveSource(moves.moves[i]);
+			if (other != source && moveDest(moves.moves[i]) == dest && board.pieceAt(other)->getType() == type) {
+				ambiguous = true;
+				sameFile |= squareCol(other) == squareCol(source);
+				sameRank |= squareRow(other) == squareRow(source);
+			}
+		}
+
+		if (ambiguous) {
+			if (!sameFile) {
+				san += sanSquare(source)[0];
+			}
+			else if (!sameRank) {
+				san += sanSquare(source)[1];
+			}
+			else {
+				san += sanSquare(source);
+			}
+		}
+	}
+
+	if (capture) {
+		san += 'x';
+	}
+	san += sanSquare(dest);
+
+	board.doMove(move);
+	if (board.kingInCheck(board.getActiveColour())) {
+		MoveList replies;
+		board.generateLegalMoves(replies);
+		san += (replies.size == 0 ? '#' : '+');
+	}
+
+	return san;
+}
+
+// Plays the line on a copy, writing each move before it is made
+vector<string> lineToSan(const ChessBoard& cb, const vector<Move>& line) {
+
+	ChessBoard board = cb;
+	vector<string> sans;
+
+	for (Move move : line) {
+		sans.push_back(moveToSan(board, move));
+		board.doMove(move);
+	}
+	return sans;
+}
+
+// Matches the text against the legal moves
+Move parseMove(const ChessBoard& cb, const string& text) {
+
+	ChessBoard board = cb;
+	MoveList moves;
+	board.generateLegalMoves(moves);
+
+	string name = text;
+	while (!name.empty() && (name.back() == '+' || name.back() == '#' || name.back() == '!' || name.back() == '?')) {
+		name.pop_back();
+	}
+
+	// Square names: source then destination
+	if (name.size() == 4 && parseSquare(name.c_str()) >= 0 && parseSquare(name.c_str() + 2) >= 0) {
+		Move move = encodeMove(parseSquare(name.c_str()), parseSquare(name.c_str() + 2));
+		for (int i = 0; i < moves.size; i++) {
+			if (moves.moves[i] == move) {
+				return move;
+			}
+		}
+		return NO_MOVE;
+	}
+
+	// SAN: [piece][file][rank][x]square
+	PieceType type = PAWN;
+	size_t start = 0;
+	for (int t = KING; t < PAWN; t++) {
+		if (!name.empty() && name[0] == sanLetters[t]) {
+			type = (PieceType)t;
+			start = 1;
+		}
+	}
+
+	if (name.size() < start + 2) {
+		return NO_MOVE;
+	}
+	int dest = parseSquare(name.c_str() + name.size() - 2);
+	if (dest < 0 || name[name.size() - 2] != tolower(name[name.size() - 2])) {
+		return NO_MOVE;
+	}
+
+	int fromCol = -1;
+	int fromRow = -1;
+	for (size_t i = start; i < name.size() - 2; i++) {
+		if (name[i] >= 'a' && name[i] <= 'h') {
+			fromCol = name[i] - 'a';
+		}
+		else if (name[i] >= '1' && name[i] <= '8') {
+			fromRow = '8' - name[i];
+		}
+		else if (name[i] != 'x') {
+			return NO_MOVE;
+		}
+	}
+
+	Move found = NO_MOVE;
+	for (int i = 0; i < moves.size; i++) {
+		Move move = moves.moves[i];
+		int source = moveSource(move);
+		if (moveDest(move) != dest || board.pieceAt(source)->getType() != type
+				|| (fromCol >= 0 && squareCol(source) != fromCol) || (fromRow >= 0 && squareRow(source) != fromRow)) {
+			continue;
+		}
+		if (found != NO_MOVE) {
+			return NO_MOVE;
+		}
+		found = move;
+	}
+	return found;
+}
@@ -0,0 +1,133 @@
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "PerfCounters.h"
+
+using namespace std;
+
+// Short name of an event
+const char* perfEventName(int event) {
+	static const char* names[PERF_EVENT_COUNT] = { "cycles", "instr", "br-miss", "L1D-miss", "LLC-miss" };
+	return names[event];
+}
+
+// Adds counts event by event
+PerfCounts& PerfCounts::operator+=(const PerfCounts& other) {
+	for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+		values[event] += other.values[event];
+	}
+	return *this;
+}
+
+// Subtracts counts event by event
+PerfCounts PerfCounts::operator-(const PerfCounts& other) const {
+	PerfCounts difference;
+	for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+		difference.values[event] = values[event] - other.values[event];
+	}
+	return difference;
+}
+
+
+// PerfCounters class implementation
+
+/* PerfCounters constructor */
+PerfCounters::PerfCounters() {
+	for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+		fds[event] = -1;
+	}
+}
+
+/* PerfCounters destructor */
+PerfCounters::~PerfCounters() {
+	for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+		if (fds[event] >= 0) {
+			close(fds[event]);
+		}
+	}
+}
+
+// Opens one counter per event, keeping whichever the kernel accepts
+bool PerfCounters::open() {
+
+	// Cache events are encoded as cache | operation << 8 | result << 16
+	const uint32_t types[PERF_EVENT_COUNT] = {
+		PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE
+	};
+	const uint64_t configs[PERF_EVENT_COUNT] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_BRANCH_MISSES,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+	};
+
+	int firstError = 0;
+	for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = types[event];
+		attr.config = configs[event];
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		fds[event] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		if (fds[event] < 0 && firstError == 0) {
+			firstError = errno;
+		}
+	}
+
+	if (isOpen()) {
+		return true;
+	}
+
+	error = strerror(firstError);
+	ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+	int level;
+	if (paranoid >> level) {
+		error += " (perf_event_paranoid is " + to_string(level) + ")";
+	}
+	return false;
+}
+
+// True if any event is counted
+bool PerfCounters::isOpen() const {
+	for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+		if (fds[event] >= 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// True if this event is counted
+bool PerfCounters::has(int event) const {
+	return fds[event] >= 0;
+}
+
+// Reads each counter, scaled up for the time the kernel had it switched out
+PerfCounts PerfCounters::read() const {
+
+	PerfCounts counts;
+	for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+		uint64_t data[3];
+		if (fds[event] < 0 || ::read(fds[event], data, sizeof(data)) != sizeof(data)) {
+			continue;
+		}
+		// data holds the count, time enabled and time running
+		counts.values[event] = (data[2] > 0 ? (double)data[0] * data[1] / data[2] : 0);
+	}
+	return counts;
+}
+
+// Reason open failed
+string PerfCounters::getError() const {
+	return error;
+}
@@ -0,0 +1,242 @@
+#include <chrono>
+
+#include "Perft.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// PerftCache class implementation
+
+/* PerftCache constructor */
+PerftCache::PerftCache(size_t megabytes) {
+
+	size_t count = 1;
+	while (count * 2 * sizeof(Entry) <= megabytes * 1024 * 1024) {
+		count *= 2;
+	}
+
+	entries.reset(new Entry[count]);
+	mask = count - 1;
+	clear();
+}
+
+// Finds a stored subtree count
+bool PerftCache::probe(uint64_t key, int depth, uint64_t& nodes) const {
+
+	probes.fetch_add(1, memory_order_relaxed);
+
+	const Entry& entry = entries[(key ^ (uint64_t)depth * 0x9e3779b97f4a7c15ULL) & mask];
+	uint64_t data = entry.data.load(memory_order_relaxed);
+	uint64_t check = entry.check.load(memory_order_relaxed);
+
+	// The low 8 bits hold the depth and the rest the count
+	if ((check ^ data) != key || (int)(data & 0xff) != depth) {
+		return false;
+	}
+
+	hits.fetch_add(1, memory_order_relaxed);
+	nodes = data >> 8;
+	return true;
+}
+
+// Stores a subtree count
+void PerftCache::store(uint64_t key, int depth, uint64_t nodes) {
+
+	Entry& entry = entries[(key ^ (uint64_t)depth * 0x9e3779b97f4a7c15ULL) & mask];
+	uint64_t data = (nodes << 8) | (uint64_t)depth;
+
+	entry.data.store(data, memory_order_relaxed);
+	entry.check.store(key ^ data, memory_order_relaxed);
+}
+
+// Empties the table
+void PerftCache::clear() {
+
+	for (size_t i = 0; i <= mask; i++) {
+		entries[i].data.store(0, memory_order_relaxed);
+		entries[i].check.store(0, memory_order_relaxed);
+	}
+	probes = 0;
+	hits = 0;
+}
+
+uint64_t PerftCache::getProbes() const {
+	return probes;
+}
+
+uint64_t PerftCache::getHits() const {
+	return hits;
+}
+
+/* ---------------------------------------------------------------------- */
+
+// Serial perft with bulk counting at the last ply
+uint64_t perft(ChessBoard& cb, int depth, PerftCache* cache) {
+
+	if (depth == 0) {
+		return 1;
+	}
+
+	MoveList moves;
+	cb.generateLegalMoves(moves);
+
+	if (depth == 1) {
+		return moves.size;
+	}
+
+	uint64_t nodes = 0;
+	if (cache && cache->probe(cb.getKey(), depth, nodes)) {
+		return nodes;
+	}
+
+	for (int i = 0; i < moves.size; i++) {
+		MoveUndo undo = cb.doMove(moves.moves[i]);
+		nodes += perft(cb, depth - 1, cache);
+		cb.undoMove(moves.moves[i], undo);
+	}
+
+	if (cache) {
+		cache->store(cb.getKey(), depth, nodes);
+	}
+	return nodes;
+}
+
+/* Shared state of one parallel perft run */
+struct PerftJob {
+	ThreadPool* pool;
+	PerftCache* cache;
+	int splitDepth;
+
+	/* One board per worker thread */
+	vector<ChessBoard> boards;
+
+	/* Count below each root move, added once its subtree is complete */
+	unique_ptr<atomic<uint64_t>[]> rootNodes;
+};
+
+/* A split subtree whose children are counted by separate tasks */
+struct PerftSplit {
+	uint64_t key;
+	int depth;
+
+	/* The split subtree this one is a child of, or nullptr below a root move */
+	shared_ptr<PerftSplit> parent;
+
+	/* Sum of the finished children and the number still running */
+	atomic<uint64_t> nodes;
+	atomic<int> pending;
+};
+
+// Adds a finished subtree to its parent; the last child of a split subtree stores its total and finishes it in turn
+static void finishSubtree(PerftJob* job, shared_ptr<PerftSplit> parent, int rootIndex, uint64_t nodes) {
+
+	while (parent) {
+		parent->nodes += nodes;
+		if (parent->pending.fetch_sub(1) != 1) {
+			return;
+		}
+		nodes = parent->nodes;
+		if (job->cache) {
+			job->cache->store(parent->key, parent->depth, nodes);
+		}
+		parent = parent->parent;
+	}
+	job->rootNodes[rootIndex] += nodes;
+}
+
+// Counts one subtree, or splits it into a task per move if it is deep enough
+static void perftTask(PerftJob* job, PackedPosition position, int depth, int rootIndex, shared_ptr<PerftSplit> parent) {
+
+	ChessBoard& cb = job->boards[ThreadPool::workerIndex()];
+	cb.unpackState(position);
+
+	if (depth <= job->splitDepth) {
+		finishSubtree(job, parent, rootIndex, perft(cb, depth, job->cache));
+		return;
+	}
+
+	uint64_t nodes;
+	if (job->cache && job->cache->probe(cb.getKey(), depth, nodes)) {
+		finishSubtree(job, parent, rootIndex, nodes);
+		return;
+	}
+
+	MoveList moves;
+	cb.generateLegalMoves(moves);
+	if (moves.size == 0) {
+		if (job->cache) {
+			job->cache->store(cb.getKey(), depth, 0);
+		}
+		finishSubtree(job, parent, rootIndex, 0);
+		return;
+	}
+
+	// Every child is counted as pending before any can finish
+	shared_ptr<PerftSplit> split = make_shared<PerftSplit>();
+	split->key = cb.getKey();
+	split->depth = depth;
+	split->parent = parent;
+	split->nodes = 0;
+	split->pending = moves.size;
+
+	for (int i = 0; i < moves.size; i++) {
+		MoveUndo undo = cb.doMove(moves.moves[i]);
+		PackedPosition child;
+		cb.packState(child);
+		cb.undoMove(moves.moves[i], undo);
+
+		job->pool->submit([job, child, depth, rootIndex, split] { perftTask(job, child, depth - 1, rootIndex, split); });
+	}
+}
+
+// Runs perft from the root moves over a thread pool
+PerftResult parallelPerft(const ChessBoard& start, int depth, int threads, PerftCache* cache, int splitDepth) {
+
+	PerftResult result;
+	result.nodes = 0;
+
+	auto startTime = chrono::steady_clock::now();
+
+	ChessBoard cb = start;
+
+	if (depth <= 1) {
+		result.nodes = perft(cb, depth);
+		result.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		return result;
+	}
+
+	MoveList moves;
+	cb.generateLegalMoves(moves);
+
+	ThreadPool pool(threads);
+
+	PerftJob job;
+	job.pool = &pool;
+	job.cache = cache;
+	job.splitDepth = (splitDepth < 1 ? 1 : splitDepth);
+	job.rootNodes.reset(new atomic<uint64_t>[moves.size]);
+
+	job.boards.assign(pool.size(), cb);
+
+	for (int i = 0; i < moves.size; i++) {
+		job.rootNodes[i] = 0;
+
+		MoveUndo undo = cb.doMove(moves.moves[i]);
+		PackedPosition child;
+		cb.packState(child);
+		cb.undoMove(moves.moves[i], undo);
+
+		PerftJob* jobPtr = &job;
+		pool.submit([jobPtr, child, depth, i] { perftTask(jobPtr, child, depth - 1, i, nullptr); });
+	}
+
+	pool.wait();
+
+	for (int i = 0; i < moves.size; i++) {
+		result.divide.push_back(make_pair(moves.moves[i], (uint64_t)job.rootNodes[i]));
+		result.nodes += job.rootNodes[i];
+	}
+
+	result.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	return result;
+}
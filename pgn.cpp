@@ -0,0 +1,164 @@
+#include <cctype>
+
+#include "Pgn.h"
+
+using namespace std;
+
+// PgnGame struct implementation
+
+// Looks up a tag
+string PgnGame::tag(const string& name, const string& missing) const {
+	auto found = tags.find(name);
+	return (found == tags.end() ? missing : found->second);
+}
+
+// PgnReader class implementation
+
+/* PgnReader constructor */
+PgnReader::PgnReader(istream& in) : input(in) {
+	lineNo = 0;
+	gameLineNo = 0;
+	gameOffset = 0;
+	variationDepth = 0;
+	inComment = false;
+}
+
+// Reads tag pairs until the movetext, then movetext until the result or the next game's tags
+bool PgnReader::next(PgnGame& game) {
+
+	game.tags.clear();
+	game.moves.clear();
+	game.result.clear();
+	variationDepth = 0;
+	inComment = false;
+
+	bool started = false;
+	string line;
+
+	while (input.peek() != EOF) {
+
+		// A tag line after movetext belongs to the next game (its result token was missing)
+		if (started && !game.moves.empty() && input.peek() == '[' && !inComment) {
+			return true;
+		}
+
+		streamoff offset = (started ? 0 : (streamoff)input.tellg());
+		getline(input, line);
+		lineNo++;
+
+		if (!line.empty() && line[line.size() - 1] == '\r') {
+			line.erase(line.size() - 1);
+		}
+
+		size_t first = line.find_first_not_of(" \t");
+		if (first == string::npos || line[first] == '%') {
+			continue;
+		}
+
+		if (!started) {
+			started = true;
+			gameLineNo = lineNo;
+			gameOffset = (offset < 0 ? 0 : offset);
+		}
+
+		if (line[first] == '[' && !inComment) {
+			// [Name "value"]
+			size_t nameEnd = line.find_first_of(" \t", first);
+			size_t open = line.find('"', first);
+			size_t close = line.rfind('"');
+			if (nameEnd != string::npos && open != string::npos && close > open) {
+				game.tags[line.substr(first + 1, nameEnd - first - 1)] = line.substr(open + 1, close - open - 1);
+			}
+			continue;
+		}
+
+		if (readMovetext(line, game)) {
+			return true;
+		}
+	}
+
+	if (started && game.result.empty()) {
+		game.result = game.tag("Result", "*");
+	}
+	return started;
+}
+
+// Line the last game started on
+int PgnReader::getLineNo() const {
+	return gameLineNo;
+}
+
+// Byte offset the last game started at
+uint64_t PgnReader::getOffset() const {
+	return gameOffset;
+}
+
+// Tokenises movetext, skipping comments, variations, glyphs and move numbers
+bool PgnReader::readMovetext(const string& line, PgnGame& game) {
+
+	size_t i = 0;
+	while (i < line.size()) {
+		char c = line[i];
+
+		if (inComment) {
+			if (c == '}') {
+				inComment = false;
+			}
+			i++;
+			continue;
+		}
+		if (c == '{') {
+			inComment = true;
+			i++;
+			continue;
+		}
+		if (c == ';') {
+			return false;
+		}
+		if (c == '(') {
+			variationDepth++;
+			i++;
+			continue;
+		}
+		if (c == ')') {
+			variationDepth -= (variationDepth > 0);
+			i++;
+			continue;
+		}
+		if (isspace((unsigned char)c)) {
+			i++;
+			continue;
+		}
+
+		size_t end = line.find_first_of(" \t{}();", i);
+		if (end == string::npos) {
+			end = line.size();
+		}
+		string token = line.substr(i, end - i);
+		i = end;
+
+		if (variationDepth > 0 || token[0] == '$') {
+			continue;
+		}
+		if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") {
+			game.result = token;
+			return true;
+		}
+
+		// Move numbers may be run together with the move, as in "12.Nf3" or "12...Nf3"
+		size_t digits = 0;
+		while (digits < token.size() && isdigit((unsigned char)token[digits])) {
+			digits++;
+		}
+		if (digits > 0 && digits < token.size() && token[digits] == '.') {
+			size_t dots = token.find_first_not_of('.', digits);
+			if (dots == string::npos) {
+				continue;
+			}
+			token = token.substr(dots);
+		}
+
+		game.moves.push_back(token);
+	}
+	return false;
+}
@@ -0,0 +1,217 @@
+#include <cstring>
+
+#include "GameRecord.h"
+
+using namespace std;
+
+// GameRecord class implementation
+
+/* Tag at the start of every serialised record */
+static const char recordTag[4] = { 'C', 'G', 'R', '1' };
+
+/* Size of the header before the moves: tag, interval, move count and start position */
+static const size_t recordHeaderSize = 4 + 2 + 4 + 32 + 1;
+
+/* GameRecord constructor */
+GameRecord::GameRecord(const ChessBoard& startBoard, int checkpointInterval) {
+
+	PackedPosition startPosition;
+	startBoard.packState(startPosition);
+
+	reset(startPosition, checkpointInterval);
+}
+
+// Clears the record and makes the board the start position
+void GameRecord::reset(const PackedPosition& startPosition, int interval) {
+
+	start = startPosition;
+	checkpointInterval = (interval < 1 ? 1 : interval);
+	ply = 0;
+
+	moves.clear();
+	checkpoints.clear();
+	checkpoints.push_back(start);
+
+	board.unpackState(start);
+}
+
+// Plays and records a move at the current ply
+bool GameRecord::append(Move move) {
+
+	if (!board.isLegalMove(move)) {
+		return false;
+	}
+
+	// Drop any moves (and their checkpoints) after the current ply
+	moves.resize(ply);
+	checkpoints.resize(ply / checkpointInterval + 1);
+
+	moves.push_back(move);
+	board.applyMove(move);
+	ply++;
+
+	if (ply % checkpointInterval == 0) {
+		PackedPosition checkpoint;
+		board.packState(checkpoint);
+		checkpoints.push_back(checkpoint);
+	}
+
+	return true;
+}
+
+// Plays and records a move given by square names
+bool GameRecord::append(const char* sourceSquare, const char* destSquare) {
+
+	int source = parseSquare(sourceSquare);
+	int dest = parseSquare(destSquare);
+
+	if (source < 0 || dest < 0) {
+		return false;
+	}
+
+	return append(encodeMove(source, dest));
+}
+
+// Steps back one ply
+bool GameRecord::undo() {
+	if (ply == 0) {
+		return false;
+	}
+	return seek(ply - 1);
+}
+
+// Steps forward one ply
+bool GameRecord::redo() {
+	if (ply == (int)moves.size()) {
+		return false;
+	}
+	board.applyMove(moves[ply]);
+	ply++;
+	return true;
+}
+
+// Moves the board to the given ply from the nearest checkpoint
+bool GameRecord::seek(int targetPly) {
+
+	if (targetPly < 0 || targetPly > (int)moves.size()) {
+		return false;
+	}
+
+	int checkpointPly = (targetPly / checkpointInterval) * checkpointInterval;
+
+	// Only restore the checkpoint if the current ply is not already between it and the target
+	if (ply < checkpointPly || ply > targetPly) {
+		board.unpackState(checkpoints[targetPly / checkpointInterval]);
+		ply = checkpointPly;
+	}
+
+	while (ply < targetPly) {
+		board.applyMove(moves[ply]);
+		ply++;
+	}
+
+	return true;
+}
+
+// Returns the current ply
+int GameRecord::currentPly() const {
+	return ply;
+}
+
+// Returns the number of recorded plies
+int GameRecord::length() const {
+	return moves.size();
+}
+
+// Returns the move played at a ply
+Move GameRecord::moveAt(int moveNo) const {
+	if (moveNo < 0 || moveNo >= (int)moves.size()) {
+		return NO_MOVE;
+	}
+	return moves[moveNo];
+}
+
+// Returns the board at the current ply
+const ChessBoard& GameRecord::getBoard() const {
+	return board;
+}
+
+// Writes the start position and moves into a binary blob (little endian)
+vector<uint8_t> GameRecord::serialise() const {
+
+	vector<uint8_t> blob;
+	blob.reserve(recordHeaderSize + 2 * moves.size());
+
+	for (int i = 0; i < 4; i++) {
+		blob.push_back(recordTag[i]);
+	}
+
+	blob.push_back(checkpointInterval & 0xff);
+	blob.push_back((checkpointInterval >> 8) & 0xff);
+
+	uint32_t count = moves.size();
+	for (int i = 0; i < 4; i++) {
+		blob.push_back((count >> (8 * i)) & 0xff);
+	}
+
+	blob.insert(blob.end(), start.squares, start.squares + 32);
+	blob.push_back(start.activeColour);
+
+	for (Move move : moves) {
+		blob.push_back(move & 0xff);
+		blob.push_back(move >> 8);
+	}
+
+	return blob;
+}
+
+// Reads a blob written by serialise, replaying it to check every move
+bool GameRecord::deserialise(const vector<uint8_t>& blob) {
+
+	if (blob.size() < recordHeaderSize || memcmp(blob.data(), recordTag, 4) != 0) {
+		return false;
+	}
+
+	int interval = blob[4] | (blob[5] << 8);
+
+	uint32_t count = 0;
+	for (int i = 0; i < 4; i++) {
+		count |= (uint32_t)blob[6 + i] << (8 * i);
+	}
+
+	if (blob.size() != recordHeaderSize + 2 * (size_t)count) {
+		return false;
+	}
+
+	PackedPosition startPosition;
+	memcpy(startPosition.squares, &blob[10], 32);
+	startPosition.activeColour = blob[42];
+
+	// Square codes past 12 or a missing King would reach unpackState and the move checks
+	if (!ChessBoard::validPacked(startPosition)) {
+		return false;
+	}
+
+	// Keep the current record so it can be restored if the blob holds an illegal move
+	PackedPosition oldStart = start;
+	vector<Move> oldMoves = moves;
+	int oldInterval = checkpointInterval;
+	int oldPly = ply;
+
+	reset(startPosition, interval);
+
+	for (uint32_t i = 0; i < count; i++) {
+		Move move = blob[recordHeaderSize + 2 * i] | (blob[recordHeaderSize + 2 * i + 1] << 8);
+
+		if (!append(move)) {
+			reset(oldStart, oldInterval);
+			for (Move oldMove : oldMoves) {
+				append(oldMove);
+			}
+			seek(oldPly);
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,66 @@
+#include "ScoreCache.h"
+
+using namespace std;
+
+// ScoreCache class implementation
+
+/* ScoreCache constructor */
+ScoreCache::ScoreCache(size_t kilobytes) {
+
+	size_t count = 1;
+	while (count * 2 * sizeof(ScoreLine) <= kilobytes * 1024) {
+		count *= 2;
+	}
+
+	lines.resize(count);
+	mask = count - 1;
+	clear();
+}
+
+// The low bits pick the line and the top two, which the line index never reaches, the entry within it
+bool ScoreCache::probe(uint64_t key, int& score) {
+
+	const ScoreEntry& entry = lines[key & mask].entries[(key >> 62) & 3];
+	probes++;
+	if (entry.key != key) {
+		return false;
+	}
+	hits++;
+	score = entry.score;
+	return true;
+}
+
+// Overwrites the slot of a key
+void ScoreCache::store(uint64_t key, int score) {
+	ScoreEntry& entry = lines[key & mask].entries[(key >> 62) & 3];
+	entry.key = key;
+	entry.score = score;
+}
+
+// Empties every slot
+void ScoreCache::clear() {
+	for (ScoreLine& line : lines) {
+		for (ScoreEntry& entry : line.entries) {
+			entry.key = 0;
+			entry.score = 0;
+			entry.reserved = 0;
+		}
+	}
+	resetCounters();
+}
+
+// Number of probes
+uint64_t ScoreCache::getProbes() const {
+	return probes;
+}
+
+// Number of hits
+uint64_t ScoreCache::getHits() const {
+	return hits;
+}
+
+// Starts counting again
+void ScoreCache::resetCounters() {
+	probes = 0;
+	hits = 0;
+}
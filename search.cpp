@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "Evaluation.h"
+#include "MovePicker.h"
+#include "Search.h"
+#include "Trace.h"
+
+using namespace std;
+
+// Mate scores are stored as distance from the node so they stay right when found through another path
+int scoreToTable(int score, int ply) {
+	if (score > MATE_BOUND) {
+		return score + ply;
+	}
+	if (score < -MATE_BOUND) {
+		return score - ply;
+	}
+	return score;
+}
+
+int scoreFromTable(int score, int ply) {
+	if (score > MATE_BOUND) {
+		return score - ply;
+	}
+	if (score < -MATE_BOUND) {
+		return score + ply;
+	}
+	return score;
+}
+
+// Searcher class implementation
+
+/* Searcher constructor */
+Searcher::Searcher(size_t ttMegabytes) : tt(ttMegabytes), pawnCache(PAWN_CACHE_KILOBYTES), evalCache(EVAL_CACHE_KILOBYTES) {
+	ordering = true;
+	useQuiescence = true;
+	useEvalCache = true;
+	nodeLimit = 0;
+	timer = nullptr;
+	nextTimeCheck = 0;
+	stopped = false;
+	clear();
+}
+
+// Turns move ordering on or off
+void Searcher::setMoveOrdering(bool enabled) {
+	ordering = enabled;
+}
+
+// Turns quiescence search on or off
+void Searcher::setQuiescence(bool enabled) {
+	useQuiescence = enabled;
+}
+
+// Turns the evaluation caches on or off
+void Searcher::setEvalCache(bool enabled) {
+	useEvalCache = enabled;
+}
+
+// Forgets previous searches
+void Searcher::clear() {
+	tt.clear();
+	pawnCache.clear();
+	evalCache.clear();
+	memset(killers, 0, sizeof(killers));
+	memset(history, 0, sizeof(history));
+}
+
+// Iterative deepening driver
+SearchResult Searcher::search(ChessBoard& cb, const SearchLimits& limits) {
+
+	TraceScope trace("search", "search", "nodes");
+	auto start = chrono::steady_clock::now();
+
+	stats = SearchStats();
+	nodeLimit = limits.nodes;
+	timer = limits.time;
+	nextTimeCheck = 0;
+	stopped = false;
+	pawnCache.resetCounters();
+	evalCache.resetCounters();
+
+	// Old history scores still help but should not outweigh what this search learns
+	for (int colour = 0; colour < 2; colour++) {
+		for (int source = 0; source < 64; source++) {
+			for (int dest = 0; dest < 64; dest++) {
+				history[colour][source][dest] /= 8;
+			}
+		}
+	}
+
+	SearchResult result;
+	result.bestMove = NO_MOVE;
+	result.score = 0;
+	result.depth = 0;
+
+	int maxDepth = (limits.depth < MAX_PLY - 1 ? limits.depth : MAX_PLY - 1);
+
+	// There cannot be more lines than legal moves
+	MoveList rootMoves;
+	cb.generateLegalMoves(rootMoves);
+	int lineCount = max(1, min(limits.multiPV, rootMoves.size));
+
+	for (int depth = 1; depth <= maxDepth; depth++) {
+		TraceScope iteration("iteration", "search", "depth", depth);
+		Move previousBest = result.bestMove;
+		vector<PVLine> lines;
+		excludedRoot.clear();
+
+		// Each further line is the best move left once the earlier lines' moves are taken out
+		for (int index = 0; index < lineCount; index++) {
+			int score = alphaBeta(cb, depth, 0, -MATE_SCORE, MATE_SCORE);
+
+			// A line cut short by the node or time limit is only kept while there is nothing else
+			if (pvLength[0] == 0 || (stopped && (index > 0 || result.bestMove != NO_MOVE))) {
+				break;
+			}
+
+			PVLine line;
+			line.score = score;
+			line.depth = depth;
+			line.pv.assign(pv[0], pv[0] + pvLength[0]);
+			lines.push_back(line);
+			excludedRoot.push_back(pv[0][0]);
+
+			if (stopped) {
+				break;
+			}
+		}
+		excludedRoot.clear();
+
+		// A search cut short by the node limit is only kept if nothing has been found yet
+		if (stopped && result.bestMove != NO_MOVE && lines.empty()) {
+			break;
+		}
+
+		if (!lines.empty()) {
+			// Lines this iteration did not reach keep their previous results, after the new ones
+			for (const PVLine& old : result.lines) {
+				if ((int)lines.size() >= lineCount) {
+					break;
+				}
+				bool found = false;
+				for (const PVLine& line : lines) {
+					found = found || line.pv[0] == old.pv[0];
+				}
+				if (!found) {
+					lines.push_back(old);
+				}
+			}
+
+			result.lines = lines;
+			result.bestMove = lines[0].pv[0];
+			result.score = lines[0].score;
+			result.depth = depth;
+			result.pv = lines[0].pv;
+		}
+		if (stopped) {
+			break;
+		}
+
+		if (limits.onIteration) {
+			result.stats = stats;
+			result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			limits.onIteration(result);
+		}
+
+		if (result.score > MATE_BOUND || result.score < -MATE_BOUND) {
+			break;
+		}
+		if (timer && timer->stopAfterIteration(result.bestMove != previousBest)) {
+			break;
+		}
+	}
+
+	// Out of time before the first iteration found anything: any legal move beats none
+	if (result.bestMove == NO_MOVE) {
+		if (rootMoves.size > 0) {
+			result.bestMove = rootMoves.moves[0];
+			result.pv.assign(1, rootMoves.moves[0]);
+			result.lines.assign(1, PVLine { 0, 0, result.pv });
+		}
+	}
+
+	stats.pawnProbes = pawnCache.getProbes();
+	stats.pawnHits = pawnCache.getHits();
+	stats.evalProbes = evalCache.getProbes();
+	stats.evalHits = evalCache.getHits();
+
+	result.stats = stats;
+	result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	trace.setArg(stats.nodes);
+	return result;
+}
+
+// Quiescence search from the root with no node or time limit
+int Searcher::quiescenceSearch(ChessBoard& cb, vector<Move>& line) {
+
+	stats = SearchStats();
+	nodeLimit = 0;
+	timer = nullptr;
+	nextTimeCheck = 0;
+	stopped = false;
+
+	int score = quiescence(cb, 0, -MATE_SCORE, MATE_SCORE);
+	line.assign(pv[0], pv[0] + pvLength[0]);
+	return score;
+}
+
+// Checks the node limit, and the clock every TIME_CHECK_INTERVAL nodes
+bool Searcher::shouldStop() {
+	if (nodeLimit > 0 && stats.nodes >= nodeLimit) {
+		stopped = true;
+	}
+	if (timer && stats.nodes >= nextTimeCheck) {
+		nextTimeCheck = stats.nodes + TIME_CHECK_INTERVAL;
+		if (timer->hardLimitReached()) {
+			stopped = true;
+		}
+	}
+	return stopped;
+}
+
+// Negamax alpha-beta with transposition table and ordered moves
+int Searcher::alphaBeta(ChessBoard& cb, int depth, int ply, int alpha, int beta) {
+
+	if (depth <= 0 && useQuiescence) {
+		return quiescence(cb, ply, alpha, beta);
+	}
+
+	pvLength[ply] = 0;
+	stats.nodes++;
+
+	if (depth <= 0 || ply >= MAX_PLY) {
+		return staticEval(cb);
+	}
+	if (shouldStop()) {
+		return 0;
+	}
+
+	// Use a stored result if it was searched deep enough and settles this window
+	TTEntry entry;
+	Move ttMove = NO_MOVE;
+	if (tt.probe(cb.getKey(), entry)) {
+		ttMove = entry.move;
+		int ttScore = scoreFromTable(entry.score, ply);
+		if (ply > 0 && entry.depth >= depth
+				&& (entry.bound == BOUND_EXACT
+					|| (entry.bound == BOUND_LOWER && ttScore >= beta)
+					|| (entry.bound == BOUND_UPPER && ttScore <= alpha))) {
+			return ttScore;
+		}
+	}
+
+	int us = colourIndex(cb.getActiveColour());
+	MovePicker picker(cb, ordering ? ttMove : NO_MOVE, killers[ply], history[us], ordering);
+
+	int bestScore = -MATE_SCORE;
+	Move bestMove = NO_MOVE;
+	int originalAlpha = alpha;
+	int moveCount = 0;
+
+	Move move;
+	while ((move = picker.next()) != NO_MOVE) {
+
+		// Root moves that already have a line in a multi-PV search
+		if (ply == 0 && find(excludedRoot.begin(), excludedRoot.end(), move) != excludedRoot.end()) {
+			continue;
+		}
+
+		bool capture = cb.pieceAt(moveDest(move)) != nullptr;
+
+		MoveUndo undo = cb.doMove(move);
+		int score = -alphaBeta(cb, depth - 1, ply + 1, -beta, -alpha);
+		cb.undoMove(move, undo);
+		moveCount++;
+
+		if (stopped) {
+			return 0;
+		}
+
+		if (score > bestScore) {
+			bestScore = score;
+			bestMove = move;
+
+			if (score > alpha) {
+				alpha = score;
+
+				// Extend the principal variation with the child's line
+				pv[ply][0] = move;
+				memcpy(&pv[ply][1], pv[ply + 1], pvLength[ply + 1] * sizeof(Move));
+				pvLength[ply] = pvLength[ply + 1] + 1;
+			}
+		}
+
+		if (alpha >= beta) {
+			stats.cutoffs++;
+			if (moveCount == 1) {
+				stats.firstMoveCutoffs++;
+			}
+			if (!capture) {
+				updateQuietStats(cb, move, depth, ply);
+			}
+			break;
+		}
+	}
+
+	// No legal moves: checkmate (scored by distance so faster mates are preferred) or stalemate
+	if (moveCount == 0) {
+		return (cb.kingInCheck(cb.getActiveColour()) ? -MATE_SCORE + ply : 0);
+	}
+
+	// With root moves left out the result is not the root position's true score
+	if (ply > 0 || excludedRoot.empty()) {
+		Bound bound = (bestScore >= beta ? BOUND_LOWER : (bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER));
+		tt.store(cb.getKey(), bestMove, scoreToTable(bestScore, ply), depth, bound);
+	}
+
+	return bestScore;
+}
+
+// Capture search with stand pat, delta pruning and exchange pruning
+int Searcher::quiescence(ChessBoard& cb, int ply, int alpha, int beta) {
+
+	pvLength[ply] = 0;
+	stats.nodes++;
+	stats.qnodes++;
+
+	if (ply >= MAX_PLY) {
+		return staticEval(cb);
+	}
+	if (shouldStop()) {
+		return 0;
+	}
+
+	bool inCheck = cb.kingInCheck(cb.getActiveColour());
+	int bestScore = -MATE_SCORE;
+	int standPat = 0;
+
+	// Out of check the active player can decline every capture and keep the static score
+	if (!inCheck) {
+		standPat = staticEval(cb);
+		if (standPat >= beta) {
+			return standPat;
+		}
+		if (standPat > alpha) {
+			alpha = standPat;
+		}
+		bestScore = standPat;
+	}
+
+	// In check every evasion is needed to tell mate from an escape
+	MovePicker picker = (inCheck ? MovePicker(cb, NO_MOVE, nullptr, nullptr) : MovePicker(cb));
+	int moveCount = 0;
+
+	Move move;
+	while ((move = picker.next()) != NO_MOVE) {
+		moveCount++;
+
+		// Even winning the captured piece outright would leave the score below alpha
+		if (!inCheck) {
+			Piece* victim = cb.pieceAt(moveDest(move));
+			if (standPat + pieceValues[victim->getType()] + DELTA_MARGIN <= alpha) {
+				continue;
+			}
+		}
+
+		MoveUndo undo = cb.doMove(move);
+		int score = -quiescence(cb, ply + 1, -beta, -alpha);
+		cb.undoMove(move, undo);
+
+		if (stopped) {
+			return 0;
+		}
+
+		if (score > bestScore) {
+			bestScore = score;
+
+			if (score > alpha) {
+				alpha = score;
+
+				pv[ply][0] = move;
+				memcpy(&pv[ply][1], pv[ply + 1], pvLength[ply + 1] * sizeof(Move));
+				pvLength[ply] = pvLength[ply + 1] + 1;
+			}
+		}
+
+		if (alpha >= beta) {
+			break;
+		}
+	}
+
+	if (inCheck && moveCount == 0) {
+		return -MATE_SCORE + ply;
+	}
+
+	return bestScore;
+}
+
+// Evaluation cache first, then the evaluation with its pawn structure cache
+int Searcher::staticEval(const ChessBoard& cb) {
+
+	if (!useEvalCache) {
+		return evaluate(cb);
+	}
+
+	int score;
+	if (!evalCache.probe(cb.getKey(), score)) {
+		score = evaluate(cb, &pawnCache);
+		evalCache.store(cb.getKey(), score);
+	}
+	return score;
+}
+
+// Remembers a quiet move that caused a cutoff
+void Searcher::updateQuietStats(ChessBoard& cb, Move move, int depth, int ply) {
+
+	if (!ordering) {
+		return;
+	}
+
+	if (killers[ply][0] != move) {
+		killers[ply][1] = killers[ply][0];
+		killers[ply][0] = move;
+	}
+
+	int& score = history[colourIndex(cb.getActiveColour())][moveSource(move)][moveDest(move)];
+	score += depth * depth;
+
+	// Keep scores bounded by halving the whole table when one grows large
+	if (score > 1000000) {
+		for (int colour = 0; colour < 2; colour++) {
+			for (int source = 0; source < 64; source++) {
+				for (int dest = 0; dest < 64; dest++) {
+					history[colour][source][dest] /= 2;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#include "StaticExchange.h"
+
+using namespace std;
+
+/* Piece values for exchanges; the King is worth more than anything so it never takes into an attack */
+static const int exchangeValues[6] = { 20000, 900, 330, 500, 320, 100 };
+
+// Finds the least valuable piece in a set of attackers
+static int leastValuable(const ChessBoard& cb, Bitboard attackers, int& type) {
+
+	// Try the types from pawn up to king
+	static const int order[6] = { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
+
+	for (int i = 0; i < 6; i++) {
+		Bitboard pieces = attackers & (cb.getPieces('w', (PieceType)order[i]) | cb.getPieces('b', (PieceType)order[i]));
+		if (pieces) {
+			type = order[i];
+			return lowestSquare(pieces);
+		}
+	}
+	return -1;
+}
+
+// Swap algorithm over the sequence of least valuable recaptures
+int staticExchange(const ChessBoard& cb, Move move) {
+
+	int source = moveSource(move);
+	int dest = moveDest(move);
+
+	Piece* mover = cb.pieceAt(source);
+	Piece* victim = cb.pieceAt(dest);
+	if (!mover) {
+		return 0;
+	}
+
+	Bitboard diagonal = cb.getPieces('w', QUEEN) | cb.getPieces('b', QUEEN) | cb.getPieces('w', BISHOP) | cb.getPieces('b', BISHOP);
+	Bitboard straight = cb.getPieces('w', QUEEN) | cb.getPieces('b', QUEEN) | cb.getPieces('w', ROOK) | cb.getPieces('b', ROOK);
+
+	// gain[d] is the score for the side making the d-th capture if the exchange stopped after it
+	int gain[32];
+	int depth = 0;
+	gain[0] = (victim ? exchangeValues[victim->getType()] : 0);
+
+	Bitboard occupied = cb.getOccupied() & ~squareBit(source);
+	Bitboard attackers = cb.allAttackersTo(dest, occupied) & occupied;
+	int pieceOnSquare = mover->getType();
+	int side = 1 - colourIndex(mover->getColour());
+
+	while (depth < 31) {
+		char sideColour = (side == 0 ? 'w' : 'b');
+		Bitboard ours = attackers & cb.getPieces(sideColour);
+
+		int type;
+		int attacker = leastValuable(cb, ours, type);
+		if (attacker < 0) {
+			break;
+		}
+
+		// A King may only take if the other side has nothing left to recapture with
+		if (type == KING && (attackers & ~ours)) {
+			break;
+		}
+
+		depth++;
+		gain[depth] = exchangeValues[pieceOnSquare] - gain[depth - 1];
+		pieceOnSquare = type;
+
+		// Removing the attacker may uncover a slider behind it
+		occupied &= ~squareBit(attacker);
+		attackers |= (bishopAttacks(dest, occupied) & diagonal) | (rookAttacks(dest, occupied) & straight);
+		attackers &= occupied;
+
+		side = 1 - side;
+	}
+
+	// Each side stops capturing when it would do better by not continuing
+	while (depth > 0) {
+		int stand = -gain[depth - 1];
+		gain[depth - 1] = -(stand > gain[depth] ? stand : gain[depth]);
+		depth--;
+	}
+
+	return gain[0];
+}
+
+// Threshold version of the exchange evaluation
+bool staticExchangeAtLeast(const ChessBoard& cb, Move move, int threshold) {
+	return staticExchange(cb, move) >= threshold;
+}
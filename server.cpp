@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "AnalysisServer.h"
+#include "Json.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+using namespace std;
+
+/* Latencies kept for the percentiles; older ones are overwritten */
+static const size_t LATENCY_SAMPLES = 10000;
+
+/* Longest request line accepted before the client is disconnected */
+static const size_t MAX_REQUEST = 65536;
+
+/* Share of the time left before a deadline a search may use, leaving the rest for queueing the reply */
+static const double DEADLINE_SHARE = 0.9;
+
+/* Set by SIGINT and SIGTERM; run polls it */
+static volatile sig_atomic_t signalled = 0;
+
+static void onSignal(int) {
+	signalled = 1;
+}
+
+// Milliseconds between two times
+static double millisecondsBetween(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to) {
+	return chrono::duration<double, milli>(to - from).count();
+}
+
+// An error reply
+static string errorJson(const string& id, const string& message) {
+	return "{\"id\":" + id + ",\"error\":" + jsonString(message) + "}";
+}
+
+// Percentile of sorted samples
+static double percentile(const vector<double>& sorted, double fraction) {
+	if (sorted.empty()) {
+		return 0;
+	}
+	size_t index = (size_t)(fraction * (sorted.size() - 1) + 0.5);
+	return sorted[min(index, sorted.size() - 1)];
+}
+
+// AnalysisServer class implementation
+
+/* Writes one whole line, however many send calls it takes; a client that has gone away is ignored */
+void AnalysisServer::Connection::send(const string& line) {
+
+	lock_guard<mutex> guard(writeLock);
+	string data = line + "\n";
+	size_t sent = 0;
+	while (sent < data.size()) {
+		ssize_t count = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+		if (count <= 0) {
+			return;
+		}
+		sent += count;
+	}
+}
+
+/* Closes the socket once no reader or reply holds the connection */
+AnalysisServer::Connection::~Connection() {
+	close(fd);
+}
+
+// Higher priority first, then first queued
+bool AnalysisServer::JobOrder::operator()(const Job* a, const Job* b) const {
+	if (a->priority != b->priority) {
+		return a->priority > b->priority;
+	}
+	return a->sequence < b->sequence;
+}
+
+/* AnalysisServer constructor */
+AnalysisServer::AnalysisServer(const ServerOptions& serverOptions) : options(serverOptions) {
+	listenFd = -1;
+	stopping = false;
+	nextSequence = 0;
+	activeConnections = 0;
+
+	requests = 0;
+	coalesced = 0;
+	refused = 0;
+	expired = 0;
+	searches = 0;
+	latencyIndex = 0;
+}
+
+/* AnalysisServer destructor */
+AnalysisServer::~AnalysisServer() {
+	stop();
+}
+
+// Accepts clients until stopped, then winds down the workers and connections
+bool AnalysisServer::run() {
+
+	if (options.socketPath.size() >= sizeof(sockaddr_un().sun_path)) {
+		cerr << "Socket path too long: " << options.socketPath << endl;
+		return false;
+	}
+
+	listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenFd < 0) {
+		cerr << "Cannot create socket" << endl;
+		return false;
+	}
+
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, options.socketPath.c_str());
+
+	unlink(options.socketPath.c_str());
+	if (bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, 64) != 0) {
+		cerr << "Cannot listen on " << options.socketPath << ": " << strerror(errno) << endl;
+		close(listenFd);
+		listenFd = -1;
+		return false;
+	}
+
+	signalled = 0;
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	int threads = (options.threads > 0 ? options.threads : ThreadPool::hardwareThreads());
+	for (int i = 0; i < threads; i++) {
+		workers.push_back(thread(&AnalysisServer::workerLoop, this));
+	}
+
+	cerr << "Listening on " << options.socketPath << " with " << threads << " search threads" << endl;
+
+	// Poll with a timeout so a stop request or signal is noticed
+	while (!stopping) {
+		if (signalled) {
+			stop();
+			break;
+		}
+
+		pollfd listening = { listenFd, POLLIN, 0 };
+		if (poll(&listening, 1, 200) <= 0) {
+			continue;
+		}
+
+		int fd = accept(listenFd, nullptr, nullptr);
+		if (fd < 0) {
+			continue;
+		}
+
+		shared_ptr<Connection> connection(new Connection());
+		connection->fd = fd;
+		{
+			lock_guard<mutex> guard(lock);
+			connections.insert(connection);
+			activeConnections++;
+		}
+		thread(&AnalysisServer::serveConnection, this, connection).detach();
+	}
+
+	// Running searches finish and are answered before the clients are cut off
+	for (thread& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+
+	{
+		unique_lock<mutex> guard(lock);
+		for (const shared_ptr<Connection>& connection : connections) {
+			shutdown(connection->fd, SHUT_RDWR);
+		}
+		connectionsDone.wait(guard, [&] { return activeConnections == 0; });
+	}
+
+	close(listenFd);
+	listenFd = -1;
+	unlink(options.socketPath.c_str());
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+
+	cerr << statsJson() << endl;
+	return true;
+}
+
+// Answers everything still queued and wakes the workers so they exit
+void AnalysisServer::stop() {
+
+	vector<Waiter> dropped;
+	{
+		lock_guard<mutex> guard(lock);
+		if (stopping) {
+			return;
+		}
+		stopping = true;
+
+		for (Job* job : queue) {
+			dropped.insert(dropped.end(), job->waiters.begin(), job->waiters.end());
+			jobs.erase(job->key);
+		}
+		queue.clear();
+	}
+	jobReady.notify_all();
+
+	for (const Waiter& waiter : dropped) {
+		waiter.connection->send(errorJson(waiter.id, "shutting down"));
+	}
+}
+
+// Counters, queue state and latency percentiles
+string AnalysisServer::statsJson() {
+
+	lock_guard<mutex> guard(lock);
+
+	vector<double> queued = queueLatency;
+	vector<double> service = serviceLatency;
+	sort(queued.begin(), queued.end());
+	sort(service.begin(), service.end());
+
+	ostringstream json;
+	json << "{\"requests\":" << requests << ",\"searches\":" << searches << ",\"coalesced\":" << coalesced
+		<< ",\"refused\":" << refused << ",\"expired\":" << expired << ",\"queued\":" << queue.size()
+		<< ",\"running\":" << jobs.size() - queue.size();
+
+	const char* names[2] = { "queue_ms", "service_ms" };
+	const vector<double>* samples[2] = { &queued, &service };
+	for (int i = 0; i < 2; i++) {
+		json << ",\"" << names[i] << "\":{\"p50\":" << percentile(*samples[i], 0.5) << ",\"p90\":" << percentile(*samples[i], 0.9)
+			<< ",\"p99\":" << percentile(*samples[i], 0.99) << ",\"max\":" << (samples[i]->empty() ? 0 : samples[i]->back()) << "}";
+	}
+	json << "}";
+	return json.str();
+}
+
+// Splits the byte stream into lines and handles each one
+void AnalysisServer::serveConnection(shared_ptr<Connection> connection) {
+
+	setTraceThreadName("client connection " + to_string(connection->fd));
+	string pending;
+	char buffer[4096];
+
+	while (true) {
+		ssize_t count = recv(connection->fd, buffer, sizeof(buffer), 0);
+		if (count <= 0) {
+			break;
+		}
+		pending.append(buffer, count);
+
+		size_t newline;
+		while ((newline = pending.find('\n')) != string::npos) {
+			string line = pending.substr(0, newline);
+			pending.erase(0, newline + 1);
+			if (!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+			if (line.find_first_not_of(" \t") != string::npos) {
+				handleRequest(connection, line);
+			}
+		}
+
+		if (pending.size() > MAX_REQUEST) {
+			connection->send(errorJson("null", "request too long"));
+			break;
+		}
+	}
+
+	lock_guard<mutex> guard(lock);
+	connections.erase(connection);
+	activeConnections--;
+	connectionsDone.notify_all();
+}
+
+// Answers commands at once; joins a position to a queued or running search, or queues a new one
+void AnalysisServer::handleRequest(const shared_ptr<Connection>& connection, const string& line) {
+
+	TraceScope trace("request", "server");
+	map<string, string> fields;
+	if (!parseJsonObject(line, fields)) {
+		connection->send(errorJson("null", "malformed request"));
+		return;
+	}
+
+	string id = (fields.count("id") ? jsonString(fields["id"]) : "null");
+
+	if (fields["cmd"] == "stats") {
+		connection->send("{\"id\":" + id + ",\"stats\":" + statsJson() + "}");
+		return;
+	}
+	if (fields["cmd"] == "shutdown") {
+		connection->send("{\"id\":" + id + ",\"ok\":true}");
+		stop();
+		return;
+	}
+	if (!fields["cmd"].empty()) {
+		connection->send(errorJson(id, "unknown command " + fields["cmd"]));
+		return;
+	}
+
+	string fen = fields["fen"];
+	if (!ChessBoard::validFen(fen.c_str())) {
+		connection->send(errorJson(id, "invalid fen"));
+		return;
+	}
+
+	int depth = atoi(fields["depth"].c_str());
+	int moveTime = atoi(fields["movetime"].c_str());
+	uint64_t nodes = strtoull(fields["nodes"].c_str(), nullptr, 10);
+	int multiPV = max(1, atoi(fields["multipv"].c_str()));
+	if (depth <= 0 && moveTime <= 0 && nodes == 0) {
+		depth = options.defaultDepth;
+	}
+	depth = min(max(depth, 0), MAX_PLY - 1);
+	moveTime = max(moveTime, 0);
+
+	ChessBoard cb;
+	cb.setPosition(fen.c_str());
+
+	Waiter waiter;
+	waiter.connection = connection;
+	waiter.id = id;
+	waiter.priority = atoi(fields["priority"].c_str());
+	waiter.received = Clock::now();
+	int deadline = atoi(fields["deadline"].c_str());
+	waiter.deadline = (deadline > 0 ? waiter.received + chrono::milliseconds(deadline) : Clock::time_point::max());
+	waiter.coalesced = false;
+
+	JobKey key(cb.getKey(), depth, moveTime, nodes, multiPV);
+
+	{
+		lock_guard<mutex> guard(lock);
+		requests++;
+
+		if (!stopping) {
+			auto found = jobs.find(key);
+			if (found != jobs.end()) {
+				Job* job = found->second.get();
+				waiter.coalesced = true;
+				coalesced++;
+
+				// A queued search moves up to the priority of its most urgent request
+				if (!job->running && waiter.priority > job->priority) {
+					queue.erase(job);
+					job->priority = waiter.priority;
+					queue.insert(job);
+				}
+				job->waiters.push_back(waiter);
+				return;
+			}
+
+			if (queue.size() < options.maxQueue) {
+				shared_ptr<Job> job(new Job());
+				job->key = key;
+				job->fen = fen;
+				job->depth = depth;
+				job->moveTime = moveTime;
+				job->nodes = nodes;
+				job->multiPV = multiPV;
+				job->priority = waiter.priority;
+				job->sequence = nextSequence++;
+				job->running = false;
+				job->waiters.push_back(waiter);
+
+				jobs[key] = job;
+				queue.insert(job.get());
+				jobReady.notify_one();
+				return;
+			}
+			refused++;
+		}
+	}
+
+	connection->send(errorJson(id, stopping ? "shutting down" : "busy"));
+}
+
+// Runs the most urgent queued search, dropping requests whose deadline has passed
+void AnalysisServer::workerLoop() {
+
+	setTraceThreadName("analysis worker");
+	Searcher searcher(options.hashMegabytes);
+
+	while (true) {
+		unique_lock<mutex> guard(lock);
+		jobReady.wait(guard, [&] { return stopping || !queue.empty(); });
+		if (stopping) {
+			return;
+		}
+
+		Job* job = *queue.begin();
+		queue.erase(queue.begin());
+		shared_ptr<Job> held = jobs[job->key];
+
+		Clock::time_point now = Clock::now();
+		vector<Waiter> late;
+		Clock::time_point earliest = Clock::time_point::max();
+		for (size_t i = 0; i < job->waiters.size(); ) {
+			if (job->waiters[i].deadline <= now) {
+				late.push_back(job->waiters[i]);
+				job->waiters.erase(job->waiters.begin() + i);
+			}
+			else {
+				earliest = min(earliest, job->waiters[i].deadline);
+				i++;
+			}
+		}
+		expired += late.size();
+
+		bool search = !job->waiters.empty();
+		if (search) {
+			job->running = true;
+			job->started = now;
+			searches++;
+		}
+		else {
+			jobs.erase(job->key);
+		}
+		guard.unlock();
+
+		for (const Waiter& waiter : late) {
+			waiter.connection->send(errorJson(waiter.id, "deadline expired"));
+		}
+		if (!search) {
+			continue;
+		}
+
+		ChessBoard cb;
+		cb.setPosition(job->fen.c_str());
+
+		SearchLimits limits;
+		if (job->depth > 0) {
+			limits.depth = job->depth;
+		}
+		limits.nodes = job->nodes;
+		limits.multiPV = job->multiPV;
+
+		// The search has to be answered before the most urgent deadline
+		TimeControl tc;
+		tc.moveTime = job->moveTime / 1000.0;
+		if (earliest != Clock::time_point::max()) {
+			double budget = DEADLINE_SHARE * millisecondsBetween(now, earliest) / 1000;
+			if (tc.moveTime <= 0 || budget < tc.moveTime) {
+				tc.moveTime = max(budget, 0.001);
+			}
+		}
+		TimeManager timer(tc);
+		if (tc.moveTime > 0) {
+			limits.time = &timer;
+		}
+
+		SearchResult result = searcher.search(cb, limits);
+
+		ostringstream body;
+		body << ",\"fen\":" << jsonString(job->fen) << "," << resultJson(cb, result)
+			<< ",\"nodes\":" << result.stats.nodes;
+		string reply = body.str();
+
+		// Requests that joined while the search ran are answered too
+		guard.lock();
+		vector<Waiter> waiters;
+		waiters.swap(job->waiters);
+		jobs.erase(job->key);
+
+		Clock::time_point done = Clock::now();
+		vector<string> replies;
+		for (const Waiter& waiter : waiters) {
+			double queued = max(0.0, millisecondsBetween(waiter.received, job->started));
+			double service = millisecondsBetween(waiter.received, done);
+			recordLatency(queued, service);
+
+			ostringstream json;
+			json << "{\"id\":" << waiter.id << reply << ",\"coalesced\":" << (waiter.coalesced ? "true" : "false")
+				<< ",\"queued_ms\":" << queued << ",\"service_ms\":" << service << "}";
+			replies.push_back(json.str());
+		}
+		guard.unlock();
+
+		for (size_t i = 0; i < waiters.size(); i++) {
+			waiters[i].connection->send(replies[i]);
+		}
+	}
+}
+
+// Keeps the most recent LATENCY_SAMPLES latencies
+void AnalysisServer::recordLatency(double queuedMs, double serviceMs) {
+	if (queueLatency.size() < LATENCY_SAMPLES) {
+		queueLatency.push_back(queuedMs);
+		serviceLatency.push_back(serviceMs);
+	}
+	else {
+		queueLatency[latencyIndex] = queuedMs;
+		serviceLatency[latencyIndex] = serviceMs;
+		latencyIndex = (latencyIndex + 1) % LATENCY_SAMPLES;
+	}
+}
@@ -0,0 +1,147 @@
+#include "ThreadPool.h"
+#include "Trace.h"
+
+using namespace std;
+
+// ThreadPool class implementation
+
+/* Index of the pool worker running on this thread, -1 for other threads */
+static thread_local int currentWorker = -1;
+
+/* ThreadPool constructor */
+ThreadPool::ThreadPool(int threadCount) : queues(threadCount > 0 ? threadCount : hardwareThreads()) {
+
+	pending = 0;
+	queued = 0;
+	stolen = 0;
+	nextQueue = 0;
+	stopping = false;
+
+	for (size_t i = 0; i < queues.size(); i++) {
+		workers.push_back(thread(&ThreadPool::workerLoop, this, (int)i));
+	}
+}
+
+/* ThreadPool destructor */
+ThreadPool::~ThreadPool() {
+
+	wait();
+
+	{
+		lock_guard<mutex> guard(sleepLock);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+
+	for (thread& worker : workers) {
+		worker.join();
+	}
+}
+
+// Queues a task on the calling worker's queue, or the next queue in turn
+void ThreadPool::submit(function<void()> task) {
+
+	int index = currentWorker;
+	if (index < 0 || index >= (int)queues.size()) {
+		index = nextQueue++ % queues.size();
+	}
+
+	pending++;
+	{
+		lock_guard<mutex> guard(queues[index].lock);
+		queues[index].tasks.push_back(move(task));
+	}
+	queued++;
+
+	// Take the sleep lock so a worker about to sleep cannot miss the notification
+	{
+		lock_guard<mutex> guard(sleepLock);
+	}
+	workAvailable.notify_one();
+}
+
+// Waits until no tasks are left
+void ThreadPool::wait() {
+
+	unique_lock<mutex> guard(sleepLock);
+	allDone.wait(guard, [this] { return pending == 0; });
+}
+
+// Returns the number of workers
+int ThreadPool::size() const {
+	return queues.size();
+}
+
+// Returns the calling worker's index
+int ThreadPool::workerIndex() {
+	return currentWorker;
+}
+
+// Returns the number of stolen tasks
+long ThreadPool::stolenTasks() const {
+	return stolen;
+}
+
+// Returns the number of hardware threads
+int ThreadPool::hardwareThreads() {
+	int count = thread::hardware_concurrency();
+	return (count > 0 ? count : 1);
+}
+
+// Runs tasks until the pool is destroyed
+void ThreadPool::workerLoop(int index) {
+
+	currentWorker = index;
+	setTraceThreadName("pool worker " + to_string(index));
+
+	while (true) {
+		function<void()> task;
+
+		if (takeTask(index, task)) {
+			{
+				TraceScope trace("task", "threads");
+				task();
+			}
+
+			if (--pending == 0) {
+				lock_guard<mutex> guard(sleepLock);
+				allDone.notify_all();
+			}
+			continue;
+		}
+
+		unique_lock<mutex> guard(sleepLock);
+		workAvailable.wait(guard, [this] { return stopping || queued > 0; });
+		if (stopping && queued == 0) {
+			return;
+		}
+	}
+}
+
+// Pops from the back of the worker's own queue, otherwise steals from the front of another
+bool ThreadPool::takeTask(int index, function<void()>& task) {
+
+	int count = queues.size();
+
+	for (int i = 0; i < count; i++) {
+		WorkQueue& queue = queues[(index + i) % count];
+		lock_guard<mutex> guard(queue.lock);
+
+		if (queue.tasks.empty()) {
+			continue;
+		}
+
+		if (i == 0) {
+			task = move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else {
+			task = move(queue.tasks.front());
+			queue.tasks.pop_front();
+			stolen++;
+		}
+		queued--;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,78 @@
+#include "TimeManager.h"
+
+using namespace std;
+
+/* Share of the soft limit to use after a number of iterations in a row with the same best move */
+static const double stabilityScale[] = { 1.0, 0.85, 0.7, 0.6, 0.5 };
+static const int stabilitySteps = sizeof(stabilityScale) / sizeof(stabilityScale[0]);
+
+// TimeManager class implementation
+
+/* TimeManager constructor */
+TimeManager::TimeManager(const TimeControl& tc) {
+
+	start = chrono::steady_clock::now();
+	stableIterations = 0;
+
+	if (tc.moveTime > 0) {
+		hardLimit = tc.moveTime - tc.overhead;
+		softLimit = hardLimit;
+	}
+	else {
+		double available = tc.timeLeft - tc.overhead;
+
+		// With no moves-to-go, plan as if the game lasts another 30 moves
+		int movesLeft = (tc.movesToGo > 0 ? (tc.movesToGo < 40 ? tc.movesToGo : 40) : 30);
+
+		softLimit = available / movesLeft + tc.increment * 0.75;
+
+		// A hard limit of a few soft limits allows for a difficult move without risking the clock
+		hardLimit = softLimit * 4;
+		if (hardLimit > available * 0.8) {
+			hardLimit = available * 0.8;
+		}
+		if (softLimit > hardLimit) {
+			softLimit = hardLimit;
+		}
+	}
+
+	if (hardLimit < 0) {
+		hardLimit = 0;
+	}
+	if (softLimit < 0) {
+		softLimit = 0;
+	}
+}
+
+// Seconds since construction
+double TimeManager::elapsed() const {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Checks the hard limit
+bool TimeManager::hardLimitReached() const {
+	return elapsed() >= hardLimit;
+}
+
+// A stable best move means less to gain from searching deeper
+bool TimeManager::stopAfterIteration(bool bestMoveChanged) {
+
+	if (bestMoveChanged) {
+		stableIterations = 0;
+	}
+	else if (stableIterations < stabilitySteps - 1) {
+		stableIterations++;
+	}
+
+	return elapsed() >= softLimit * stabilityScale[stableIterations];
+}
+
+// Returns the soft limit
+double TimeManager::getSoftLimit() const {
+	return softLimit;
+}
+
+// Returns the hard limit
+double TimeManager::getHardLimit() const {
+	return hardLimit;
+}
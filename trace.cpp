@@ -0,0 +1,218 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "Trace.h"
+
+using namespace std;
+
+atomic<bool> traceEnabled(false);
+
+/*
+ * One recorded scope. A slot may be copied by writeTrace while its thread
+ * overwrites it, so every field is atomic and the copy is checked against the
+ * sequence: 2 * index + 1 while event number index is being written, 2 * index + 2 once it is complete.
+ */
+struct TraceSlot {
+	atomic<uint64_t> sequence;
+	atomic<const char*> name;
+	atomic<const char*> category;
+	atomic<const char*> argName;
+	atomic<int64_t> argValue;
+	atomic<uint64_t> start;
+	atomic<uint64_t> duration;
+	atomic<uint32_t> thread;
+};
+
+/* A ring of events written by one thread at a time */
+struct TraceBuffer {
+	TraceSlot slots[TRACE_BUFFER_EVENTS];
+
+	/* Events written so far; event i is in slots[i % TRACE_BUFFER_EVENTS] */
+	atomic<uint64_t> head;
+
+	/* Held by a running thread; a thread that exits hands its buffer, and the events in it, on to the next new one */
+	atomic<bool> inUse;
+
+	/* Trace thread number of every thread that holds the buffer, so there is one per buffer */
+	uint32_t thread;
+};
+
+/* Every buffer ever claimed and the names of the threads holding them by thread number, guarded by traceLock */
+static mutex traceLock;
+static vector<TraceBuffer*> traceBuffers;
+static map<uint32_t, string> threadNames;
+
+/* The calling thread's trace number and buffer, claimed on first use */
+struct ThreadTrace {
+	uint32_t thread = 0;
+	TraceBuffer* buffer = nullptr;
+
+	~ThreadTrace() {
+		if (buffer) {
+			buffer->inUse = false;
+		}
+	}
+};
+
+static thread_local ThreadTrace threadTrace;
+
+// Claims a free buffer for the calling thread, or a new one if all are held
+static ThreadTrace& currentThread() {
+
+	if (threadTrace.buffer) {
+		return threadTrace;
+	}
+
+	// A handed back buffer drops the name of the thread that exited, so names never outnumber buffers
+	lock_guard<mutex> guard(traceLock);
+	for (TraceBuffer* buffer : traceBuffers) {
+		bool expected = false;
+		if (buffer->inUse.compare_exchange_strong(expected, true)) {
+			threadNames.erase(buffer->thread);
+			threadTrace.buffer = buffer;
+			threadTrace.thread = buffer->thread;
+			return threadTrace;
+		}
+	}
+
+	TraceBuffer* buffer = new TraceBuffer;
+	buffer->head = 0;
+	buffer->inUse = true;
+	buffer->thread = traceBuffers.size() + 1;
+	for (TraceSlot& slot : buffer->slots) {
+		slot.sequence = 0;
+	}
+	traceBuffers.push_back(buffer);
+	threadTrace.buffer = buffer;
+	threadTrace.thread = buffer->thread;
+	return threadTrace;
+}
+
+// Quotes a name for JSON
+static string quoted(const char* text) {
+	string result = "\"";
+	for (const char* c = text; *c; c++) {
+		if (*c == '"' || *c == '\\') {
+			result += '\\';
+		}
+		if ((unsigned char)*c >= 0x20) {
+			result += *c;
+		}
+	}
+	return result + "\"";
+}
+
+// Turns tracing on or off
+void enableTracing(bool enabled) {
+	traceClock();
+	traceEnabled = enabled;
+}
+
+// Nanoseconds since the first call, plus one so that 0 can mean "not traced"
+uint64_t traceClock() {
+	static const chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count() + 1;
+}
+
+// Writes one event into the calling thread's ring, overwriting the oldest when it is full
+void traceEvent(const char* name, const char* category, uint64_t start, uint64_t end, const char* argName, int64_t argValue) {
+
+	ThreadTrace& trace = currentThread();
+	TraceBuffer* buffer = trace.buffer;
+
+	uint64_t index = buffer->head.load(memory_order_relaxed);
+	TraceSlot& slot = buffer->slots[index % TRACE_BUFFER_EVENTS];
+
+	slot.sequence.store(2 * index + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	slot.name.store(name, memory_order_relaxed);
+	slot.category.store(category, memory_order_relaxed);
+	slot.argName.store(argName, memory_order_relaxed);
+	slot.argValue.store(argValue, memory_order_relaxed);
+	slot.start.store(start, memory_order_relaxed);
+	slot.duration.store(end - start, memory_order_relaxed);
+	slot.thread.store(trace.thread, memory_order_relaxed);
+
+	slot.sequence.store(2 * index + 2, memory_order_release);
+	buffer->head.store(index + 1, memory_order_release);
+}
+
+// Names the calling thread's buffer, claiming it now; with tracing off nothing is taken
+void setTraceThreadName(const string& name) {
+
+	if (!tracingEnabled()) {
+		return;
+	}
+
+	uint32_t thread = currentThread().thread;
+	lock_guard<mutex> guard(traceLock);
+	threadNames[thread] = name;
+}
+
+// Copies each ring's complete events, skipping any overwritten while being copied
+bool writeTrace(const string& path, size_t& events) {
+
+	events = 0;
+	ofstream out(path);
+	if (!out) {
+		cerr << "Cannot write " << path << endl;
+		return false;
+	}
+
+	lock_guard<mutex> guard(traceLock);
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+
+	for (const auto& entry : threadNames) {
+		out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << entry.first
+			<< ",\"args\":{\"name\":" << quoted(entry.second.c_str()) << "}}";
+		first = false;
+	}
+
+	for (TraceBuffer* buffer : traceBuffers) {
+		uint64_t head = buffer->head.load(memory_order_acquire);
+		uint64_t oldest = (head > TRACE_BUFFER_EVENTS ? head - TRACE_BUFFER_EVENTS : 0);
+
+		for (uint64_t index = oldest; index < head; index++) {
+			TraceSlot& slot = buffer->slots[index % TRACE_BUFFER_EVENTS];
+
+			uint64_t before = slot.sequence.load(memory_order_acquire);
+			const char* name = slot.name.load(memory_order_relaxed);
+			const char* category = slot.category.load(memory_order_relaxed);
+			const char* argName = slot.argName.load(memory_order_relaxed);
+			int64_t argValue = slot.argValue.load(memory_order_relaxed);
+			uint64_t start = slot.start.load(memory_order_relaxed);
+			uint64_t duration = slot.duration.load(memory_order_relaxed);
+			uint32_t thread = slot.thread.load(memory_order_relaxed);
+			atomic_thread_fence(memory_order_acquire);
+			if (before != 2 * index + 2 || slot.sequence.load(memory_order_relaxed) != before) {
+				continue;
+			}
+
+			char times[64];
+			snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", start / 1000.0, duration / 1000.0);
+			out << (first ? "" : ",\n") << "{\"name\":" << quoted(name) << ",\"cat\":" << quoted(category)
+				<< ",\"ph\":\"X\"," << times << ",\"pid\":1,\"tid\":" << thread;
+			if (argName) {
+				out << ",\"args\":{" << quoted(argName) << ":" << argValue << "}";
+			}
+			out << "}";
+			first = false;
+			events++;
+		}
+	}
+
+	out << "\n]}\n";
+	if (!out) {
+		cerr << "Cannot write " << path << endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <iostream>
+
+#include "TrainingData.h"
+
+using namespace std;
+
+// Spreads the piece bitboards into a code per square, then walks the occupied squares in order
+bool packTrainingRecord(const ChessBoard& cb, int score, int result, int ply, TrainingRecord& record) {
+
+	if (popCount(cb.getOccupied()) > 32) {
+		return false;
+	}
+
+	uint8_t codes[64];
+	for (int code = 0; code < 12; code++) {
+		Bitboard pieces = cb.getPieces(code < 6 ? 'w' : 'b', (PieceType)(code % 6));
+		while (pieces) {
+			codes[popLowestSquare(pieces)] = code;
+		}
+	}
+
+	record.occupied = cb.getOccupied();
+	for (int i = 0; i < 16; i++) {
+		record.pieces[i] = 0;
+	}
+
+	Bitboard squares = record.occupied;
+	int index = 0;
+	while (squares) {
+		record.pieces[index >> 1] |= codes[popLowestSquare(squares)] << ((index & 1) * 4);
+		index++;
+	}
+
+	record.score = (int16_t)(score > 32767 ? 32767 : (score < -32768 ? -32768 : score));
+	record.result = (int8_t)result;
+	record.sideToMove = (cb.getActiveColour() == 'w' ? 0 : 1);
+	record.ply = (uint16_t)ply;
+	record.reserved = 0;
+	return true;
+}
+
+// Spreads the codes over the squares in packed form, whose codes are the record codes plus one
+static bool packedFromRecord(const TrainingRecord& record, PackedPosition& packed) {
+
+	if (popCount(record.occupied) > 32 || record.sideToMove > 1) {
+		return false;
+	}
+
+	for (int i = 0; i < 32; i++) {
+		packed.squares[i] = 0;
+	}
+
+	// Codes 12 to 15 fit in a nibble but name no piece
+	Bitboard squares = record.occupied;
+	int index = 0;
+	while (squares) {
+		int square = popLowestSquare(squares);
+		int code = (record.pieces[index >> 1] >> ((index & 1) * 4)) & 15;
+		if (code >= 12) {
+			return false;
+		}
+		packed.squares[square >> 1] |= (code + 1) << ((square & 1) * 4);
+		index++;
+	}
+	packed.activeColour = (record.sideToMove ? 'b' : 'w');
+	return true;
+}
+
+// The record layout is checked here, the pieces by the board's own check
+bool validTrainingRecord(const TrainingRecord& record) {
+	PackedPosition packed;
+	return packedFromRecord(record, packed) && ChessBoard::validPacked(packed);
+}
+
+// Rebuilds the board through its packed form
+bool unpackTrainingRecord(const TrainingRecord& record, ChessBoard& cb) {
+
+	PackedPosition packed;
+	if (!packedFromRecord(record, packed) || !ChessBoard::validPacked(packed)) {
+		return false;
+	}
+
+	cb.unpackState(packed);
+	return true;
+}
+
+// The file if it exists, otherwise its shards up to the first missing number
+bool trainingDataFiles(const string& path, vector<string>& files) {
+
+	files.clear();
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file) {
+		fclose(file);
+		files.push_back(path);
+		return true;
+	}
+
+	for (int shard = 0; ; shard++) {
+		char suffix[16];
+		snprintf(suffix, sizeof(suffix), "-%05d", shard);
+		file = fopen((path + suffix).c_str(), "rb");
+		if (!file) {
+			break;
+		}
+		fclose(file);
+		files.push_back(path + suffix);
+	}
+
+	if (files.empty()) {
+		cerr << "Cannot open " << path << endl;
+		return false;
+	}
+	return true;
+}
+
+// TrainingWriter class implementation
+
+/* TrainingWriter constructor */
+TrainingWriter::TrainingWriter(const string& path, uint64_t shard, size_t bufferRecords, bool shuffleRecords, uint64_t seed) : random(seed) {
+
+	basePath = path;
+	shardRecords = shard;
+	shuffle = shuffleRecords;
+	bufferSize = (bufferRecords < 1 ? 1 : bufferRecords);
+	buffer.reserve(bufferSize);
+
+	file = nullptr;
+	files = 0;
+	inShard = 0;
+	records = 0;
+	failed = false;
+}
+
+/* TrainingWriter destructor */
+TrainingWriter::~TrainingWriter() {
+	close();
+}
+
+// Buffers a record, writing the buffer out when it is full
+bool TrainingWriter::add(const TrainingRecord& record) {
+
+	buffer.push_back(record);
+	records++;
+
+	if (buffer.size() >= bufferSize) {
+		return flush();
+	}
+	return !failed;
+}
+
+// Writes the remaining records and closes the file
+bool TrainingWriter::close() {
+
+	flush();
+	if (file) {
+		if (fclose(file) != 0 && !failed) {
+			cerr << "Cannot write training data" << endl;
+			failed = true;
+		}
+		file = nullptr;
+	}
+	return !failed;
+}
+
+// Number of records added
+uint64_t TrainingWriter::getRecords() const {
+	return records;
+}
+
+// Number of files opened
+int TrainingWriter::getFiles() const {
+	return files;
+}
+
+// Writes the buffer in as few calls as the shard boundaries allow
+bool TrainingWriter::flush() {
+
+	if (failed) {
+		buffer.clear();
+		return false;
+	}
+
+	if (shuffle) {
+		std::shuffle(buffer.begin(), buffer.end(), random);
+	}
+
+	size_t written = 0;
+	while (written < buffer.size()) {
+		if (!file || (shardRecords > 0 && inShard >= shardRecords)) {
+			if (!openFile()) {
+				buffer.clear();
+				return false;
+			}
+		}
+
+		size_t count = buffer.size() - written;
+		if (shardRecords > 0 && count > shardRecords - inShard) {
+			count = shardRecords - inShard;
+		}
+
+		if (fwrite(&buffer[written], sizeof(TrainingRecord), count, file) != count) {
+			cerr << "Cannot write training data" << endl;
+			failed = true;
+			buffer.clear();
+			return false;
+		}
+		written += count;
+		inShard += count;
+	}
+
+	buffer.clear();
+	return true;
+}
+
+// Closes the current file and opens the next one
+bool TrainingWriter::openFile() {
+
+	if (file) {
+		fclose(file);
+		file = nullptr;
+	}
+
+	string path = basePath;
+	if (shardRecords > 0) {
+		char suffix[16];
+		snprintf(suffix, sizeof(suffix), "-%05d", files);
+		path += suffix;
+	}
+
+	file = fopen(path.c_str(), "wb");
+	if (!file) {
+		cerr << "Cannot open " << path << endl;
+		failed = true;
+		return false;
+	}
+
+	// The records are already gathered into large blocks, so stdio buffering would only add a copy
+	setvbuf(file, nullptr, _IONBF, 0);
+
+	files++;
+	inShard = 0;
+	return true;
+}
@@ -0,0 +1,60 @@
+#include "TranspositionTable.h"
+
+using namespace std;
+
+// TranspositionTable class implementation
+
+/* TranspositionTable constructor */
+TranspositionTable::TranspositionTable(size_t megabytes) {
+
+	size_t count = 1;
+	while (count * 2 * sizeof(TTEntry) <= megabytes * 1024 * 1024) {
+		count *= 2;
+	}
+
+	entries.resize(count);
+	mask = count - 1;
+	clear();
+}
+
+// Finds a stored result
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+
+	const TTEntry& slot = entries[key & mask];
+	if (slot.key != key || slot.bound == BOUND_NONE) {
+		return false;
+	}
+	entry = slot;
+	return true;
+}
+
+// Stores a result, keeping a deeper result for another position
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, Bound bound) {
+
+	TTEntry& slot = entries[key & mask];
+
+	if (slot.key != key && slot.bound != BOUND_NONE && slot.depth > depth) {
+		return;
+	}
+	// Keep the old best move if this search did not find one
+	if (move == NO_MOVE && slot.key == key) {
+		move = slot.move;
+	}
+
+	slot.key = key;
+	slot.move = move;
+	slot.score = score;
+	slot.depth = depth;
+	slot.bound = bound;
+}
+
+// Empties the table
+void TranspositionTable::clear() {
+	for (TTEntry& entry : entries) {
+		entry.key = 0;
+		entry.move = NO_MOVE;
+		entry.bound = BOUND_NONE;
+		entry.depth = 0;
+		entry.score = 0;
+	}
+}
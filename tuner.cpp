@@ -0,0 +1,382 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "Evaluation.h"
+#include "Search.h"
+#include "ThreadPool.h"
+#include "Tuner.h"
+
+using namespace std;
+
+/* Records read from a file at a time before they are reduced to TunePositions */
+static const size_t LOAD_BATCH = 1 << 20;
+
+/* Slices of the positions per worker thread, so a slow slice does not hold up an epoch */
+static const int SLICES_PER_THREAD = 4;
+
+/* Adam decay rates of the moment estimates, and the term keeping the step finite */
+static const double ADAM_BETA1 = 0.9;
+static const double ADAM_BETA2 = 0.999;
+static const double ADAM_EPSILON = 1e-8;
+
+// Appends a feature unless its coefficient is 0
+static void addFeature(TunePosition& position, int& count, int index, int coefficient) {
+	if (coefficient != 0) {
+		position.features[count] = index;
+		position.coefficients[count] = coefficient;
+		count++;
+	}
+}
+
+// The weights the evaluation of a position reads, in the order of the weight array
+static void collectFeatures(const ChessBoard& cb, TunePosition& position) {
+
+	memset(position.features, 0, sizeof(position.features));
+	memset(position.coefficients, 0, sizeof(position.coefficients));
+	int count = 0;
+
+	// Both sides always have one King, so its material weight never counts
+	for (int type = QUEEN; type <= PAWN; type++) {
+		int difference = popCount(cb.getPieces('w', (PieceType)type)) - popCount(cb.getPieces('b', (PieceType)type));
+		addFeature(position, count, TUNE_MATERIAL + type, difference);
+	}
+
+	// Black reads the piece-square tables with the row flipped
+	for (int type = 0; type < 6; type++) {
+		Bitboard white = cb.getPieces('w', (PieceType)type);
+		Bitboard black = cb.getPieces('b', (PieceType)type);
+		while (white) {
+			addFeature(position, count, TUNE_PIECE_SQUARE + type * 64 + popLowestSquare(white), 1);
+		}
+		while (black) {
+			addFeature(position, count, TUNE_PIECE_SQUARE + type * 64 + (popLowestSquare(black) ^ 56), -1);
+		}
+	}
+
+	PawnTermCounts counts;
+	countPawnTerms(cb, counts);
+	addFeature(position, count, TUNE_DOUBLED, counts.doubled);
+	addFeature(position, count, TUNE_ISOLATED, counts.isolated);
+	addFeature(position, count, TUNE_BACKWARD, counts.backward);
+	for (int rank = 0; rank < 8; rank++) {
+		addFeature(position, count, TUNE_PASSED + rank, counts.passed[rank]);
+	}
+}
+
+// Evaluation of a position with a set of weights, from White's side
+static double positionEval(const TunePosition& position, const double* weights) {
+	double score = 0;
+	for (int f = 0; f < TUNE_FEATURES; f++) {
+		score += weights[position.features[f]] * position.coefficients[f];
+	}
+	return score;
+}
+
+// Adds factor times the position's coefficient of each weight to the gradient
+static void addGradient(const TunePosition& position, double factor, double* gradient) {
+	for (int f = 0; f < TUNE_FEATURES; f++) {
+		gradient[position.features[f]] += factor * position.coefficients[f];
+	}
+}
+
+// Natural-log slope of the win probability for a scaling constant K given in the base 10 / 400 form
+static double sigmoidSlope(double scalingK) {
+	return scalingK * log(10.0) / 400;
+}
+
+
+// Tuner class implementation
+
+/* Tuner constructor */
+Tuner::Tuner(const TuneOptions& options)
+	: options(options), threads(options.threads > 0 ? options.threads : ThreadPool::hardwareThreads()), pool(threads),
+	weights(TUNE_PARAMETERS), firstMoment(TUNE_PARAMETERS), secondMoment(TUNE_PARAMETERS) {
+
+	scalingK = options.scalingK;
+	steps = 0;
+	invalidRecords = 0;
+
+	for (int type = 0; type < 6; type++) {
+		weights[TUNE_MATERIAL + type] = pieceValues[type];
+		for (int square = 0; square < 64; square++) {
+			weights[TUNE_PIECE_SQUARE + type * 64 + square] = pieceSquare[type][square];
+		}
+	}
+	weights[TUNE_DOUBLED] = DOUBLED_PAWN;
+	weights[TUNE_ISOLATED] = ISOLATED_PAWN;
+	weights[TUNE_BACKWARD] = BACKWARD_PAWN;
+	for (int rank = 0; rank < 8; rank++) {
+		weights[TUNE_PASSED + rank] = passedPawn[rank];
+	}
+}
+
+// Reads a file, or its shards, a batch at a time
+bool Tuner::load(const string& path) {
+
+	vector<string> files;
+	if (!trainingDataFiles(path, files)) {
+		return false;
+	}
+
+	vector<TrainingRecord> records(LOAD_BATCH);
+	for (const string& name : files) {
+		FILE* file = fopen(name.c_str(), "rb");
+		if (!file) {
+			cerr << "Cannot open " << name << endl;
+			return false;
+		}
+
+		while (options.limit == 0 || positions.size() < options.limit) {
+			size_t wanted = LOAD_BATCH;
+			if (options.limit > 0 && options.limit - positions.size() < wanted) {
+				wanted = options.limit - positions.size();
+			}
+			size_t count = fread(records.data(), sizeof(TrainingRecord), wanted, file);
+			if (count == 0) {
+				break;
+			}
+			records.resize(count);
+			addRecords(records);
+			records.resize(LOAD_BATCH);
+		}
+		fclose(file);
+	}
+	return true;
+}
+
+// Each worker resolves a slice with its own Searcher; slices are appended in file order
+void Tuner::addRecords(const vector<TrainingRecord>& records) {
+
+	int slices = threads * SLICES_PER_THREAD;
+	vector<vector<TunePosition>> resolved(slices);
+	vector<size_t> invalid(slices, 0);
+
+	for (int slice = 0; slice < slices; slice++) {
+		pool.submit([&, slice]() {
+			size_t begin = records.size() * slice / slices;
+			size_t end = records.size() * (slice + 1) / slices;
+
+			// The evaluation cache would only hold positions seen once
+			Searcher searcher(1);
+			searcher.setEvalCache(false);
+			vector<Move> line;
+
+			for (size_t r = begin; r < end; r++) {
+				ChessBoard cb;
+				if (!unpackTrainingRecord(records[r], cb)) {
+					invalid[slice]++;
+					continue;
+				}
+
+				MoveList moves;
+				cb.generateLegalMoves(moves);
+				if (moves.size == 0) {
+					continue;
+				}
+
+				if (options.quiescence) {
+					int score = searcher.quiescenceSearch(cb, line);
+					if (score > MATE_BOUND || score < -MATE_BOUND) {
+						continue;
+					}
+					for (Move move : line) {
+						cb.doMove(move);
+					}
+				}
+
+				TunePosition position;
+				collectFeatures(cb, position);
+				position.result = records[r].result;
+				position.reserved = 0;
+				resolved[slice].push_back(position);
+			}
+		});
+	}
+	pool.wait();
+
+	for (int slice = 0; slice < slices; slice++) {
+		positions.insert(positions.end(), resolved[slice].begin(), resolved[slice].end());
+		invalidRecords += invalid[slice];
+	}
+}
+
+// Golden section search for the K that minimises the error, which is unimodal in K
+double Tuner::fitScaling() {
+
+	if (scalingK > 0) {
+		return scalingK;
+	}
+
+	const double ratio = (sqrt(5.0) - 1) / 2;
+	double low = 0.05;
+	double high = 5.0;
+	double a = high - ratio * (high - low);
+	double b = low + ratio * (high - low);
+	double errorA = errorAndGradient(sigmoidSlope(a), nullptr);
+	double errorB = errorAndGradient(sigmoidSlope(b), nullptr);
+
+	while (high - low > 0.001) {
+		if (errorA < errorB) {
+			high = b;
+			b = a;
+			errorB = errorA;
+			a = high - ratio * (high - low);
+			errorA = errorAndGradient(sigmoidSlope(a), nullptr);
+		}
+		else {
+			low = a;
+			a = b;
+			errorA = errorB;
+			b = low + ratio * (high - low);
+			errorB = errorAndGradient(sigmoidSlope(b), nullptr);
+		}
+	}
+
+	scalingK = (low + high) / 2;
+	return scalingK;
+}
+
+// One full-batch Adam step
+double Tuner::epoch() {
+
+	vector<double> gradient(TUNE_PARAMETERS);
+	double meanError = errorAndGradient(sigmoidSlope(fitScaling()), &gradient);
+
+	steps++;
+	double correction1 = 1 - pow(ADAM_BETA1, steps);
+	double correction2 = 1 - pow(ADAM_BETA2, steps);
+
+	// The King's material value never reaches the evaluation, as both sides always have one
+	for (int i = TUNE_MATERIAL + 1; i < TUNE_PARAMETERS; i++) {
+		firstMoment[i] = ADAM_BETA1 * firstMoment[i] + (1 - ADAM_BETA1) * gradient[i];
+		secondMoment[i] = ADAM_BETA2 * secondMoment[i] + (1 - ADAM_BETA2) * gradient[i] * gradient[i];
+		weights[i] -= options.learningRate * (firstMoment[i] / correction1) / (sqrt(secondMoment[i] / correction2) + ADAM_EPSILON);
+	}
+	return meanError;
+}
+
+// Mean squared error of the current weights
+double Tuner::error() {
+	return errorAndGradient(sigmoidSlope(fitScaling()), nullptr);
+}
+
+// Each slice sums into its own error and gradient arrays, added up in slice order so results do not depend on timing
+double Tuner::errorAndGradient(double k, vector<double>* gradient) {
+
+	if (positions.empty()) {
+		return 0;
+	}
+
+	int slices = threads * SLICES_PER_THREAD;
+	vector<double> errors(slices);
+	vector<vector<double>> gradients(gradient ? slices : 0, vector<double>(TUNE_PARAMETERS));
+	const double* w = weights.data();
+	double scale = 1.0 / positions.size();
+
+	for (int slice = 0; slice < slices; slice++) {
+		pool.submit([&, slice]() {
+			size_t begin = positions.size() * slice / slices;
+			size_t end = positions.size() * (slice + 1) / slices;
+			double sum = 0;
+			double* g = (gradient ? gradients[slice].data() : nullptr);
+
+			for (size_t i = begin; i < end; i++) {
+				const TunePosition& position = positions[i];
+				double probability = 1 / (1 + exp(-k * positionEval(position, w)));
+				double difference = probability - (position.result + 1) * 0.5;
+				sum += difference * difference;
+
+				// d(difference^2)/d(weight) = 2 * difference * k * p * (1 - p) * coefficient
+				if (g) {
+					addGradient(position, 2 * difference * k * probability * (1 - probability) * scale, g);
+				}
+			}
+			errors[slice] = sum;
+		});
+	}
+	pool.wait();
+
+	double total = 0;
+	for (int slice = 0; slice < slices; slice++) {
+		total += errors[slice];
+		if (gradient) {
+			double* sum = gradient->data();
+			const double* part = gradients[slice].data();
+			for (int i = 0; i < TUNE_PARAMETERS; i++) {
+				sum[i] += part[i];
+			}
+		}
+	}
+	return total * scale;
+}
+
+// Writes the weights in the layout of Evaluation.h and eval.cpp
+bool Tuner::writeParameters(const string& path) const {
+
+	FILE* file = fopen(path.c_str(), "w");
+	if (!file) {
+		cerr << "Cannot write " << path << endl;
+		return false;
+	}
+
+	static const char* tableNames[6] = { "King", "Queen", "Bishop", "Rook", "Knight", "Pawn" };
+
+	fprintf(file, "// Tuned over %zu positions with K = %.4f\n\n", positions.size(), scalingK);
+
+	fprintf(file, "/* Material value of each PieceType in centipawns (the King is never captured) */\n");
+	fprintf(file, "const int pieceValues[6] = {");
+	for (int type = 0; type < 6; type++) {
+		fprintf(file, "%s %d", type ? "," : "", (int)lround(weights[TUNE_MATERIAL + type]));
+	}
+	fprintf(file, " };\n\n");
+
+	fprintf(file, "/* Pawn structure penalties and bonuses in centipawns */\n");
+	fprintf(file, "const int DOUBLED_PAWN = %d;\n", (int)lround(weights[TUNE_DOUBLED]));
+	fprintf(file, "const int ISOLATED_PAWN = %d;\n", (int)lround(weights[TUNE_ISOLATED]));
+	fprintf(file, "const int BACKWARD_PAWN = %d;\n\n", (int)lround(weights[TUNE_BACKWARD]));
+
+	fprintf(file, "/* Passed pawn bonus by rank counted from the pawn's own side (1 = starting rank) */\n");
+	fprintf(file, "const int passedPawn[8] = {");
+	for (int rank = 0; rank < 8; rank++) {
+		fprintf(file, "%s %d", rank ? "," : "", (int)lround(weights[TUNE_PASSED + rank]));
+	}
+	fprintf(file, " };\n\n");
+
+	fprintf(file, "const int pieceSquare[6][64] = {\n");
+	for (int type = 0; type < 6; type++) {
+		fprintf(file, "\t// %s\n\t{\n", tableNames[type]);
+		for (int row = 0; row < 8; row++) {
+			fprintf(file, "\t\t");
+			for (int col = 0; col < 8; col++) {
+				fprintf(file, "%3d%s", (int)lround(weights[TUNE_PIECE_SQUARE + type * 64 + row * 8 + col]),
+					col < 7 ? ", " : (row < 7 ? ",\n" : "\n"));
+			}
+		}
+		fprintf(file, "\t}%s\n", type < 5 ? "," : "");
+	}
+	fprintf(file, "};\n");
+
+	bool written = !ferror(file);
+	fclose(file);
+	if (!written) {
+		cerr << "Cannot write " << path << endl;
+	}
+	return written;
+}
+
+// Number of positions loaded
+size_t Tuner::getPositions() const {
+	return positions.size();
+}
+
+// Number of records skipped as invalid
+size_t Tuner::getInvalidRecords() const {
+	return invalidRecords;
+}
+
+// Evaluation of one position with the current weights
+double Tuner::evaluate(size_t index) const {
+	return positionEval(positions[index], weights.data());
+}